@@ -0,0 +1,101 @@
+#!/usr/bin/env python3
+#
+#-------------------------------------------------------------------------
+# benchdef.py --- Time the DEF reader on a synthetic placed and routed
+# design and report the read time and throughput.
+#
+# Usage:  benchdef.py [-n <instances>] [-k <repeat>] [-b <bindir>]
+#		[-t <techdir>] [-w <workdir>]
+#
+#	-k	Read the DEF file <repeat> times and keep the fastest read
+#
+# The design is generated by gennetlist.py -w in <workdir> if it does not
+# already exist.  The reader is called through libqflow.so in <bindir>,
+# so the time is that of DefRead() alone, without the verilog reading
+# and output writing of the tools that read DEF files.  The LEF file is
+# read first and is not timed.
+#-------------------------------------------------------------------------
+
+import os
+import sys
+import time
+import ctypes
+import getopt
+
+import gennetlist
+
+def read_def(lib, lef, defname):
+    ctx = lib.QflowCreate()
+    try:
+        if lib.QflowReadLef(ctx, lef.encode()) != 0:
+            return None
+        start = time.time()
+        if lib.QflowReadDef(ctx, defname.encode(), None) != 0:
+            return None
+        return time.time() - start
+    finally:
+        lib.QflowDestroy(ctx)
+
+def usage():
+    print('Usage:  benchdef.py [-n <instances>] [-k <repeat>] [-b <bindir>] '
+		'[-t <techdir>] [-w <workdir>]')
+
+if __name__ == '__main__':
+    try:
+        opts, args = getopt.getopt(sys.argv[1:], 'n:k:b:t:w:h')
+    except getopt.GetoptError:
+        usage()
+        sys.exit(1)
+
+    benchdir = os.path.dirname(os.path.abspath(__file__))
+    ninst = 1000000
+    repeat = 1
+    bindir = os.path.join(benchdir, '..', 'src')
+    techdir = os.path.join(benchdir, '..', 'tech', 'osu018')
+    workdir = os.path.join(benchdir, 'work')
+
+    for opt, val in opts:
+        if opt == '-n':
+            ninst = int(val)
+        elif opt == '-k':
+            repeat = int(val)
+        elif opt == '-b':
+            bindir = val
+        elif opt == '-t':
+            techdir = val
+        elif opt == '-w':
+            workdir = val
+        else:
+            usage()
+            sys.exit(0)
+
+    techname = os.path.basename(os.path.normpath(techdir))
+    lef = os.path.join(techdir, techname + '_stdcells.lef')
+
+    lib = ctypes.CDLL(os.path.join(bindir, 'libqflow.so'))
+    lib.QflowCreate.restype = ctypes.c_void_p
+    lib.QflowDestroy.argtypes = [ctypes.c_void_p]
+    lib.QflowReadLef.argtypes = [ctypes.c_void_p, ctypes.c_char_p]
+    lib.QflowReadDef.argtypes = [ctypes.c_void_p, ctypes.c_char_p,
+		ctypes.c_void_p]
+
+    os.makedirs(workdir, exist_ok=True)
+    root = os.path.join(workdir, 'routed_%d' % ninst)
+    if not os.path.exists(root + '.def'):
+        print('Generating %d instance routed design %s.def' % (ninst, root))
+        gennetlist.generate(gennetlist.read_lef(lef), ninst, 1, root,
+		routed=True)
+
+    best = None
+    for i in range(repeat):
+        elapsed = read_def(lib, lef, root + '.def')
+        if elapsed is None:
+            print('DEF read of %s.def failed' % root)
+            sys.exit(1)
+        if best is None or elapsed < best:
+            best = elapsed
+
+    size = os.path.getsize(root + '.def') / 1.0e6
+    print('%-14s %8.2f s %9.1f MB %9.1f MB/s %10.0f inst/s' % ('DefRead',
+		best, size, size / best if best > 0 else 0.0,
+		ninst / best if best > 0 else 0.0))
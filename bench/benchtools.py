@@ -0,0 +1,179 @@
+#!/usr/bin/env python3
+#
+#-------------------------------------------------------------------------
+# benchtools.py --- Time the qflow tools (vlog2Verilog, DEF2Verilog,
+# vlogFanout, vesta, rc2dly) on a synthetic design and report the run
+# time, throughput, and peak memory of each.
+#
+# Usage:  benchtools.py [-n <instances>] [-d <depth>] [-f <fanout_skew>]
+#		[-r <flop_ratio>] [-s <seed>] [-k <repeat>] [-b <bindir>]
+#		[-t <techdir>] [-w <workdir>] [-o <results>] [-c <results>]
+#
+#	-k	Run each tool <repeat> times and keep the fastest run
+#	-o	Write the results to a file
+#	-c	Compare against a results file written by an earlier run
+#
+# The design (verilog, placed DEF, and .rc parasitics) is generated by
+# gennetlist.py in <workdir> if it does not already exist, and is fully
+# determined by the options, so results from different builds (-b) or
+# commits can be compared with -o and -c.  Throughput is instances per
+# second of wall clock time for the whole tool run.  Peak memory is the
+# maximum resident set size of the tool process.
+#-------------------------------------------------------------------------
+
+import os
+import sys
+import glob
+import time
+import getopt
+import subprocess
+
+# Run one command and return (wall seconds, CPU seconds, peak RSS in MB),
+# or None if the command crashed or did not write its output file.  The
+# exit status is not checked, as vlogFanout returns a count of changes.
+
+def run_tool(cmd, outfile):
+    if outfile and os.path.exists(outfile):
+        os.remove(outfile)
+    start = time.time()
+    proc = subprocess.Popen(cmd, stdout=subprocess.DEVNULL,
+		stderr=subprocess.DEVNULL)
+    pid, status, usage = os.wait4(proc.pid, 0)
+    elapsed = time.time() - start
+    if os.WIFSIGNALED(status) or (outfile and not os.path.exists(outfile)):
+        return None
+    return (elapsed, usage.ru_utime + usage.ru_stime, usage.ru_maxrss / 1024.0)
+
+def read_results(filename):
+    results = {}
+    with open(filename, 'r') as ifile:
+        for line in ifile:
+            tokens = line.split()
+            if len(tokens) == 4 and not tokens[0].startswith('#'):
+                results[tokens[0]] = tuple(float(t) for t in tokens[1:])
+    return results
+
+def usage():
+    print('Usage:  benchtools.py [-n <instances>] [-d <depth>] '
+		'[-f <fanout_skew>] [-r <flop_ratio>]')
+    print('\t\t[-s <seed>] [-k <repeat>] [-b <bindir>] [-t <techdir>]')
+    print('\t\t[-w <workdir>] [-o <results>] [-c <results>]')
+
+if __name__ == '__main__':
+    try:
+        opts, args = getopt.getopt(sys.argv[1:], 'n:d:f:r:s:k:b:t:w:o:c:h')
+    except getopt.GetoptError:
+        usage()
+        sys.exit(1)
+
+    benchdir = os.path.dirname(os.path.abspath(__file__))
+    ninst = 100000
+    depth = 20
+    skew = 1.5
+    flops = 0.1
+    seed = 1
+    repeat = 1
+    bindir = os.path.join(benchdir, '..', 'src')
+    techdir = os.path.join(benchdir, '..', 'tech', 'osu018')
+    workdir = os.path.join(benchdir, 'work')
+    outname = None
+    basename = None
+
+    for opt, val in opts:
+        if opt == '-n':
+            ninst = int(val)
+        elif opt == '-d':
+            depth = int(val)
+        elif opt == '-f':
+            skew = float(val)
+        elif opt == '-r':
+            flops = float(val)
+        elif opt == '-s':
+            seed = int(val)
+        elif opt == '-k':
+            repeat = max(1, int(val))
+        elif opt == '-b':
+            bindir = val
+        elif opt == '-t':
+            techdir = val
+        elif opt == '-w':
+            workdir = val
+        elif opt == '-o':
+            outname = val
+        elif opt == '-c':
+            basename = val
+        else:
+            usage()
+            sys.exit(0)
+
+    techname = os.path.basename(os.path.normpath(techdir))
+    leflist = glob.glob(os.path.join(techdir, '*.lef'))
+    liblist = glob.glob(os.path.join(techdir, '*.lib'))
+    if not leflist or not liblist:
+        print('No LEF or Liberty file found in ' + techdir)
+        sys.exit(1)
+    lef = leflist[0]
+    lib = liblist[0]
+
+    os.makedirs(workdir, exist_ok=True)
+    params = 'n%d_d%d_f%g_r%g_s%d' % (ninst, depth, skew, flops, seed)
+    root = os.path.join(workdir, 'tools_%s_%s' % (techname, params))
+    if not os.path.exists(root + '.rc'):
+        # Run as a separate process, as the peak memory reported for
+        # each tool includes the size of this process when it started.
+        print('Generating %d instance design %s.v' % (ninst, root))
+        subprocess.run([sys.executable, os.path.join(benchdir, 'gennetlist.py'),
+		'-n', str(ninst), '-s', str(seed), '-d', str(depth), '-f', str(skew),
+		'-r', str(flops), '-c', lef, root], check=True)
+
+    def tool(name):
+        return os.path.join(bindir, name)
+
+    tests = [
+	('vlog2Verilog', [tool('vlog2Verilog'), '-o', root + '.out.v',
+		root + '.v'], root + '.out.v'),
+	('DEF2Verilog', [tool('DEF2Verilog'), '-v', root + '.v', '-l', lef,
+		'-o', root + '.def.v', root + '.def'], root + '.def.v'),
+	('vlogFanout', [tool('vlogFanout'), '-p', lib, root + '.v',
+		root + '.fan.v'], root + '.fan.v'),
+	('vesta', [tool('vesta'), root + '.v', lib], None),
+	('rc2dly', [tool('rc2dly'), '-r', root + '.rc', '-l', lib,
+		'-V', root + '.v', '-d', root + '.dly'], root + '.dly'),
+	('vesta -d', [tool('vesta'), '-d', root + '.dly', root + '.v', lib],
+		None),
+	('rc2dly spef', [tool('rc2dly'), '-D', ':', '-r', root + '.rc', '-l', lib,
+		'-V', root + '.v', '-d', root + '.spef'], root + '.spef'),
+	('vesta spef', [tool('vesta'), '-d', root + '.spef', root + '.v', lib],
+		None),
+    ]
+
+    baseline = read_results(basename) if basename else {}
+    results = {}
+
+    print('%-14s %9s %9s %10s %11s' % ('tool', 'time', 'cpu', 'kinst/s',
+		'peak mem'), end='')
+    print('   vs. baseline' if baseline else '')
+    for name, cmd, outfile in tests:
+        runs = [run_tool(cmd, outfile) for i in range(repeat)]
+        if None in runs:
+            print('%-14s failed' % name)
+            continue
+        best = min(runs)
+        key = name.replace(' ', '')
+        results[key] = best
+        wall, cpu, rss = best
+        print('%-14s %7.2f s %7.2f s %10.1f %8.1f MB' % (name, wall, cpu,
+		ninst / wall / 1000.0 if wall > 0 else 0.0, rss), end='')
+        if key in baseline:
+            bwall, bcpu, brss = baseline[key]
+            print('   time x%.2f  mem x%.2f' % (wall / bwall if bwall > 0
+			else 0.0, rss / brss if brss > 0 else 0.0))
+        else:
+            print('')
+
+    if outname:
+        with open(outname, 'w') as ofile:
+            print('# benchtools.py %s %s' % (techname, params), file=ofile)
+            print('# tool wall_s cpu_s peak_MB', file=ofile)
+            for key, (wall, cpu, rss) in results.items():
+                print('%s %.3f %.3f %.1f' % (key, wall, cpu, rss), file=ofile)
@@ -0,0 +1,91 @@
+#!/usr/bin/env python3
+#
+#-------------------------------------------------------------------------
+# benchwriters.py --- Time the qflow netlist writers (vlog2Verilog,
+# vlog2Spice, vlog2Def, vlog2Cel, DEF2Verilog) on a synthetic netlist
+# and report the output throughput of each in MB/s.
+#
+# Usage:  benchwriters.py [-n <instances>] [-b <bindir>] [-t <techdir>]
+#		[-w <workdir>]
+#
+# The synthetic netlist is generated by gennetlist.py in <workdir> if it
+# does not already exist.  Throughput is output size divided by the wall
+# clock time of the whole tool run, including reading the input.
+#-------------------------------------------------------------------------
+
+import os
+import sys
+import time
+import getopt
+import subprocess
+
+import gennetlist
+
+def run_writer(name, cmd, outfile):
+    start = time.time()
+    result = subprocess.run(cmd, stdout=subprocess.DEVNULL,
+		stderr=subprocess.DEVNULL)
+    elapsed = time.time() - start
+    if result.returncode != 0 or not os.path.exists(outfile):
+        print('%-14s failed (exit status %d)' % (name, result.returncode))
+        return
+    size = os.path.getsize(outfile) / 1.0e6
+    print('%-14s %8.2f s %9.1f MB %9.1f MB/s' % (name, elapsed, size,
+		size / elapsed if elapsed > 0 else 0.0))
+
+def usage():
+    print('Usage:  benchwriters.py [-n <instances>] [-b <bindir>] '
+		'[-t <techdir>] [-w <workdir>]')
+
+if __name__ == '__main__':
+    try:
+        opts, args = getopt.getopt(sys.argv[1:], 'n:b:t:w:h')
+    except getopt.GetoptError:
+        usage()
+        sys.exit(1)
+
+    benchdir = os.path.dirname(os.path.abspath(__file__))
+    ninst = 1000000
+    bindir = os.path.join(benchdir, '..', 'src')
+    techdir = os.path.join(benchdir, '..', 'tech', 'osu018')
+    workdir = os.path.join(benchdir, 'work')
+
+    for opt, val in opts:
+        if opt == '-n':
+            ninst = int(val)
+        elif opt == '-b':
+            bindir = val
+        elif opt == '-t':
+            techdir = val
+        elif opt == '-w':
+            workdir = val
+        else:
+            usage()
+            sys.exit(0)
+
+    techname = os.path.basename(os.path.normpath(techdir))
+    lef = os.path.join(techdir, techname + '_stdcells.lef')
+    spice = os.path.join(techdir, techname + '_stdcells.sp')
+
+    os.makedirs(workdir, exist_ok=True)
+    root = os.path.join(workdir, 'writers_%d' % ninst)
+    if not os.path.exists(root + '.def'):
+        print('Generating %d instance netlist %s.v' % (ninst, root))
+        gennetlist.generate(gennetlist.read_lef(lef), ninst, 1, root)
+
+    def tool(name):
+        return os.path.join(bindir, name)
+
+    print('%-14s %10s %12s %14s' % ('writer', 'time', 'output', 'throughput'))
+    run_writer('vlog2Verilog', [tool('vlog2Verilog'), '-c', '-v', 'vdd',
+		'-g', 'gnd', '-l', lef, '-o', root + '.rtl.v', root + '.v'],
+		root + '.rtl.v')
+    run_writer('vlog2Spice', [tool('vlog2Spice'), '-l', spice,
+		'-o', root + '.spc', root + '.rtl.v'], root + '.spc')
+    run_writer('vlog2Def', [tool('vlog2Def'), '-l', lef,
+		'-o', root + '.out.def', root + '.v'], root + '.out.def')
+    run_writer('vlog2Cel', [tool('vlog2Cel'), '-l', lef,
+		'-o', root + '.cel', root + '.v'], root + '.cel')
+    run_writer('DEF2Verilog', [tool('DEF2Verilog'), '-v', root + '.v',
+		'-l', lef, '-p', 'vdd', '-g', 'gnd', '-o', root + '.def.v',
+		root + '.def'], root + '.def.v')
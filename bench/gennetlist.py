@@ -0,0 +1,409 @@
+#!/usr/bin/env python3
+#
+#-------------------------------------------------------------------------
+# gennetlist.py --- Generate a synthetic structural verilog netlist and a
+# matching placed DEF file from the standard cells in a LEF file, for
+# benchmarking the qflow netlist readers and writers.
+#
+# Usage:  gennetlist.py [-n <instances>] [-s <seed>] [-d <depth>]
+#		[-f <fanout_skew>] [-r <flop_ratio>] [-c] [-w] <lef_file> <rootname>
+#
+#	-d	Build the logic in <depth> levels (default 0, unlevelized)
+#	-f	Pareto shape of the net fanout distribution (default 0,
+#		uniform choice of nearby drivers);  smaller is more skewed
+#	-r	Fraction of instances that are flip-flops (default 0)
+#	-c	Also write <rootname>.rc, wire parasitics in qrouter format
+#	-w	Write the DEF nets as ROUTED, with wiring from each net's
+#		first connection to each of the others
+#
+# Writes <rootname>.v and <rootname>.def.  Output is fully determined by
+# the LEF file and the options.
+#-------------------------------------------------------------------------
+
+import sys
+import random
+import getopt
+
+#-------------------------------------------------------------------------
+# Read MACRO names, sizes, and signal pins from a LEF file
+#-------------------------------------------------------------------------
+
+def read_lef(lefname):
+    cells = []
+    units = 1000
+    macro = None
+    pin = None
+    with open(lefname, 'r') as ifile:
+        for line in ifile:
+            tokens = line.split()
+            if not tokens:
+                continue
+            if tokens[0] == 'MACRO':
+                macro = {'name': tokens[1], 'width': 0, 'height': 0,
+                'inputs': [], 'outputs': [], 'class': 'CORE'}
+            elif macro is None:
+                continue
+            elif tokens[0] == 'CLASS' and pin is None:
+                macro['class'] = tokens[1]
+            elif tokens[0] == 'SIZE':
+                macro['width'] = float(tokens[1])
+                macro['height'] = float(tokens[3])
+            elif tokens[0] == 'PIN':
+                pin = {'name': tokens[1], 'dir': 'INPUT', 'use': 'SIGNAL'}
+            elif tokens[0] == 'DIRECTION' and pin is not None:
+                pin['dir'] = tokens[1]
+            elif tokens[0] == 'USE' and pin is not None:
+                pin['use'] = tokens[1]
+            elif tokens[0] == 'END' and len(tokens) > 1:
+                if pin is not None and tokens[1] == pin['name']:
+                    if pin['use'] not in ('POWER', 'GROUND'):
+                        if pin['dir'] == 'OUTPUT':
+                            macro['outputs'].append(pin['name'])
+                        elif pin['dir'] == 'INPUT':
+                            macro['inputs'].append(pin['name'])
+                    pin = None
+                elif tokens[1] == macro['name']:
+                    if macro['class'] == 'CORE' and macro['inputs'] and \
+                        len(macro['outputs']) == 1:
+                        cells.append(macro)
+                    macro = None
+    return cells
+
+#-------------------------------------------------------------------------
+# Split the cells of a LEF file into flip-flops (inputs CLK and D only)
+# and logic cells (no CLK input).
+#-------------------------------------------------------------------------
+
+def split_cells(cells):
+    flops = [c for c in cells if sorted(c['inputs']) == ['CLK', 'D']
+		and 'LATCH' not in c['name']]
+    logic = [c for c in cells if 'CLK' not in c['inputs']]
+    return flops, logic
+
+#-------------------------------------------------------------------------
+# Connect a list of sink pins, each a (connection list, index) pair, to
+# the nets of a pool.  Each net is given a
+# number of "stubs" drawn from a Pareto distribution of shape "skew", and
+# the sinks are spread evenly over the stubs in order, so that sinks are
+# connected to nearby nets and net fanout follows the distribution.  With
+# skew 0, each sink is connected to a random net within "window" nets of
+# its position.
+#-------------------------------------------------------------------------
+
+def connect_sinks(rng, sinks, pool, window, skew):
+    if not pool:
+        return
+    nsinks = len(sinks)
+    if skew > 0:
+        stubs = []
+        for net in pool:
+            stubs.extend([net] * min(int(rng.paretovariate(skew)), 1000))
+        for i, (conns, k) in enumerate(sinks):
+            conns[k] = (conns[k][0], stubs[i * len(stubs) // nsinks])
+    else:
+        for i, (conns, k) in enumerate(sinks):
+            center = i * len(pool) // nsinks
+            lo = max(0, min(center - window // 2, len(pool) - window))
+            conns[k] = (conns[k][0], rng.choice(pool[lo:lo + window]))
+
+#-------------------------------------------------------------------------
+# Generate the netlist.  Each instance drives one new net, named "n<i>"
+# for instance "U<i>".
+#
+# With depth 0, each instance takes its inputs from nets driven within
+# a window of recent instances, giving a netlist with local structure
+# and a range of fanouts.  With depth > 0, the logic is built in "depth"
+# levels, each level taking its inputs from the level before, so that
+# the longest path has "depth" logic cells;  "skew" sets the fanout
+# distribution (see connect_sinks()).
+#
+# A fraction "flops" of the instances are flip-flops clocked by module
+# input "clk".  With depth > 0, flop outputs feed the first level of
+# logic and flop inputs come from the last level.
+#
+# Instances are placed in rows of a roughly square core, in an order
+# that keeps connected instances close.  If "rc" is set, a qrouter-style
+# .rc file of wire parasitics is written, estimated from the placement.
+#-------------------------------------------------------------------------
+
+def generate(cells, ninst, seed, rootname, window=200, nin=32, nout=32,
+		depth=0, skew=0.0, flops=0.0, rc=False, routed=False):
+    rng = random.Random(seed)
+    flopcells, logic = split_cells(cells)
+    if flops <= 0 or not flopcells:
+        # All cells are used as logic, as in earlier versions, so that
+        # the default netlist does not change.
+        flops = 0
+        logic = cells
+    nflop = int(ninst * flops)
+    drivers = ['in[%d]' % i for i in range(nin)]
+    insts = []
+    order = []
+
+    if depth <= 0:
+        # Flops are spread evenly through the instances
+        for i in range(ninst):
+            isflop = int((i + 1) * flops) > int(i * flops)
+            cell = rng.choice(flopcells if isflop else logic)
+            conns = []
+            for pin in cell['inputs']:
+                if pin == 'CLK' and isflop:
+                    conns.append((pin, 'clk'))
+                elif skew > 0:
+                    idx = int(min(window, len(drivers)) *
+				rng.random() ** (1.0 + skew))
+                    conns.append((pin, drivers[-1 - idx]))
+                else:
+                    conns.append((pin, rng.choice(drivers[-window:])))
+            outnet = 'n%d' % i
+            conns.append((cell['outputs'][0], outnet))
+            drivers.append(outnet)
+            insts.append(('U%d' % i, cell, conns))
+        order = list(range(ninst))
+        lastlevel = drivers
+    else:
+        # Flops come first;  their outputs and the module inputs form
+        # level 0.  Input D is connected after the last level is made.
+        flopsinks = []
+        for i in range(nflop):
+            cell = rng.choice(flopcells)
+            conns = [(pin, 'clk' if pin == 'CLK' else None)
+			for pin in cell['inputs']]
+            conns.append((cell['outputs'][0], 'n%d' % i))
+            insts.append(('U%d' % i, cell, conns))
+            flopsinks.append((conns, conns.index(('D', None))))
+        pool = drivers + ['n%d' % i for i in range(nflop)]
+
+        ncomb = ninst - nflop
+        depth = min(depth, ncomb)
+        levels = [[] for _ in range(depth)]
+        for j in range(ncomb):
+            levels[j * depth // ncomb].append(nflop + j)
+        keys = [(i / max(nflop, 1), 0) for i in range(nflop)]
+        for level, members in enumerate(levels):
+            sinks = []
+            for k, i in enumerate(members):
+                cell = rng.choice(logic)
+                conns = []
+                for pin in cell['inputs']:
+                    sinks.append((conns, len(conns)))
+                    conns.append((pin, None))
+                conns.append((cell['outputs'][0], 'n%d' % i))
+                insts.append(('U%d' % i, cell, conns))
+                keys.append((k / len(members), level + 1))
+            connect_sinks(rng, sinks, pool, window, skew)
+            pool = ['n%d' % i for i in members]
+        lastlevel = pool
+
+        connect_sinks(rng, flopsinks, lastlevel, window, skew)
+        order = sorted(range(ninst), key=lambda i: keys[i])
+
+    # Module outputs are connected to the last nets generated
+    outmap = {}
+    for i in range(nout):
+        outmap[lastlevel[-1 - i]] = 'out[%d]' % i
+    for inst in insts:
+        conns = inst[2]
+        pin, net = conns[-1]
+        if net in outmap:
+            conns[-1] = (pin, outmap[net])
+
+    with open(rootname + '.v', 'w') as ofile:
+        if nflop > 0:
+            ofile.write('module top (clk, in, out);\n')
+            ofile.write('input clk;\n')
+        else:
+            ofile.write('module top (in, out);\n')
+        ofile.write('input [%d:0] in;\n' % (nin - 1))
+        ofile.write('output [%d:0] out;\n' % (nout - 1))
+        for i in range(ninst):
+            if 'n%d' % i not in outmap:
+                ofile.write('wire n%d ;\n' % i)
+        for name, cell, conns in insts:
+            ofile.write('%s %s (\n' % (cell['name'], name))
+            ofile.write(',\n'.join(['    .%s(%s)' % c for c in conns]))
+            ofile.write('\n);\n')
+        ofile.write('endmodule\n')
+
+    # Place instances in rows of a roughly square core
+    units = 100
+    siteh = int(round(cells[0]['height'] * units))
+    totalw = sum(int(round(c['width'] * units)) for _, c, _ in insts)
+    roww = int((totalw * siteh) ** 0.5 * 1.1) + 1
+    x = y = 0
+    nrows = 1
+    places = []
+    for i in order:
+        name, cell, conns = insts[i]
+        w = int(round(cell['width'] * units))
+        if x + w > roww:
+            x = 0
+            y += siteh
+            nrows += 1
+        places.append((name, cell['name'], x, y, 'N' if (nrows & 1) else 'FS'))
+        x += w
+
+    nets = {}
+    for name, cell, conns in insts:
+        for pin, net in conns:
+            nets.setdefault(net, []).append((name, pin))
+    pins = [('in[%d]' % i, 'INPUT', 0, i * siteh) for i in range(nin)]
+    pins += [('out[%d]' % i, 'OUTPUT', roww, i * siteh) for i in range(nout)]
+    if nflop > 0:
+        pins.append(('clk', 'INPUT', 0, nin * siteh))
+    for pin, dir, px, py in pins:
+        nets.setdefault(pin, []).append(('PIN', pin))
+
+    with open(rootname + '.def', 'w') as ofile:
+        ofile.write('VERSION 5.6 ;\nDIVIDERCHAR "/" ;\nBUSBITCHARS "[]" ;\n')
+        ofile.write('DESIGN top ;\nUNITS DISTANCE MICRONS %d ;\n\n' % units)
+        ofile.write('DIEAREA ( 0 0 ) ( %d %d ) ;\n\n' % (roww, nrows * siteh))
+        ofile.write('COMPONENTS %d ;\n' % len(places))
+        for p in places:
+            ofile.write('- %s %s + PLACED ( %d %d ) %s ;\n' % p)
+        ofile.write('END COMPONENTS\n\n')
+        ofile.write('PINS %d ;\n' % len(pins))
+        for pin, dir, px, py in pins:
+            ofile.write('- %s + NET %s + DIRECTION %s\n' % (pin, pin, dir))
+            ofile.write('  + PLACED ( %d %d ) N ;\n' % (px, py))
+        ofile.write('END PINS\n\n')
+        ofile.write('NETS %d ;\n' % len(nets))
+        if routed:
+            loc = route_locations(insts, places, pins, units)
+        for net, conns in nets.items():
+            ofile.write('- %s\n  ' % net)
+            ofile.write(' '.join(['( %s %s )' % c for c in conns]))
+            if routed and len(conns) > 1:
+                write_routes(ofile, [loc[c[1] if c[0] == 'PIN' else c[0]]
+			for c in conns])
+            ofile.write(' ;\n')
+        ofile.write('END NETS\n\nEND DESIGN\n')
+
+    if rc:
+        write_rc(rootname, insts, places, pins, nets, units)
+
+#-------------------------------------------------------------------------
+# Routed nets:  each connection is taken to be at the center of its cell
+# (or at the pin), and is wired from the net's first connection in
+# metal1, then through a via to metal2, as a router would write it.
+#-------------------------------------------------------------------------
+
+def route_locations(insts, places, pins, units):
+    cellof = dict((name, cell) for name, cell, conns in insts)
+    loc = {}
+    for name, cellname, x, y, orient in places:
+        cell = cellof[name]
+        loc[name] = (x + int(cell['width'] * units / 2),
+			y + int(cell['height'] * units / 2))
+    for pin, dir, px, py in pins:
+        loc[pin] = (px, py)
+    return loc
+
+def write_routes(ofile, points):
+    dx, dy = points[0]
+    keyword = '+ ROUTED'
+    for sx, sy in points[1:]:
+        ofile.write('\n  %s metal1 ( %d %d ) ( %d * ) M2_M1 ( * %d )' %
+		(keyword, dx, dy, sx, sy))
+        keyword = '  NEW'
+
+#-------------------------------------------------------------------------
+# Write a qrouter-style .rc file (see rc2dly.c) with each net routed as
+# a star from its driver, using the Manhattan distance between cell
+# centers and fixed resistance and capacitance per micron.
+#-------------------------------------------------------------------------
+
+RES_PER_UM = 0.1	# ohms
+CAP_PER_UM = 0.0002	# pF
+
+def write_rc(rootname, insts, places, pins, nets, units):
+    cellof = dict((name, cell) for name, cell, conns in insts)
+    loc = {}
+    for name, cellname, x, y, orient in places:
+        cell = cellof[name]
+        loc[name] = ((x + cell['width'] * units / 2) / units,
+			(y + cell['height'] * units / 2) / units)
+    for pin, dir, px, py in pins:
+        loc['PIN/' + pin] = (px / units, py / units)
+
+    # Node names are "<instance>/<pin>" or "PIN/<pin>"
+    def node_loc(node):
+        inst, pin = node.split('/', 1)
+        return loc[node] if inst == 'PIN' else loc[inst]
+
+    with open(rootname + '.rc', 'w') as ofile:
+        for net, conns in nets.items():
+            driver = None
+            sinks = []
+            for inst, pin in conns:
+                if inst == 'PIN':
+                    node = 'PIN/' + pin
+                    if pin.startswith('out'):
+                        sinks.append(node)
+                    else:
+                        driver = node
+                elif pin in cellof[inst]['outputs']:
+                    driver = inst + '/' + pin
+                else:
+                    sinks.append(inst + '/' + pin)
+            if driver is None or not sinks:
+                continue
+            dx, dy = node_loc(driver)
+            branches = []
+            for sink in sinks:
+                sx, sy = node_loc(sink)
+                length = abs(sx - dx) + abs(sy - dy)
+                branches.append('( %g %g %s )' % (length * RES_PER_UM,
+			length * CAP_PER_UM, sink))
+            ofile.write('%s 1 %s %d ( 0 0 %s )\n' % (net, driver, len(sinks),
+			' , '.join(branches)))
+
+#-------------------------------------------------------------------------
+
+def usage():
+    print('Usage:  gennetlist.py [-n <instances>] [-s <seed>] [-d <depth>] '
+		'[-f <fanout_skew>] [-r <flop_ratio>] [-c] [-w] <lef_file> <rootname>')
+
+if __name__ == '__main__':
+    try:
+        opts, args = getopt.getopt(sys.argv[1:], 'n:s:d:f:r:cwh')
+    except getopt.GetoptError:
+        usage()
+        sys.exit(1)
+
+    ninst = 1000000
+    seed = 1
+    depth = 0
+    skew = 0.0
+    flops = 0.0
+    rc = False
+    routed = False
+    for opt, val in opts:
+        if opt == '-n':
+            ninst = int(val)
+        elif opt == '-s':
+            seed = int(val)
+        elif opt == '-d':
+            depth = int(val)
+        elif opt == '-f':
+            skew = float(val)
+        elif opt == '-r':
+            flops = float(val)
+        elif opt == '-c':
+            rc = True
+        elif opt == '-w':
+            routed = True
+        else:
+            usage()
+            sys.exit(0)
+
+    if len(args) != 2:
+        usage()
+        sys.exit(1)
+
+    cells = read_lef(args[0])
+    if not cells:
+        print('No usable standard cells found in ' + args[0])
+        sys.exit(1)
+    generate(cells, ninst, seed, args[1], depth=depth, skew=skew,
+		flops=flops, rc=rc, routed=routed)
@@ -167,6 +167,7 @@ if ( $purge == 1 ) then
     rm -f ${rootname}.obs
     rm -f ${rootname}.gds
     rm -f ${rootname}.par.orig
+    if ( -f ${rootname}.net.generated ) rm -f ${rootname}.net ${rootname}.net.generated
 endif
 
 cd ${logdir}
@@ -270,13 +270,47 @@ if ( -f ${synthdir}/${rootname}_synth.rtl.v && ( -M ${synthdir}/${rootname}_synt
     cp ${synthdir}/${rootname}_synth.rtlbb.v ${synthdir}/${rootname}.rtlbb.v
 endif
 
+# If placement option "timing_weights" is set and vesta has been run,
+# weight the critical nets in the graywolf .net file.  An
+# empty value ("set timing_weights =") leaves them unweighted.
+# A .net file written here is marked by ${rootname}.net.generated,
+# and is removed when the nets are no longer weighted, so that old
+# weights are not used.  A .net file not written here is the user's,
+# and is neither overwritten nor removed.
+
+set vlog2celopts = ""
+set usetimingweights = 0
+set netfile = ${layoutdir}/${rootname}.net
+if ( ${?timing_weights} ) then
+   if ( "${timing_weights}" != "" ) set usetimingweights = 1
+endif
+if ( ${usetimingweights} ) then
+   if ( -f ${netfile} && ! -f ${netfile}.generated ) then
+      echo "File ${rootname}.net was not generated by qflow and will not be" \
+		|& tee -a ${synthlog}
+      echo "overwritten;  timing_weights is ignored." |& tee -a ${synthlog}
+   else if ( -f ${synthdir}/${rootname}.slack ) then
+      set vlog2celopts = "-w ${synthdir}/${rootname}.slack"
+   else
+      echo "No net slack file ${rootname}.slack; run vesta before placement" \
+		|& tee -a ${synthlog}
+      echo "to use timing_weights." |& tee -a ${synthlog}
+   endif
+endif
+if ( "${vlog2celopts}" == "" && -f ${netfile}.generated ) then
+   echo "Removing net weights file ${rootname}.net from a previous run" \
+		|& tee -a ${synthlog}
+   rm -f ${netfile} ${netfile}.generated
+endif
+
 echo "Running vlog2Cel to generate input files for graywolf" |& tee -a ${synthlog}
-echo "vlog2Cel ${lefoptions} -u $units -o ${layoutdir}/${rootname}.cel ${synthdir}/${rootname}.rtlnopwr.v" |& tee -a ${synthlog}
+echo "vlog2Cel ${lefoptions} -u $units ${vlog2celopts} -o ${layoutdir}/${rootname}.cel ${synthdir}/${rootname}.rtlnopwr.v" |& tee -a ${synthlog}
 
-${bindir}/vlog2Cel ${lefoptions} -u $units -o ${layoutdir}/${rootname}.cel \
+${bindir}/vlog2Cel ${lefoptions} -u $units ${vlog2celopts} -o ${layoutdir}/${rootname}.cel \
 	${synthdir}/${rootname}.rtlnopwr.v >>& ${synthlog}
 
 set errcond = $status
+if ( ${errcond} == 0 && "${vlog2celopts}" != "" ) touch ${netfile}.generated
 if ( ${errcond} != 0 ) then
    echo "vlog2Cel failed with exit status ${errcond}" |& tee -a ${synthlog}
    echo "Premature exit." |& tee -a ${synthlog}
@@ -848,33 +882,12 @@ if ($makedef == 1) then
       cp ${rootname}.rtlbb.v ${rootname}_synth.rtlbb.v
 
       echo "Running vlog2Verilog." |& tee -a ${synthlog}
-      echo "vlog2Verilog -c -v ${vddnet} -g ${gndnet} -o ${rootname}.rtl.v ${rootname}_anno.v" |& tee -a ${synthlog}
+      echo "vlog2Verilog -c -v ${vddnet} -g ${gndnet} -o ${rootname}.rtl.v -o ${rootname}.rtlnopwr.v -p -o ${rootname}.rtlbb.v -b -p -n ${rootname}_anno.v" |& tee -a ${synthlog}
       ${bindir}/vlog2Verilog -c -v ${vddnet} -g ${gndnet} \
-		-o ${rootname}.rtl.v ${rootname}_anno.v >>& ${synthlog}
-
-      set errcond = $status
-      if ( ${errcond} != 0 ) then
-         echo "vlog2Verilog failed with exit status ${errcond}" |& tee -a ${synthlog}
-         echo "Premature exit." |& tee -a ${synthlog}
-         echo "Synthesis flow stopped on error condition." >>& ${synthlog}
-         exit 1
-      endif
-
-      echo "vlog2Verilog -c -p -v ${vddnet} -g ${gndnet} -o ${rootname}.rtlnopwr.v ${rootname}_anno.v" |& tee -a ${synthlog}
-      ${bindir}/vlog2Verilog -c -p -v ${vddnet} -g ${gndnet} \
-		-o ${rootname}.rtlnopwr.v ${rootname}_anno.v >>& ${synthlog}
-
-      set errcond = $status
-      if ( ${errcond} != 0 ) then
-         echo "vlog2Verilog failed with exit status ${errcond}" |& tee -a ${synthlog}
-         echo "Premature exit." |& tee -a ${synthlog}
-         echo "Synthesis flow stopped on error condition." >>& ${synthlog}
-         exit 1
-      endif
-
-      echo "vlog2Verilog -c -b -p -n -v ${vddnet} -g ${gndnet} -o ${rootname}.rtlbb.v ${rootname}_anno.v" |& tee -a ${synthlog}
-      ${bindir}/vlog2Verilog -c -b -p -n -v ${vddnet} -g ${gndnet} \
-		-o ${rootname}.rtlbb.v ${rootname}_anno.v >>& ${synthlog}
+		-o ${rootname}.rtl.v \
+		-o ${rootname}.rtlnopwr.v -p \
+		-o ${rootname}.rtlbb.v -b -p -n \
+		${rootname}_anno.v >>& ${synthlog}
 
       set errcond = $status
       if ( ${errcond} != 0 ) then
@@ -321,33 +321,12 @@ else
    # versions of the different verilog styles and the SPICE netlist.
 
    echo "Running vlog2Verilog." |& tee -a ${synthlog}
-   echo "vlog2Verilog -c -v ${vddnet} -g ${gndnet} -o ${rootname}.rtl.anno.v ${rootname}_postroute.v" |& tee -a ${synthlog}
+   echo "vlog2Verilog -c -v ${vddnet} -g ${gndnet} -o ${rootname}.rtl.anno.v -o ${rootname}.rtlnopwr.anno.v -p -o ${rootname}.rtlbb.anno.v -b -p -n ${rootname}_postroute.v" |& tee -a ${synthlog}
    ${bindir}/vlog2Verilog -c -v ${vddnet} -g ${gndnet} \
-		-o ${rootname}.rtl.anno.v ${rootname}_postroute.v >>& ${synthlog}
-
-   set errcond = $status
-   if ( ${errcond} != 0 ) then
-      echo "vlog2Verilog failed with exit status ${errcond}" |& tee -a ${synthlog}
-      echo "Premature exit." |& tee -a ${synthlog}
-      echo "Synthesis flow stopped on error condition." >>& ${synthlog}
-      exit 1
-   endif
-
-   echo "vlog2Verilog -c -p -v ${vddnet} -g ${gndnet} -o ${rootname}.rtlnopwr.anno.v ${rootname}_postroute.v" |& tee -a ${synthlog}
-   ${bindir}/vlog2Verilog -c -p -v ${vddnet} -g ${gndnet} \
-		-o ${rootname}.rtlnopwr.anno.v ${rootname}_postroute.v >>& ${synthlog}
-
-   set errcond = $status
-   if ( ${errcond} != 0 ) then
-      echo "vlog2Verilog failed with exit status ${errcond}" |& tee -a ${synthlog}
-      echo "Premature exit." |& tee -a ${synthlog}
-      echo "Synthesis flow stopped on error condition." >>& ${synthlog}
-      exit 1
-   endif
-
-   echo "${bindir}/vlog2Verilog -c -b -p -n -v ${vddnet} -g ${gndnet} -o ${rootname}.rtlbb.anno.v ${rootname}_postroute.v" |& tee -a ${synthlog}
-   ${bindir}/vlog2Verilog -c -b -p -n -v ${vddnet} -g ${gndnet} \
-		-o ${rootname}.rtlbb.anno.v ${rootname}_postroute.v >>& ${synthlog}
+		-o ${rootname}.rtl.anno.v \
+		-o ${rootname}.rtlnopwr.anno.v -p \
+		-o ${rootname}.rtlbb.anno.v -b -p -n \
+		${rootname}_postroute.v >>& ${synthlog}
 
    set errcond = $status
    if ( ${errcond} != 0 ) then
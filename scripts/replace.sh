@@ -255,6 +255,24 @@ else
    set vlog2defopts = ""
 endif
 
+# If placement option "timing_weights" is set and vesta has been run,
+# add the weights of critical nets to the DEF NETS section.  An
+# empty value ("set timing_weights =") leaves them unweighted.
+
+set usetimingweights = 0
+if ( ${?timing_weights} ) then
+   if ( "${timing_weights}" != "" ) set usetimingweights = 1
+endif
+if ( ${usetimingweights} ) then
+   if ( -f ${synthdir}/${rootname}.slack ) then
+      set vlog2defopts = "${vlog2defopts} -w ${synthdir}/${rootname}.slack"
+   else
+      echo "No net slack file ${rootname}.slack; run vesta before placement" \
+		|& tee -a ${synthlog}
+      echo "to use timing_weights." |& tee -a ${synthlog}
+   endif
+endif
+
 echo "Running vlog2Def to generate input files for graywolf" |& tee -a ${synthlog}
 echo "vlog2Def ${lefoptions} -u $units ${vlog2defopts} -o ${layoutdir}/${rootname}_preplace.def ${synthdir}/${rootname}.rtlnopwr.v" |& tee -a ${synthlog}
 
@@ -653,33 +671,12 @@ if ($makedef == 1) then
       cp ${rootname}.rtlbb.v ${rootname}_synth.rtlbb.v
 
       echo "Running vlog2Verilog." |& tee -a ${synthlog}
-      echo "vlog2Verilog -c -v ${vddnet} -g ${gndnet} -o ${rootname}.rtl.v ${rootname}_anno.v" |& tee -a ${synthlog}
+      echo "vlog2Verilog -c -v ${vddnet} -g ${gndnet} -o ${rootname}.rtl.v -o ${rootname}.rtlnopwr.v -p -o ${rootname}.rtlbb.v -b -p -n ${rootname}_anno.v" |& tee -a ${synthlog}
       ${bindir}/vlog2Verilog -c -v ${vddnet} -g ${gndnet} \
-		-o ${rootname}.rtl.v ${rootname}_anno.v >>& ${synthlog}
-
-      set errcond = $status
-      if ( ${errcond} != 0 ) then
-         echo "vlog2Verilog failed with exit status ${errcond}" |& tee -a ${synthlog}
-         echo "Premature exit." |& tee -a ${synthlog}
-         echo "Synthesis flow stopped on error condition." >>& ${synthlog}
-         exit 1
-      endif
-
-      echo "vlog2Verilog -c -p -v ${vddnet} -g ${gndnet} -o ${rootname}.rtlnopwr.v ${rootname}_anno.v" |& tee -a ${synthlog}
-      ${bindir}/vlog2Verilog -c -p -v ${vddnet} -g ${gndnet} \
-		-o ${rootname}.rtlnopwr.v ${rootname}_anno.v >>& ${synthlog}
-
-      set errcond = $status
-      if ( ${errcond} != 0 ) then
-         echo "vlog2Verilog failed with exit status ${errcond}" |& tee -a ${synthlog}
-         echo "Premature exit." |& tee -a ${synthlog}
-         echo "Synthesis flow stopped on error condition." >>& ${synthlog}
-         exit 1
-      endif
-
-      echo "vlog2Verilog -c -b -p -n -v ${vddnet} -g ${gndnet} -o ${rootname}.rtlbb.v ${rootname}_anno.v" |& tee -a ${synthlog}
-      ${bindir}/vlog2Verilog -c -b -p -n -v ${vddnet} -g ${gndnet} \
-		-o ${rootname}.rtlbb.v ${rootname}_anno.v >>& ${synthlog}
+		-o ${rootname}.rtl.v \
+		-o ${rootname}.rtlnopwr.v -p \
+		-o ${rootname}.rtlbb.v -b -p -n \
+		${rootname}_anno.v >>& ${synthlog}
 
       set errcond = $status
       if ( ${errcond} != 0 ) then
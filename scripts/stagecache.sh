@@ -0,0 +1,341 @@
+#!/bin/tcsh -f
+#----------------------------------------------------------
+# Stage result cache for qflow
+#----------------------------------------------------------
+# Run one stage of the flow, unless the same stage has
+# already been run on identical inputs, in which case the
+# files that the stage produced are restored from the cache.
+#
+# Each stage declares the files that it reads and the files
+# that it may write (see "Stage inputs and outputs" below).
+# The cache key is a hash of the stage command (with the
+# project path removed), the contents of the stage script,
+# the programs and helper scripts that the stage script
+# runs from the qflow binary and script directories, the
+# qflow version, project_vars.sh, the technology files, and
+# the stage's declared inputs.  The cached result is every
+# declared output that the stage created or modified.  A
+# stage not listed there declares all files in the source,
+# synthesis, and layout directories as inputs, and those
+# and the log directory as outputs.
+#
+# Caching is enabled by setting "stage_cache" in the file
+# project_vars.sh or QFLOW_CACHE_DIR in the environment
+# to the name of the cache directory.  The directory may
+# be shared between projects.
+#----------------------------------------------------------
+
+if ($#argv < 3) then
+   echo "Usage:  stagecache.sh <cache_dir> <project_path> <command ...>"
+   echo "  where"
+   echo "      <cache_dir> is the directory holding cached stage results,"
+   echo "      <project_path> is the name of the project directory containing"
+   echo "                a file called qflow_vars.sh, and"
+   echo "      <command ...> is the stage script and its arguments."
+   exit 1
+endif
+
+set cachedir=$argv[1]
+if (`echo ${cachedir} | cut -c1` != "/") then
+   set cachedir=`pwd`/${cachedir}
+endif
+set projectpath=$argv[2]
+set command=($argv[3-])
+set stage=${command[1]:t:r}
+
+# The stage scripts take the module name after the project path
+
+set rootname=""
+set i=2
+while ($i <= $#command)
+   @ j = $i - 1
+   if ("$command[$j]" == "${projectpath}") then
+      set rootname=$command[$i]
+      break
+   endif
+   @ i++
+end
+
+if (! -f ${projectpath}/qflow_vars.sh ) then
+   echo "Error:  Cannot find file qflow_vars.sh in path ${projectpath}"
+   exit 1
+endif
+
+source ${projectpath}/qflow_vars.sh
+cd ${projectpath}
+
+if (!($?logdir)) then
+   set logdir=${projectpath}/log
+endif
+mkdir -p ${logdir}
+mkdir -p ${cachedir}
+set cachelog=${logdir}/cache.log
+
+#----------------------------------------------------------
+# Stage inputs and outputs.  Each stage declares the files
+# that it reads from the project (its input netlist, DEF,
+# or layout, and any hint files the user may supply), and
+# the files that it may write.  Only the declared inputs
+# are part of the cache key, so that files written by later
+# stages (some of which, like the SPEF and GDS files, are
+# stamped with the date) do not change the key of an
+# earlier stage.  The patterns are quoted here and expanded
+# when they are used.
+#----------------------------------------------------------
+
+if (-f project_vars.sh) then
+   source project_vars.sh
+endif
+
+set nonomatch
+set lroot="${layoutdir}/${rootname}"
+set sroot="${synthdir}/${rootname}"
+set snetlist=("${sroot}.rtl.v" "${sroot}.rtlnopwr.v" "${sroot}.rtlbb.v" \
+		"${sroot}.spc" "${sroot}_powerground")
+set constraints=("${sourcedir}/${rootname}.clk" "${sourcedir}/${rootname}.sdc" \
+		"${sroot}.sdc" "${lroot}.sdc")
+
+# Without a module name, fall back to all files
+set outstage=${stage}
+if ("${rootname}" == "") set outstage=none
+
+switch (${outstage})
+   case yosys:
+      set inputs=("${sourcedir}/*.v" "${sourcedir}/*.sv" "${sourcedir}/*.vh" \
+		"${sourcedir}/*.svh" "${sourcedir}/${rootname}.fl")
+      set outputs=("${sourcedir}/${rootname}.ys" "${sroot}.*" "${sroot}_*" \
+		${logdir}/synth.log)
+      breaksw
+   case graywolf:
+   case replace:
+      set inputs=(${snetlist} "${sroot}_synth.*" "${sroot}_sized.v" \
+		"${lroot}.cel1" "${lroot}.cel2" "${lroot}.cfg2" "${lroot}.par")
+      # A .net file is an input only if the user wrote it;  one
+      # generated from the slack file is an output.
+      if ( ! -f "${lroot}.net.generated" ) set inputs=(${inputs} "${lroot}.net")
+      # The slack file is written by vesta after placement, and is
+      # only read when placement is weighted by timing.
+      if ( ${?timing_weights} ) then
+	 if ( "${timing_weights}" != "" ) set inputs=(${inputs} "${sroot}.slack")
+      endif
+      set outputs=("${lroot}.*" "${lroot}_*" "${sroot}.*" "${sroot}_*" \
+		${logdir}/place.log)
+      breaksw
+   case vesta:
+   case opensta:
+   case opentimer:
+      set inputs=(${snetlist} ${constraints})
+      # Wire parasitics are read only for back-annotated timing (-d)
+      foreach arg (${command})
+	 if ("${arg}" == "-d") set inputs=(${inputs} "${lroot}.rc")
+      end
+      set outputs=("${sroot}.*" "${sroot}_*" "${lroot}.*" "${lroot}_*" \
+		${logdir}/sta.log ${logdir}/post_sta.log)
+      breaksw
+   case qrouter:
+      set inputs=(${snetlist} "${lroot}.def" "${lroot}.cfg" "${lroot}.cfg2" \
+		"${lroot}.obs" "${lroot}.info")
+      set outputs=("${lroot}.*" "${lroot}_*" "${sroot}.*" "${sroot}_*" \
+		${logdir}/route.log)
+      breaksw
+   case magic_db:
+      set inputs=(${snetlist} "${lroot}.def" "${lroot}_route.def" \
+		${layoutdir}/.magicrc)
+      set outputs=("${lroot}.*" "${lroot}_*" ${layoutdir}/migrate_${rootname}.tcl \
+		${logdir}/magic_db.log ${logdir}/lvs.log)
+      breaksw
+   case magic_drc:
+      set inputs=("${lroot}.mag" ${layoutdir}/.magicrc)
+      set outputs=("${lroot}.*" "${lroot}_*" ${layoutdir}/run_drc_${rootname}.tcl \
+		${logdir}/drc.log)
+      breaksw
+   case netgen_lvs:
+      set inputs=("${sroot}.spc" "${sroot}.rtl.v" "${lroot}.spice" \
+		"${lroot}_setup.tcl" ${layoutdir}/setup.tcl)
+      set outputs=("${lroot}.*" "${lroot}_*" ${layoutdir}/comp.out \
+		${logdir}/lvs.log)
+      breaksw
+   case magic_gds:
+      set inputs=("${lroot}.mag" "${lroot}.def" "${lroot}_route.def" \
+		${layoutdir}/.magicrc)
+      set outputs=("${lroot}.*" "${lroot}_*" \
+		${layoutdir}/generate_gds_${rootname}.tcl ${logdir}/gdsii.log)
+      breaksw
+   default:
+      set inputs=(${sourcedir} ${synthdir} ${layoutdir})
+      set outputs=(${sourcedir} ${synthdir} ${layoutdir} ${logdir})
+      breaksw
+endsw
+
+# Hard macros (directories under the source directory) are
+# read by every stage.
+
+if ( ${?hard_macros} ) then
+   foreach macro_path ( $hard_macros )
+      set inputs=(${inputs} "${sourcedir}/${macro_path}")
+   end
+endif
+
+#----------------------------------------------------------
+# Compute the cache key.  File names are hashed relative
+# to the project or technology directory so that the key
+# does not depend on where the project is located.
+#----------------------------------------------------------
+
+set keyfile=${cachedir}/.key$$
+echo "qflow ${qflowversion} ${techname}" > ${keyfile}
+echo "${command}" | sed -e "s#${projectpath}#.#g" >> ${keyfile}
+sha1sum < $command[1] >> ${keyfile}
+
+# Programs and helper scripts run by the stage script, so that
+# installing a new version of a tool invalidates its results
+
+set toolpat='\$\{?(bindir|scriptdir)\}?/[A-Za-z0-9_.+-]+'
+set tools=`grep -ohE "${toolpat}" $command[1] | sed -e 's/[${}]//g' | sort -u`
+foreach tool (${tools})
+   if (${tool:h} == "bindir") then
+      set toolpath=${bindir}/${tool:t}
+   else
+      set toolpath=${scriptdir}/${tool:t}
+   endif
+   if (-f ${toolpath}) then
+      echo "${tool} `sha1sum < ${toolpath}`" >> ${keyfile}
+   endif
+end
+
+# Option variables
+
+if (-f project_vars.sh) then
+   sha1sum < project_vars.sh >> ${keyfile}
+endif
+
+# Technology files:  the technology setup script and the
+# LEF, liberty, SPICE, GDS, and magic files that it names
+
+source ${techdir}/${techname}.sh
+set techfiles=(${techname}.sh ${techname}.par ${techname}.prm)
+if ( ${?leffile} ) set techfiles=(${techfiles} ${leffile})
+if ( ${?techleffile} ) set techfiles=(${techfiles} ${techleffile})
+if ( ${?libertyfile} ) set techfiles=(${techfiles} ${libertyfile})
+if ( ${?spicefile} ) set techfiles=(${techfiles} ${spicefile})
+if ( ${?gdsfile} ) set techfiles=(${techfiles} ${gdsfile})
+if ( ${?magicrc} ) set techfiles=(${techfiles} ${magicrc})
+if ( ${?techfile} ) set techfiles=(${techfiles} ${techfile}.tech)
+foreach file (${techfiles})
+   set techpath=${file}
+   if (`echo ${file} | cut -c1` != "/") set techpath=${techdir}/${file}
+   if (-f ${techpath}) then
+      echo "${file:t} `sha1sum < ${techpath}`" >> ${keyfile}
+   endif
+end
+
+# Declared inputs of the stage
+
+set found=()
+foreach input (${inputs})
+   if (-e ${input}) set found=(${found} ${input})
+end
+if ($#found > 0) then
+   find -L ${found} -path ${cachedir} -prune -o -path ${logdir} -prune -o \
+		-type f ! -name qflow_exec.sh ! -name qflow_vars.sh -print | \
+		sort -u | xargs -r sha1sum | sed -e "s# ${projectpath}/# #" \
+		>> ${keyfile}
+endif
+
+set key=`sha1sum < ${keyfile} | cut -d' ' -f1`
+rm -f ${keyfile}
+set entry=${cachedir}/${key}
+
+#----------------------------------------------------------
+# On a cache hit, restore the stage outputs.  Files are
+# stored oldest first, and are given the current time
+# when extracted, so that the files keep their original
+# order but are all newer than the stage inputs.
+#----------------------------------------------------------
+
+if (-f ${entry}/files.tar) then
+   tar -C ${projectpath} -x -m -f ${entry}/files.tar
+   if ($status == 0) then
+      set saved=`cat ${entry}/runtime`
+      set nfiles=`cat ${entry}/files | wc -l`
+      echo "Stage ${stage}:  Inputs unchanged, restored ${nfiles} files from cache"
+      echo "Stage ${stage}:  Time saved ${saved} seconds"
+      echo "`date +%s` ${stage} hit ${key} ${saved}" >> ${cachelog}
+      set total=`awk '$3 == "hit" {t += $5} END {print t}' ${cachelog}`
+      echo "Total time saved by stage cache for this project:  ${total} seconds"
+      exit 0
+   endif
+   echo "Stage ${stage}:  Failed to restore cached result;  running stage."
+endif
+
+#----------------------------------------------------------
+# Cache miss:  run the stage and record the declared
+# outputs that it wrote.  The modification time and name
+# of each existing output, oldest first and relative to
+# the project, are listed before and after the stage.
+#----------------------------------------------------------
+
+set tmpentry=${cachedir}/.entry$$
+mkdir -p ${tmpentry}
+touch ${tmpentry}/before ${tmpentry}/after
+
+foreach pass (before after)
+   if (${pass} == "after") then
+      set start=`date +%s`
+
+      ${command}
+      set result=$status
+
+      set finish=`date +%s`
+      @ runtime = ${finish} - ${start}
+      echo "`date +%s` ${stage} miss ${key} ${runtime}" >> ${cachelog}
+
+      if (${result} != 0) then
+	 rm -rf ${tmpentry}
+	 exit ${result}
+      endif
+   endif
+
+   set found=()
+   foreach output (${outputs})
+      if (-e ${output}) set found=(${found} ${output})
+   end
+   if ($#found > 0) then
+      find -L ${found} -path ${cachedir} -prune -o -type f ! -name cache.log \
+		-printf "%T@ %p\n" | sort -n | awk '!seen[$2]++' | \
+		sed -e "s# ${projectpath}/# #" > ${tmpentry}/${pass}
+   endif
+end
+
+awk 'NR == FNR {old[$0] = 1; next} !old[$0] {print substr($0, index($0, " ") + 1)}' \
+	${tmpentry}/before ${tmpentry}/after > ${tmpentry}/files
+rm -f ${tmpentry}/before ${tmpentry}/after
+
+# Only files inside the project directory can be restored.
+
+set nabs=`grep -c '^/' ${tmpentry}/files`
+if (${nabs} != 0) then
+   echo "Stage ${stage}:  Outputs outside of project ${projectpath};  not cached."
+   rm -rf ${tmpentry}
+   exit 0
+endif
+
+tar -C ${projectpath} -c -f ${tmpentry}/files.tar -T ${tmpentry}/files
+if ($status != 0) then
+   rm -rf ${tmpentry}
+   exit 0
+endif
+echo ${runtime} > ${tmpentry}/runtime
+
+# Rename into place so that concurrent runs sharing the
+# cache never see a partial entry.
+
+if (-d ${entry}) then
+   rm -rf ${tmpentry}
+else
+   mv ${tmpentry} ${entry} >& /dev/null || rm -rf ${tmpentry}
+   set nfiles=`cat ${entry}/files | wc -l`
+   echo "Stage ${stage}:  Cached ${nfiles} output files (${runtime} seconds)"
+endif
+
+exit 0
@@ -150,16 +150,8 @@ if ($dodelays == 1) then
     # and contains delay information in nested RC pairs
     if ( -f ${rootname}.rc ) then
 
-       # Run rc2dly
-       echo "Converting qrouter output to vesta delay format" |& tee -a ${synthlog}
-       echo "Running rc2dly -r ${rootname}.rc -l ${libertypath} -V ${synthdir}/${rootname}.rtl.v" \
-		|& tee -a ${synthlog}
-       echo "-d ${rootname}.dly" |& tee -a ${synthlog}
-       ${bindir}/rc2dly -r ${rootname}.rc -l ${libertypath} \
-		-V ${synthdir}/${rootname}.rtl.v \
-		-d ${synthdir}/${rootname}.dly
-
-       # Run rc2dly again to get SPEF format file
+       # Run rc2dly to get SPEF format file.  vesta reads the SPEF
+       # file directly and computes the wire delays from it.
        echo "Converting qrouter output to SPEF delay format" |& tee -a ${synthlog}
        echo "Running rc2dly -D : -r ${rootname}.rc -l ${libertypath} -V ${synthdir}/${rootname}.rtl.v" \
 		|& tee -a ${synthlog}
@@ -200,11 +192,11 @@ if ($dodelays == 1) then
 
        cd ${synthdir}
 
-       # Spot check for output file (NOTE:  Currently not checking if SPEF
-       # or SDF format files were created)
-       if ( ! -f ${rootname}.dly || \
-		( -M ${rootname}.dly < -M ${layoutdir}/${rootname}.rc )) then
-	  echo "rc2dly failure:  No file ${rootname}.dly created." \
+       # Spot check for output file (NOTE:  Currently not checking if SDF
+       # format file was created)
+       if ( ! -f ${rootname}.spef || \
+		( -M ${rootname}.spef < -M ${layoutdir}/${rootname}.rc )) then
+	  echo "rc2dly failure:  No file ${rootname}.spef created." \
 		|& tee -a ${synthlog}
           echo "Premature exit." |& tee -a ${synthlog}
           echo "Synthesis flow stopped due to error condition." >> ${synthlog}
@@ -212,7 +204,7 @@ if ($dodelays == 1) then
        endif
 
        # Add delay file to vesta options, assuming it exists.
-       set vesta_options = "-c -d ${rootname}.dly ${vesta_options}"
+       set vesta_options = "-c -d ${rootname}.spef ${vesta_options}"
     else
        echo "Error:  No file ${rootname}.rc, cannot back-annotate delays!" \
 		|& tee -a ${synthlog}
@@ -222,6 +214,14 @@ if ($dodelays == 1) then
     endif
 endif
 
+# Use the clock constraints in the source directory, if there are any
+if ( -f ${sourcedir}/${rootname}.clk ) then
+   set vesta_options = "-k ${sourcedir}/${rootname}.clk ${vesta_options}"
+endif
+
+# Write per-net slack for timing-driven placement (see "timing_weights")
+set vesta_options = "-N ${rootname}.slack ${vesta_options}"
+
 cd ${synthdir}
 
 echo ""
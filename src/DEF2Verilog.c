@@ -33,6 +33,8 @@
 #include "readverilog.h"
 #include "readlef.h"
 #include "readdef.h"
+#include "outbuf.h"
+#include "profile.h"
 
 void write_output(struct cellrec *top, char *vlogoutname);
 void helpmessage(FILE *outf);
@@ -56,6 +58,8 @@ int main (int argc, char *argv[])
     char *vloginname = NULL;
     char *vlogoutname = NULL;
 
+    ProfileInit(argv[0]);
+
     while ((i = getopt(argc, argv, "hHv:o:l:p:g:")) != EOF) {
 	switch( i ) {
 	    case 'h':
@@ -67,7 +71,9 @@ int main (int argc, char *argv[])
 		vloginname = strdup(optarg);
 		break;
 	    case 'l':
+		ProfileBegin("parse LEF");
 		LefRead(optarg);	/* Can be called multiple times */
+		ProfileEnd();
 		break;
 	    case 'p':
 		VddNet = strdup(optarg);
@@ -98,40 +104,41 @@ int main (int argc, char *argv[])
     }
     optind++;
 
+    ProfileBegin("parse Verilog");
     if (vloginname)
 	topcell = ReadVerilog(vloginname);
     else {
 	fprintf(stderr, "No verilog file specified (not yet handled).\n");
 	return 1;
     }
+    ProfileEnd();
+
+    ProfileBegin("parse DEF");
     result = DefRead(definname, &rscale);
+    ProfileEnd();
+
+    ProfileBegin("write output");
     write_output(topcell, vlogoutname);
+    ProfileEnd();
     return 0;
 }
 
-/* Structure to hold a pointer to a net record and an array bound pair */
+/* Structure to hold the wire name and array index of one net */
 
-struct busData {
-    NET net;
-    int start;
-    int end;
+struct netBit {
+    char *name;
+    int idx;
 };
 
 /*----------------------------------------------------------------------*/
-/* Recursion callback function for each item in the NetTable hash	*/
+/* Get the wire name and array index of a net from the DEF file.	*/
 /*----------------------------------------------------------------------*/
 
-struct nlist *hash_nets(struct hashlist *p, void *cptr)
+void net_bit(NET net, struct netBit *bit)
 {
-    struct hashtable *NetHash = (struct hashtable *)cptr;
-    NET net;
     char *dptr, *sptr, *bptr;
-    struct busData *bdata;
     int aidx;
 
-    /* Get gate from hash record */
-    net = (NET)(p->ptr);
-
     /* Check for array delimiters. */
     dptr = strrchr(net->netname, '[');
     if (dptr != NULL) {
@@ -172,64 +179,96 @@ struct nlist *hash_nets(struct hashlist *p, void *cptr)
 	    sprintf(newname, "\\%s ", net->netname);
 	    free(net->netname);
 	    net->netname = newname;
+	    dptr = NULL;	/* Index is not part of the new name */
 	}
     }
 
-
-    /* Check if record already exists */
-    bdata = HashLookup(net->netname, NetHash);  
-    if (bdata == NULL) {
-	/* Allocate record */
-	bdata = (struct busData *)malloc(sizeof(struct busData));
-	bdata->start = bdata->end = aidx;
-	bdata->net = net;
-	HashPtrInstall(net->netname, bdata, NetHash);
-    }
-    else {
-	if (aidx != -1) {
-	    if (aidx > bdata->start) bdata->start = aidx;
-	    if (aidx < bdata->end) bdata->end = aidx;
-	}
-    }
+    bit->name = strdup(net->netname);
+    bit->idx = aidx;
     if (dptr != NULL) *dptr = '[';
-    return NULL;
 }
 
-/*--------------------------------------------------------------------------*/
-/* Recursion callback function for each item in the cellrec nets hash table */
-/*--------------------------------------------------------------------------*/
+/*----------------------------------------------------------------------*/
+/* Sort nets by wire name, then by array index.				*/
+/*----------------------------------------------------------------------*/
 
-struct nlist *output_wires(struct hashlist *p, void *cptr)
+int netbit_compare(const void *a, const void *b)
 {
-    struct busData *bdata;
-    FILE *outf = (FILE *)cptr;
+    struct netBit *bit1 = (struct netBit *)a;
+    struct netBit *bit2 = (struct netBit *)b;
+    int result;
 
-    bdata = (struct busData *)(p->ptr);
+    result = strcmp(bit1->name, bit2->name);
+    if (result != 0) return result;
+    return (bit1->idx > bit2->idx) ? 1 : (bit1->idx < bit2->idx) ? -1 : 0;
+}
 
-    fprintf(outf, "wire ");
-    if (bdata->start >= 0 && bdata->end >= 0) {
-	fprintf(outf, "[%d:%d] ", bdata->start, bdata->end);
+/*----------------------------------------------------------------------*/
+/* Output one wire declaration.  "start" and "end" are the array bounds	*/
+/* or -1 if the wire is not an array.					*/
+/*----------------------------------------------------------------------*/
+
+void output_wire(FILE *outf, char *name, int start, int end)
+{
+    fputs("wire ", outf);
+    if (start >= 0 && end >= 0) {
+	putc('[', outf);
+	OutputInt(outf, start);
+	putc(':', outf);
+	OutputInt(outf, end);
+	fputs("] ", outf);
     }
-    fprintf(outf, "%s", p->name);
+    fputs(name, outf);
 
     // Ensure backslash escaped names end in a space character per
     // verilog syntax.
-    if (*(p->name) == '\\')
-	if (*(p->name + strlen(p->name) - 1) != ' ')
-	    fprintf(outf, " ");
+    if (*name == '\\')
+	if (*(name + strlen(name) - 1) != ' ')
+	    putc(' ', outf);
 
     /* NOTE:  The output format is fixed with power and ground		*/
     /* specified as wires and set to binary values.  May want		*/
     /* additional command line options for various forms;  otherwise,	*/
     /* vlog2Verilog can translate between forms.			*/
 	
-    if (VddNet && (!strcmp(p->name, VddNet)))
-	fprintf(outf, " = 1'b1");
-    else if (GndNet && (!strcmp(p->name, GndNet)))
-	fprintf(outf, " = 1'b0");
+    if (VddNet && (!strcmp(name, VddNet)))
+	fputs(" = 1'b1", outf);
+    else if (GndNet && (!strcmp(name, GndNet)))
+	fputs(" = 1'b0", outf);
 
-    fprintf(outf, " ;\n");
-    return NULL;
+    fputs(" ;\n", outf);
+}
+
+/*----------------------------------------------------------------------*/
+/* Output all wires, sorted by name.  Nets which are bits of the same	*/
+/* bus sort together, so each bus is found in a single pass.		*/
+/*----------------------------------------------------------------------*/
+
+void output_wires(FILE *outf)
+{
+    struct netBit *bits;
+    int i, j, start, end;
+
+    if (Numnets == 0) return;
+
+    bits = (struct netBit *)malloc(Numnets * sizeof(struct netBit));
+    for (i = 0; i < Numnets; i++)
+	net_bit(Nlnets[i], &bits[i]);
+
+    qsort(bits, Numnets, sizeof(struct netBit), netbit_compare);
+
+    for (i = 0; i < Numnets; i = j) {
+	start = end = bits[i].idx;
+	for (j = i + 1; j < Numnets; j++) {
+	    if (strcmp(bits[j].name, bits[i].name)) break;
+	    if (bits[j].idx > start) start = bits[j].idx;
+	    if (bits[j].idx < end) end = bits[j].idx;
+	}
+	output_wire(outf, bits[i].name, start, end);
+    }
+
+    for (i = 0; i < Numnets; i++) free(bits[i].name);
+    free(bits);
 }
 
 /*----------------------------------------------------------------------*/
@@ -247,24 +286,23 @@ struct nlist *output_props(struct hashlist *p, void *cptr)
 }
 
 /*----------------------------------------------------------------------*/
-/* Recursion callback function for each item in InstanceTable		*/
-/* Output all module instances.						*/
+/* Output one module instance.						*/
 /*----------------------------------------------------------------------*/
 
-struct nlist *output_instances(struct hashlist *p, void *cptr)
+void output_instance(GATE gate, FILE *outf)
 {
-    GATE gate = (GATE)(p->ptr);
-    FILE *outf = (FILE *)cptr;
     NODE node;
     BUS bus;
     int i, j, lastidx, nbus;
     char ***net_array = NULL;
 
     /* Ignore pins which are recorded as gates */
-    if (gate->gatetype == PinMacro) return NULL;
+    if (gate->gatetype == PinMacro) return;
 
-    fprintf(outf, "%s ", gate->gatetype->gatename);
-    fprintf(outf, "%s (\n", gate->gatename);
+    fputs(gate->gatetype->gatename, outf);
+    putc(' ', outf);
+    fputs(gate->gatename, outf);
+    fputs(" (\n", outf);
 
     /* In case power/ground pins are at the end of the list, find the	*/
     /* index of the last valid output line.  Consider any input pin	*/
@@ -341,9 +379,13 @@ struct nlist *output_instances(struct hashlist *p, void *cptr)
 		}
 	    }
 
-	    fprintf(outf, "    .%s(%s)", gate->node[i], netname);
-	    if ((i != lastidx) || (gate->bus != NULL)) fprintf(outf, ",");
-	    fprintf(outf, "\n");
+	    fputs("    .", outf);
+	    fputs(gate->node[i], outf);
+	    putc('(', outf);
+	    fputs(netname, outf);
+	    putc(')', outf);
+	    if ((i != lastidx) || (gate->bus != NULL)) putc(',', outf);
+	    putc('\n', outf);
 	}
 	if (is_nc_input) free(netname);
     }
@@ -390,7 +432,7 @@ struct nlist *output_instances(struct hashlist *p, void *cptr)
 	fprintf(outf, "\n");
     }
 
-    fprintf(outf, ");\n\n");
+    fputs(");\n\n", outf);
 
     if (gate->gatetype->bus != NULL) {
 	/* Free memory allocated to net arrays */
@@ -401,8 +443,6 @@ struct nlist *output_instances(struct hashlist *p, void *cptr)
 	}
 	free(net_array);
     }
-
-    return NULL;
 }
 
 /*--------------------------------------------------------------*/
@@ -422,10 +462,8 @@ void write_output(struct cellrec *topcell, char *vlogoutname)
     struct instance *inst;
     GATE gate;
 
-    struct hashtable NetHash;
-
     if (vlogoutname != NULL) {
-	outfptr = fopen(vlogoutname, "w");
+	outfptr = OutputOpen(vlogoutname);
 	if (outfptr == NULL) {
 	    fprintf(stderr, "Error:  Failed to open file %s for writing netlist output\n",
 			vlogoutname);
@@ -433,8 +471,6 @@ void write_output(struct cellrec *topcell, char *vlogoutname)
 	}
     }
 
-    InitializeHashTable(&NetHash, LARGEHASHSIZE);
-
     /* Write output module header */
     fprintf(outfptr, "/* Verilog module written by DEF2Verilog (qflow) */\n");
     fprintf(outfptr, "module %s (\n", topcell->name);
@@ -464,20 +500,25 @@ void write_output(struct cellrec *topcell, char *vlogoutname)
     }
     fprintf(outfptr, ");\n\n");
 
-    /* Find all wires and create a hash table */
+    /* Write all wires, sorted by name */
     /* (To do: cross check against topcell->nets to ensure correct array bounds) */
 
-    RecurseHashTablePointer(&NetTable, hash_nets, &NetHash);
-    RecurseHashTablePointer(&NetHash, output_wires, outfptr);
+    output_wires(outfptr);
     fprintf(outfptr, "\n");
 
-    /* Write instances in the order found in the DEF file */
-    RecurseHashTablePointer(&InstanceTable, output_instances, outfptr);
+    /* Write instances in the order found in the DEF file.  Nlgates	*/
+    /* is in reverse order, so start at the end and work backwards.	*/
+
+    for (gate = Nlgates; gate && gate->next; gate = gate->next);
+    for (; gate; gate = gate->last)
+	output_instance(gate, outfptr);
 
     /* End the module */
     fprintf(outfptr, "endmodule\n");
 
-    if (vlogoutname != NULL) fclose(outfptr);
+    if (vlogoutname != NULL)
+	if (OutputClose(outfptr) != 0)
+	    fprintf(stderr, "Error:  Failed writing file %s\n", vlogoutname);
 
     fflush(stdout);
 }
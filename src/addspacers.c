@@ -45,6 +45,7 @@
 #include "hash.h"
 #include "readlef.h"
 #include "readdef.h"
+#include "profile.h"
 
 /* Flags fields */
 
@@ -114,13 +115,37 @@ typedef struct _powerstripe {
     char       *name;	    // Net name of power rail
 } powerstripe;
 
-/* Hash table of instances hashed by (X, Y) position */
-struct hashtable CellPosTable;
+/* Instances placed in one core row, keyed by site-aligned X position.	*/
+/* Multiple-height cells have an entry in each row they occupy.		*/
+
+typedef struct _cellpos {
+    int	x;	    // Site-aligned left edge of instance
+    int	order;	    // Order of entry (later entries replace earlier)
+    GATE gate;
+} cellpos;
+
+typedef struct _cellrow *CELLROW;
+
+typedef struct _cellrow {
+    int	y;	    // Bottom edge of row
+    int	num;	    // Number of entries in cells
+    int	max;	    // Allocated size of cells
+    cellpos *cells; // Entries, sorted by X after cellrow_sort()
+} cellrow;
+
+/* Rows of instances, sorted by Y position */
+CELLROW *CellRows = NULL;
+int NumCellRows = 0;
+int MaxCellRows = 0;
 
 /* Hash table of site macros hashed by site name */
 struct hashtable SiteDefTable;
 
 /* Forward declarations */
+CELLROW cellrow_find(int y, unsigned char create);
+void cellrow_add(CELLROW crow, int x, GATE gate);
+void cellrow_sort(CELLROW crow);
+GATE cellrow_next(CELLROW crow, int *idx, int x);
 unsigned char check_overcell_capable(unsigned char Flags);
 FILLLIST generate_fill(char *fillcellname, float rscale, COREBBOX corearea,
 	unsigned char Flags);
@@ -133,6 +158,7 @@ void fix_obstructions(char *definname, SINFO stripevals, float scale,
 PSTRIPE generate_stripes(SINFO stripevals, FILLLIST fillcells,
 	COREBBOX corearea, char *stripepat, char *VddNet, char *GndNet,
 	float scale, unsigned char Flags);
+void copy_block(FILE *infptr, FILE *outfptr, long start, long end);
 void write_output(char *definname, char *defoutname, float scale,
 	    COREBBOX corearea, SINFO stripevals, PSTRIPE rails,
 	    char *VddNet, char *GndNet, unsigned char Flags);
@@ -167,6 +193,8 @@ int main (int argc, char *argv[])
     Flags = 0;
     stripewidth_t = stripepitch_t = 0.0;
 
+    ProfileInit(argv[0]);
+
     while ((i = getopt(argc, argv, "hHvOno:l:p:g:f:w:P:s:")) != EOF) {
         switch( i ) {
 	    case 'v':
@@ -222,7 +250,9 @@ int main (int argc, char *argv[])
 		}
 		break;
             case 'l':
+		ProfileBegin("parse LEF");
                 LefRead(optarg);        /* Can be called multiple times */
+		ProfileEnd();
                 break;
             case 'p':
                 VddNet = strdup(optarg);
@@ -255,10 +285,13 @@ int main (int argc, char *argv[])
     }
     optind++;
 
+    ProfileBegin("parse DEF");
     result = DefRead(definname, &rscale);
+    ProfileEnd();
 
     corearea = (COREBBOX)malloc(sizeof(corebbox));
 
+    ProfileBegin("generate fill");
     Flags |= check_overcell_capable(Flags);
     fillcells = generate_fill(fillcellname, rscale, corearea, Flags);
     if (fillcells == NULL) {
@@ -271,12 +304,122 @@ int main (int argc, char *argv[])
     fix_obstructions(definname, stripevals, rscale, Flags);
     rails = generate_stripes(stripevals, fillcells, corearea, stripepat,
 	    VddNet, GndNet, rscale, Flags);
+    ProfileEnd();
+
+    ProfileBegin("write output");
     write_output(definname, defoutname, rscale, corearea, stripevals,
 	    rails, VddNet, GndNet, Flags);
+    ProfileEnd();
 
     return 0;
 }
 
+/*--------------------------------------------------------------*/
+/* Find the row of instances whose bottom edge is at position y	*/
+/* (binary search on CellRows).  If "create" is TRUE and the	*/
+/* row does not exist, then make a new, empty row.		*/
+/*--------------------------------------------------------------*/
+
+CELLROW
+cellrow_find(int y, unsigned char create)
+{
+    int lo = 0, hi = NumCellRows, mid;
+    CELLROW crow;
+
+    while (lo < hi) {
+	mid = (lo + hi) >> 1;
+	if (CellRows[mid]->y == y) return CellRows[mid];
+	else if (CellRows[mid]->y < y) lo = mid + 1;
+	else hi = mid;
+    }
+    if (create == FALSE) return NULL;
+
+    if (NumCellRows == MaxCellRows) {
+	MaxCellRows = (MaxCellRows == 0) ? 64 : MaxCellRows * 2;
+	CellRows = (CELLROW *)realloc(CellRows, MaxCellRows * sizeof(CELLROW));
+    }
+    memmove(CellRows + lo + 1, CellRows + lo, (NumCellRows - lo) * sizeof(CELLROW));
+    NumCellRows++;
+
+    crow = (CELLROW)malloc(sizeof(cellrow));
+    crow->y = y;
+    crow->num = 0;
+    crow->max = 0;
+    crow->cells = NULL;
+    CellRows[lo] = crow;
+    return crow;
+}
+
+/*--------------------------------------------------------------*/
+/* Add an instance at position x to a row.  The row must be	*/
+/* sorted with cellrow_sort() before it is searched.		*/
+/*--------------------------------------------------------------*/
+
+void
+cellrow_add(CELLROW crow, int x, GATE gate)
+{
+    if (crow->num == crow->max) {
+	crow->max = (crow->max == 0) ? 16 : crow->max * 2;
+	crow->cells = (cellpos *)realloc(crow->cells, crow->max * sizeof(cellpos));
+    }
+    crow->cells[crow->num].x = x;
+    crow->cells[crow->num].order = crow->num;
+    crow->cells[crow->num].gate = gate;
+    crow->num++;
+}
+
+/*--------------------------------------------------------------*/
+/* Sort the instances of a row by position.  If more than one	*/
+/* instance was recorded at the same position, keep only the	*/
+/* last one recorded.						*/
+/*--------------------------------------------------------------*/
+
+static int
+cellpos_compare(const void *a, const void *b)
+{
+    cellpos *pa = (cellpos *)a;
+    cellpos *pb = (cellpos *)b;
+
+    if (pa->x != pb->x) return (pa->x < pb->x) ? -1 : 1;
+    return (pa->order < pb->order) ? -1 : (pa->order > pb->order) ? 1 : 0;
+}
+
+void
+cellrow_sort(CELLROW crow)
+{
+    int i, j;
+
+    if (crow->num < 2) return;
+    qsort(crow->cells, crow->num, sizeof(cellpos), cellpos_compare);
+
+    for (i = 0, j = 0; i < crow->num; i++) {
+	if ((i + 1 < crow->num) && (crow->cells[i + 1].x == crow->cells[i].x))
+	    continue;
+	crow->cells[j] = crow->cells[i];
+	crow->cells[j].order = j;
+	j++;
+    }
+    crow->num = j;
+}
+
+/*--------------------------------------------------------------*/
+/* Return the instance at position x in a sorted row, or NULL	*/
+/* if there is none.  "idx" is a cursor into the row that is	*/
+/* advanced past all entries left of x, so that a sweep across	*/
+/* the row with increasing x is linear in the number of		*/
+/* instances.  Initialize *idx to zero at the start of a sweep.	*/
+/*--------------------------------------------------------------*/
+
+GATE
+cellrow_next(CELLROW crow, int *idx, int x)
+{
+    if (crow == NULL) return NULL;
+    while ((*idx < crow->num) && (crow->cells[*idx].x < x)) (*idx)++;
+    if ((*idx < crow->num) && (crow->cells[*idx].x == x))
+	return crow->cells[*idx].gate;
+    return NULL;
+}
+
 /*--------------------------------------------------------------*/
 /* Find empty spaces in the DEF layout and insert fill macros	*/
 /*--------------------------------------------------------------*/
@@ -286,11 +429,13 @@ generate_fill(char *fillcellname, float scale, COREBBOX corearea, unsigned char
 {
     GATE gate, newfillinst;
     ROW row;
+    CELLROW crow;
     int isfill, orient;
     int defcorew = 1, defcoreh = 0, testh, fillh;
     int corew = 1, coreh = 0;
     int instx, insty, instw, insth, fnamelen;
     int x, y, dx, nx, fillmin;
+    int i, idx, numcells;
     char posname[32];
 
     int corellx = 0;
@@ -398,11 +543,9 @@ generate_fill(char *fillcellname, float scale, COREBBOX corearea, unsigned char
 	return NULL;
     }
 
-    /* Rehash all instances by position */
+    /* Index all instances by row and position */
     /* Find minimum and maximum bounds, and record cell in lower left position */
 
-    InitializeHashTable(&CellPosTable, LARGEHASHSIZE);
-
     /* Do one pass to get core boundaries */
 
     for (gate = Nlgates; gate; gate = gate->next)
@@ -430,7 +573,7 @@ generate_fill(char *fillcellname, float scale, COREBBOX corearea, unsigned char
 	}
     }
 
-    /* Do second pass to record cell positions in a hash table */
+    /* Do second pass to record cell positions in the rows */
 
     for (gate = Nlgates; gate; gate = gate->next)
     {
@@ -456,8 +599,7 @@ generate_fill(char *fillcellname, float scale, COREBBOX corearea, unsigned char
 	    instx = corellx + m * defcorew;
 	}
 
-	sprintf(posname, "%dx%d", instx, insty);
-	HashPtrInstall(posname, gate, &CellPosTable);
+	cellrow_add(cellrow_find(insty, TRUE), instx, gate);
 
 	/* If cell is a multiple row height, mark its position in all	*/
 	/* rows that it occupies.					*/
@@ -465,13 +607,15 @@ generate_fill(char *fillcellname, float scale, COREBBOX corearea, unsigned char
 	if (insth > defcoreh) {
 	    locy = insty + defcoreh;
 	    while (locy < insty + insth) {
-		sprintf(posname, "%dx%d", instx, locy);
-		HashPtrInstall(posname, gate, &CellPosTable);
+		cellrow_add(cellrow_find(locy, TRUE), instx, gate);
 		locy += defcoreh;
 	    }
 	}
     }
 
+    for (i = 0; i < NumCellRows; i++)
+	cellrow_sort(CellRows[i]);
+
 
     if (Flags & VERBOSE) {
 	row = DefFindRow(corelly);
@@ -501,17 +645,19 @@ generate_fill(char *fillcellname, float scale, COREBBOX corearea, unsigned char
 	corearea->orient = row->orient & (RN | RS);
     }
     else {
+	/* Take the orientation of the first cell found stepping	*/
+	/* across the lowest row by the narrowest fill cell width.	*/
+
 	corearea->orient = RN;
-	y = corelly;
-	x = corellx;
-	while (x < coreurx) {
-	    sprintf(posname, "%dx%d", x, y);
-	    gate = (GATE)HashLookup(posname, &CellPosTable);
+	for (testfill = fillcells; testfill->next; testfill = testfill->next);
+	crow = cellrow_find(corelly, FALSE);
+	idx = 0;
+	for (x = corellx; x < coreurx; x += testfill->width) {
+	    gate = cellrow_next(crow, &idx, x);
 	    if (gate != NULL) {
 		corearea->orient = gate->orient & (RN | RS);
 		break;
 	    }
-	    x += testfill->width;
 	}
     }
     orient = corearea->orient;
@@ -535,16 +681,24 @@ generate_fill(char *fillcellname, float scale, COREBBOX corearea, unsigned char
 		coreh = (int)(roundf(gate->height * scale));
 	    }
 	}
+	crow = cellrow_find(y, TRUE);
+	/* Fill instances are appended to the row as they are	*/
+	/* created, always left of x, and the row is re-sorted	*/
+	/* when done.  Only the original entries are searched.	*/
+	numcells = crow->num;
+	idx = 0;
 	x = corellx;
 	while (x < coreurx) {
-	    sprintf(posname, "%dx%d", x, y);
-	    gate = (GATE)HashLookup(posname, &CellPosTable);
+	    gate = cellrow_next(crow, &idx, x);
 	    if (gate == NULL) {
-		for (nx = x + corew; nx < coreurx; nx += corew) {
-		    sprintf(posname, "%dx%d", nx, y);
-		    gate = (GATE)HashLookup(posname, &CellPosTable);
-		    if (gate != NULL) break;
+		/* The gap ends at the next instance on a site boundary */
+		/* of this row, or else at the right edge of the core.	*/
+		for (i = idx; i < numcells; i++) {
+		    nx = crow->cells[i].x;
+		    if ((nx < coreurx) && (((nx - x) % corew) == 0)) break;
 		}
+		if (i >= numcells)
+		    nx = x + ((coreurx - x + corew - 1) / corew) * corew;
 		if (Flags & VERBOSE)
 		    fprintf(stdout, "Add fill from (%d %d) to (%d %d)\n",
 				x, y, nx, y);
@@ -591,9 +745,8 @@ generate_fill(char *fillcellname, float scale, COREBBOX corearea, unsigned char
 			    (newfillinst->orient == RS)) newfillinst->orient |= RF;
 		    DefAddGateInstance(newfillinst);
 
-		    /* Hash the new instance position */
-		    sprintf(posname, "%dx%d", x, y);
-		    HashPtrInstall(posname, newfillinst, &CellPosTable);
+		    /* Record the new instance position */
+		    cellrow_add(crow, x, newfillinst);
 
 		    if (testfill) {
 			x += testfill->width;
@@ -617,6 +770,8 @@ generate_fill(char *fillcellname, float scale, COREBBOX corearea, unsigned char
 		x += gw;
 	    }
 	}
+	cellrow_sort(crow);
+
 	/* Flip orientation each row (NOTE:  This is not needed if ROW	*/
 	/* statements are in the DEF file!				*/
 	orient = (orient == RN) ? RS : RN;
@@ -684,6 +839,8 @@ generate_stripefill(char *VddNet, char *GndNet, char *stripepat,
     char posname[32];
     GATE gate, newfillinst;
     ROW row;
+    CELLROW crow;
+    int idx;
 
     stripevals = (SINFO)malloc(sizeof(stripeinfo));
     stripevals->pitch = 0;
@@ -850,8 +1007,9 @@ generate_stripefill(char *VddNet, char *GndNet, char *stripepat,
 
 	    x = corearea->llx;
 
-	    sprintf(posname, "%dx%d", x, y);
-	    gate = (GATE)HashLookup(posname, &CellPosTable);
+	    crow = cellrow_find(y, FALSE);
+	    idx = 0;
+	    gate = cellrow_next(crow, &idx, x);
 
 	    while (x < corearea->urx) {
 		while (x < nextx) {
@@ -864,8 +1022,7 @@ generate_stripefill(char *VddNet, char *GndNet, char *stripepat,
 
 		    gate->placedX += (double)totalfx / (double)scale;
 
-		    sprintf(posname, "%dx%d", nx, y);
-		    gate = (GATE)HashLookup(posname, &CellPosTable);
+		    gate = cellrow_next(crow, &idx, nx);
 		    x = nx;
 
 		    if ((x >= corearea->urx) || (gate == NULL)) break;
@@ -894,7 +1051,7 @@ generate_stripefill(char *VddNet, char *GndNet, char *stripepat,
 		    DefAddGateInstance(newfillinst);
 
 		    /* Position will not be revisited, so no need to 	*/
-		    /* add to the position hash.			*/
+		    /* add to the row.					*/
 
 		    totalfx += testfill->width;
 		}
@@ -1748,6 +1905,35 @@ output_rails(FILE *outfptr, PSTRIPE rail, COREBBOX corearea, float scale, int fi
     }
 }
 
+/*--------------------------------------------------------------*/
+/* copy_block ---						*/
+/*								*/
+/*  Copy bytes "start" up to "end" of the input file verbatim	*/
+/*  to the output, in large blocks.  If "end" is negative, copy	*/
+/*  to the end of the file.					*/
+/*--------------------------------------------------------------*/
+
+#define COPY_BLOCK_SIZE 1048576
+
+void
+copy_block(FILE *infptr, FILE *outfptr, long start, long end)
+{
+    static char *block = NULL;
+    size_t want, nread;
+
+    if (block == NULL) block = (char *)malloc(COPY_BLOCK_SIZE);
+
+    fseek(infptr, start, SEEK_SET);
+    while ((end < 0) || (start < end)) {
+	want = COPY_BLOCK_SIZE;
+	if ((end >= 0) && (end - start < (long)want)) want = (size_t)(end - start);
+	nread = fread(block, 1, want, infptr);
+	if (nread == 0) break;
+	fwrite(block, 1, nread, outfptr);
+	start += (long)nread;
+    }
+}
+
 /*--------------------------------------------------------------*/
 /* write_output ---						*/
 /*								*/
@@ -1760,8 +1946,8 @@ write_output(char *definname, char *defoutname, float scale,
 	char *VddNet, char *GndNet, unsigned char Flags)
 {
     FILE *outfptr, *infptr;
-    static char line[LEF_LINE_MAX + 2];
-    char *sptr;
+    char *header, *line, *eol, *sptr, savec;
+    long compoff, netsoff, specoff, endoff, hoff;
     int i, copyspecial = 0, numVias, foundrail[2], ltop;
     double lh, ly;
 
@@ -1798,22 +1984,48 @@ write_output(char *definname, char *defoutname, float scale,
     }
     numSpecial = ((foundrail[0] == TRUE) ? 1 : 0) + ((foundrail[1] == TRUE) ? 1 : 0);
 
-    /* Write DEF header (copy input DEF file verbatim up to COMPONENTS) */
+    /* The positions of the sections of the input DEF file were	*/
+    /* recorded by DefRead().  Only the header is parsed again;	*/
+    /* NETS and everything following are copied in large blocks.	*/
+
+    compoff = DefSectionOffset("COMPONENTS", 0);
+    if (compoff < 0) {
+	fprintf(stderr, "Error:  End of file reached before COMPONENTS.\n");
+	return;
+    }
+    netsoff = DefSectionOffset("NETS", compoff);
+    if (netsoff < 0) {
+	fprintf(stderr, "Error:  End of file reached before NETS.\n");
+	return;
+    }
+    endoff = DefSectionOffset("END", netsoff);
+    specoff = DefSectionOffset("SPECIALNETS", netsoff);
+    if ((endoff >= 0) && (specoff > endoff)) specoff = -1;
 
     infptr = fopen(definname, "r");
-    while (1) {
-	if (fgets(line, LEF_LINE_MAX + 1, infptr) == NULL) {
-	    fprintf(stderr, "Error:  End of file reached before COMPONENTS.\n");
-	    return;
-	}
+    if (infptr == NULL) {
+	fprintf(stderr, "Error:  Failed to reopen input file %s\n", definname);
+	return;
+    }
+
+    /* Write DEF header (copy input DEF file verbatim up to COMPONENTS) */
+
+    header = (char *)malloc(compoff + 1);
+    compoff = (long)fread(header, 1, (size_t)compoff, infptr);
+    header[compoff] = '\0';
+
+    for (hoff = 0; hoff < compoff; hoff = eol - header) {
+	line = header + hoff;
+	eol = memchr(line, '\n', compoff - hoff);
+	eol = (eol == NULL) ? header + compoff : eol + 1;
+	savec = *eol;
+	*eol = '\0';
+
 	sptr = line;
 	while (isspace(*sptr)) sptr++;
-	
-	/* Assuming a typical DEF file here. . . */
-	if (!strncmp(sptr, "COMPONENTS", 10)) break;
 
 	/* Rewrite DIEAREA, ROWS, and TRACKS */
-	else if (!strncmp(sptr, "DIEAREA", 7)) {
+	if (!strncmp(sptr, "DIEAREA", 7)) {
 	    char *dptr;
 	    int dllx, dlly, durx, dury;
 
@@ -1905,8 +2117,11 @@ write_output(char *definname, char *defoutname, float scale,
 		    o, roffset, rnum, rpitch, layer);
 	}
 	else
-	    fprintf(outfptr, "%s", line);
+	    fwrite(line, 1, eol - line, outfptr);
+
+	*eol = savec;
     }
+    free(header);
 
     /* Write generated vias for posts */
 
@@ -2060,36 +2275,24 @@ write_output(char *definname, char *defoutname, float scale,
 	fprintf(outfptr, "END PINS\n\n");
     }
 
-    while (1) {
-	if (fgets(line, LEF_LINE_MAX + 1, infptr) == NULL) {
-	    fprintf(stderr, "Error:  End of file reached before NETS.\n");
-	    return;
-	}
-	sptr = line;
-	while (isspace(*sptr)) sptr++;
-	
-	/* Assuming a typical DEF file here. . . */
-	if (!strncmp(sptr, "NETS", 4)) break;
+    /* Copy NETS up to SPECIALNETS or END DESIGN verbatim */
 
-    }
-    fprintf(outfptr, "%s", line);
-    while (1) {
-	if (fgets(line, LEF_LINE_MAX + 1, infptr) == NULL) {
-	    fprintf(stderr, "Error:  End of file reached before END NETS.\n");
-	    return;
-	}
-	sptr = line;
-	while (isspace(*sptr)) sptr++;
+    copy_block(infptr, outfptr, netsoff, (specoff >= 0) ? specoff : endoff);
+
+    if (specoff >= 0) {
+	/* Get the original number of SPECIALNETS and skip the line */
+	char countline[64];
+	int c;
 
-	/* Assuming a typical DEF file here. . . */
-	if (!strncmp(sptr, "SPECIALNETS", 11)) {
+	fseek(infptr, specoff, SEEK_SET);
+	if (fgets(countline, 64, infptr) != NULL) {
+	    sptr = countline;
+	    while (isspace(*sptr)) sptr++;
 	    sscanf(sptr + 11, "%d", &copyspecial);
-	    break;
+	    if (strchr(countline, '\n') == NULL)
+		while (((c = getc(infptr)) != EOF) && (c != '\n'));
 	}
-	else if (!strncmp(sptr, "END DESIGN", 10)) {
-	    break;
-	}
-	fprintf(outfptr, "%s", line);
+	specoff = ftell(infptr);
     }
 
     /* Rewrite SPECIALNETS line with updated number */
@@ -2121,16 +2324,8 @@ write_output(char *definname, char *defoutname, float scale,
 
     /* Copy the remainder of the file verbatim */
 
-    while (1) {
-	if (fgets(line, LEF_LINE_MAX + 1, infptr) == NULL) break;
-	sptr = line;
-	while (isspace(*sptr)) sptr++;
-	
-	if (!strncmp(sptr, "END DESIGN", 10)) {
-	    break;
-	}
-	fprintf(outfptr, "%s", line);
-    }
+    if (specoff >= 0)
+	copy_block(infptr, outfptr, specoff, endoff);
     fprintf(outfptr, "END DESIGN\n");
     fclose(infptr);
 
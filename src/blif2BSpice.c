@@ -17,6 +17,8 @@
 #include <ctype.h>
 #include <float.h>
 
+#include "profile.h"
+
 #define	EXIT_SUCCESS	0
 #define	EXIT_FAILURE	1
 #define	EXIT_HELP	2
@@ -78,6 +80,8 @@ int main (int argc, char *argv[])
     char *gndnet = NULL;
     char *subnet = NULL;
 
+    ProfileInit(argv[0]);
+
     // Use implicit power if power and ground nodes are global in SPICE
     // Otherwise, use "-p".
 
@@ -14,6 +14,8 @@
 #include <ctype.h>
 #include <float.h>
 
+#include "profile.h"
+
 #define	EXIT_SUCCESS	0
 #define	EXIT_FAILURE	1
 #define	EXIT_HELP	2
@@ -72,6 +74,8 @@ int main ( int argc, char *argv[])
 	VddNet = strdup("VDD");
 	GndNet = strdup("VSS");
 
+	ProfileInit(argv[0]);
+
         while( (i = getopt( argc, argv, "pbchnHv:g:" )) != EOF ) {
 	   switch( i ) {
 	   case 'p':
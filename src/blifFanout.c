@@ -72,6 +72,7 @@
 
 #include "hash.h"		/* for hash table functions */
 #include "readliberty.h"	/* liberty file database */
+#include "profile.h"		/* run time profiling */
 
 #define  FALSE	     0
 #define  TRUE        1
@@ -293,6 +294,8 @@ int main (int argc, char *argv[])
    InitializeHashTable(&Gatehash, LARGEHASHSIZE);
    InitializeHashTable(&Basehash, LARGEHASHSIZE);
 
+   ProfileInit(argv[0]);
+
    fprintf(stdout, "blifFanout for qflow " QFLOW_VERSION "." QFLOW_REVISION "\n");
 
    while ((i = getopt(argc, argv, "fLSgnhvl:c:b:i:o:p:s:I:F:")) != EOF) {
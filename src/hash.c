@@ -404,4 +404,44 @@ void *HashFirst(struct hashtable *table)
   return(HashNext(table));
 }
 
+/*----------------------------------------------------------------------*/
+/* Case-insensitive install and lookup, for tables of names that are	*/
+/* compared without regard to case (such as cell and macro names),	*/
+/* whatever hashfunc and matchfunc are set to.  Unlike HashPtrInstall,	*/
+/* HashNoCasePtrInstall does not replace an existing entry:  where	*/
+/* names differ only in case, the first one installed is kept, as a	*/
+/* search through a list for the name would have found.  Returns the	*/
+/* entry for the name.							*/
+/*----------------------------------------------------------------------*/
+
+struct hashlist *HashNoCasePtrInstall(char *name, void *ptr,
+			struct hashtable *table)
+{
+  struct hashlist *np;
+  unsigned long hashval;
+
+  hashval = hashnocase(name, table->hashsize);
+  for (np = table->hashtab[hashval]; np != NULL; np = np->next)
+    if (matchnocase(name, np->name)) return (np);
+
+  /* not in table, so install it */
+  if ((np = (struct hashlist *) calloc(1,sizeof(struct hashlist))) == NULL)
+    return (NULL);
+  if ((np->name = strdup(name)) == NULL) return (NULL);
+  np->ptr = ptr;
+  np->next = table->hashtab[hashval];
+  return(table->hashtab[hashval] = np);
+}
+
+void *HashNoCaseLookup(char *s, struct hashtable *table)
+{
+  struct hashlist *np;
+  unsigned long hashval;
+
+  hashval = hashnocase(s, table->hashsize);
+  for (np = table->hashtab[hashval]; np != NULL; np = np->next)
+    if (matchnocase(s, np->name)) return (np->ptr);
+  return (NULL);
+}
+
 
@@ -39,10 +39,13 @@ extern struct hashlist *HashPtrInstall(char *name, void *ptr,
 		struct hashtable *table);
 extern struct hashlist *HashIntPtrInstall(char *name, int value, void *ptr, 
 		struct hashtable *table);
+extern struct hashlist *HashNoCasePtrInstall(char *name, void *ptr,
+		struct hashtable *table);
 
 /* these functions return the ->ptr field of a struct hashtable */
 extern void *HashLookup(char *s, struct hashtable *table);
 extern void *HashIntLookup(char *s, int i, struct hashtable *table);
+extern void *HashNoCaseLookup(char *s, struct hashtable *table);
 extern void *HashFirst(struct hashtable *table);
 extern void *HashNext(struct hashtable *table);
 
@@ -0,0 +1,549 @@
+/*----------------------------------------------------------------------*/
+/* libqflow.c --							*/
+/*									*/
+/*	Library interface to the qflow readers and to vesta (see	*/
+/*	libqflow.h).							*/
+/*									*/
+/*	The LEF and DEF readers keep their database in global		*/
+/*	variables, which the command-line tools depend on.  Rather	*/
+/*	than rewrite the readers, each context keeps its own copy of	*/
+/*	those globals, and the copies are swapped in when a call is	*/
+/*	made on a context other than the one last used.  The verilog	*/
+/*	netlist and liberty cells are already returned as data		*/
+/*	structures and are simply held by the context.  The liberty	*/
+/*	cells of readliberty.c have no timing arcs, so the context	*/
+/*	also holds vesta's own database of the same files, parsed	*/
+/*	once and passed to each run of vesta.				*/
+/*									*/
+/*	The LEF and DEF readers have no routines to free their		*/
+/*	database, so that memory is not reclaimed when a context is	*/
+/*	destroyed or a new DEF file is read.				*/
+/*----------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+
+#include "hash.h"
+#include "readverilog.h"
+#include "readliberty.h"
+#include "readlef.h"
+#include "readdef.h"
+#include "vesta.h"
+#include "libqflow.h"
+
+#define QFLOW_ERROR_MAX 256
+
+/*----------------------------------------------------------------------*/
+/* Saved copy of the LEF and DEF reader globals				*/
+/*----------------------------------------------------------------------*/
+
+typedef struct _qflowLefDef {
+    GATE GateInfo;
+    struct hashtable MacroTable;
+    LefList LefInfo;
+    LinkedStringPtr AllowedVias;
+
+    int Numnets;
+    int Numgates;
+    int Numpins;
+    int numSpecial;
+    struct hashtable InstanceTable;
+    struct hashtable NetTable;
+    struct hashtable RowTable;
+    char *DEFDesignName;
+    DSEG UserObs;
+    double Xlowerbound, Xupperbound, Ylowerbound, Yupperbound;
+    double PitchX, PitchY;
+    NET *Nlnets;
+    GATE Nlgates;
+    GATE PinMacro;
+} qflowLefDef;
+
+struct _QflowContext {
+    qflowLefDef lefdef;		/* LEF/DEF globals while not active	*/
+    u_char hasdef;		/* A DEF file has been read		*/
+
+    struct cellrec *topcell;	/* Verilog netlist, or NULL		*/
+    struct instance **insts;	/* Instances in file order		*/
+    int numinsts;
+    struct portrec **ports;	/* Ports in file order			*/
+    int numports;
+    struct hashtable insttable;	/* Instance name to insts[] entry	*/
+
+    Cell *libcells;		/* All liberty cells read		*/
+    VestaLibrary vestalib;	/* The same files, parsed by vesta	*/
+    VestaResults timing;	/* Results of the last vesta run	*/
+    u_char hastiming;		/* "timing" is valid			*/
+
+    char error[QFLOW_ERROR_MAX];
+};
+
+/* The context whose LEF/DEF data is currently in the globals */
+
+static QflowContext *ActiveContext = NULL;
+
+/*----------------------------------------------------------------------*/
+/* Copy the reader globals to or from a saved state			*/
+/*----------------------------------------------------------------------*/
+
+static void
+qflow_save(qflowLefDef *s)
+{
+    s->GateInfo = GateInfo;
+    s->MacroTable = MacroTable;
+    s->LefInfo = LefInfo;
+    s->AllowedVias = AllowedVias;
+    s->Numnets = Numnets;
+    s->Numgates = Numgates;
+    s->Numpins = Numpins;
+    s->numSpecial = numSpecial;
+    s->InstanceTable = InstanceTable;
+    s->NetTable = NetTable;
+    s->RowTable = RowTable;
+    s->DEFDesignName = DEFDesignName;
+    s->UserObs = UserObs;
+    s->Xlowerbound = Xlowerbound;
+    s->Xupperbound = Xupperbound;
+    s->Ylowerbound = Ylowerbound;
+    s->Yupperbound = Yupperbound;
+    s->PitchX = PitchX;
+    s->PitchY = PitchY;
+    s->Nlnets = Nlnets;
+    s->Nlgates = Nlgates;
+    s->PinMacro = PinMacro;
+}
+
+static void
+qflow_restore(qflowLefDef *s)
+{
+    GateInfo = s->GateInfo;
+    MacroTable = s->MacroTable;
+    LefInfo = s->LefInfo;
+    AllowedVias = s->AllowedVias;
+    Numnets = s->Numnets;
+    Numgates = s->Numgates;
+    Numpins = s->Numpins;
+    numSpecial = s->numSpecial;
+    InstanceTable = s->InstanceTable;
+    NetTable = s->NetTable;
+    RowTable = s->RowTable;
+    DEFDesignName = s->DEFDesignName;
+    UserObs = s->UserObs;
+    Xlowerbound = s->Xlowerbound;
+    Xupperbound = s->Xupperbound;
+    Ylowerbound = s->Ylowerbound;
+    Yupperbound = s->Yupperbound;
+    PitchX = s->PitchX;
+    PitchY = s->PitchY;
+    Nlnets = s->Nlnets;
+    Nlgates = s->Nlgates;
+    PinMacro = s->PinMacro;
+}
+
+/* Set a saved state to that of a program that has read nothing */
+
+static void
+qflow_init_lefdef(qflowLefDef *s)
+{
+    memset(s, 0, sizeof(qflowLefDef));
+    s->PitchX = 1.0;
+    s->PitchY = 1.0;
+}
+
+/*----------------------------------------------------------------------*/
+/* Make "ctx" the active context.  The readers use the case-sensitive	*/
+/* hash functions, which other users of hash.c may have changed.	*/
+/*----------------------------------------------------------------------*/
+
+static void
+qflow_activate(QflowContext *ctx)
+{
+    hashfunc = hash;
+    matchfunc = match;
+
+    if (ctx == ActiveContext) return;
+    if (ActiveContext != NULL) qflow_save(&ActiveContext->lefdef);
+    qflow_restore(&ctx->lefdef);
+    ActiveContext = ctx;
+}
+
+static int
+qflow_error(QflowContext *ctx, char *fmt, ...)
+{
+    va_list args;
+
+    va_start(args, fmt);
+    vsnprintf(ctx->error, QFLOW_ERROR_MAX, fmt, args);
+    va_end(args);
+    return 1;
+}
+
+/*----------------------------------------------------------------------*/
+/* Discard the verilog netlist of a context				*/
+/*----------------------------------------------------------------------*/
+
+static void
+qflow_free_netlist(QflowContext *ctx)
+{
+    if (ctx->topcell == NULL) return;
+
+    HashKill(&ctx->insttable);
+    free(ctx->insts);
+    free(ctx->ports);
+    FreeVerilog(ctx->topcell);
+
+    ctx->topcell = NULL;
+    ctx->insts = NULL;
+    ctx->numinsts = 0;
+    ctx->ports = NULL;
+    ctx->numports = 0;
+}
+
+/*----------------------------------------------------------------------*/
+/* Context creation and destruction					*/
+/*----------------------------------------------------------------------*/
+
+QflowContext *
+QflowCreate(void)
+{
+    QflowContext *ctx;
+
+    ctx = (QflowContext *)calloc(1, sizeof(QflowContext));
+    if (ctx == NULL) return NULL;
+    qflow_init_lefdef(&ctx->lefdef);
+    return ctx;
+}
+
+void
+QflowDestroy(QflowContext *ctx)
+{
+    if (ctx == NULL) return;
+
+    /* Leave the globals as for a program that has read nothing */
+    if (ctx == ActiveContext) {
+	qflow_init_lefdef(&ctx->lefdef);
+	qflow_restore(&ctx->lefdef);
+	ActiveContext = NULL;
+    }
+
+    qflow_free_netlist(ctx);
+    delete_cell_list(ctx->libcells);
+    VestaFreeLiberty(ctx->vestalib);
+    if (ctx->hastiming) VestaFreeResults(&ctx->timing);
+    free(ctx);
+}
+
+const char *
+QflowError(QflowContext *ctx)
+{
+    return ctx->error;
+}
+
+/*----------------------------------------------------------------------*/
+/* File readers								*/
+/*----------------------------------------------------------------------*/
+
+int
+QflowReadLef(QflowContext *ctx, const char *filename)
+{
+    qflow_activate(ctx);
+    if (LefRead((char *)filename) == 0)
+	return qflow_error(ctx, "Cannot read LEF file %s", filename);
+    return 0;
+}
+
+int
+QflowReadDef(QflowContext *ctx, const char *filename, float *scale)
+{
+    float oscale;
+
+    qflow_activate(ctx);
+    if (GateInfo == NULL)
+	return qflow_error(ctx, "No LEF macros read before DEF file %s", filename);
+
+    Nlgates = NULL;
+    Nlnets = NULL;
+    Numnets = Numgates = Numpins = numSpecial = 0;
+    UserObs = NULL;
+
+    if (DefRead((char *)filename, &oscale) != 0)
+	return qflow_error(ctx, "Error reading DEF file %s", filename);
+    ctx->hasdef = TRUE;
+    if (scale) *scale = oscale;
+    return 0;
+}
+
+int
+QflowReadVerilog(QflowContext *ctx, const char *filename)
+{
+    struct cellrec *topcell;
+    struct instance *inst;
+    struct portrec *port;
+    int i;
+
+    qflow_activate(ctx);
+    topcell = ReadVerilog((char *)filename);
+    if (topcell == NULL)
+	return qflow_error(ctx, "Cannot read verilog file %s", filename);
+
+    qflow_free_netlist(ctx);
+    ctx->topcell = topcell;
+
+    for (inst = topcell->instlist; inst; inst = inst->next) ctx->numinsts++;
+    for (port = topcell->portlist; port; port = port->next) ctx->numports++;
+
+    ctx->insts = (struct instance **)malloc((ctx->numinsts + 1) *
+		sizeof(struct instance *));
+    ctx->ports = (struct portrec **)malloc((ctx->numports + 1) *
+		sizeof(struct portrec *));
+    InitializeHashTable(&ctx->insttable, (ctx->numinsts > SMALLHASHSIZE) ?
+		LARGEHASHSIZE : SMALLHASHSIZE);
+
+    for (i = 0, inst = topcell->instlist; inst; inst = inst->next, i++) {
+	ctx->insts[i] = inst;
+	if (HashLookup(inst->instname, &ctx->insttable) == NULL)
+	    HashPtrInstall(inst->instname, &ctx->insts[i], &ctx->insttable);
+    }
+    for (i = 0, port = topcell->portlist; port; port = port->next, i++)
+	ctx->ports[i] = port;
+
+    return 0;
+}
+
+int
+QflowReadLiberty(QflowContext *ctx, const char *filename)
+{
+    Cell *cells, *lastcell;
+
+    cells = read_liberty((char *)filename, NULL);
+    if (cells == NULL)
+	return qflow_error(ctx, "Cannot read liberty file %s", filename);
+    if (VestaReadLiberty(&ctx->vestalib, (char *)filename) != 0) {
+	delete_cell_list(cells);
+	return qflow_error(ctx, "Cannot read liberty file %s", filename);
+    }
+
+    /* Append, so that earlier files take precedence as in vesta */
+    if (ctx->libcells == NULL)
+	ctx->libcells = cells;
+    else {
+	for (lastcell = ctx->libcells; lastcell->next; lastcell = lastcell->next);
+	lastcell->next = cells;
+    }
+    return 0;
+}
+
+/*----------------------------------------------------------------------*/
+/* Verilog netlist queries						*/
+/*----------------------------------------------------------------------*/
+
+const char *
+QflowModuleName(QflowContext *ctx)
+{
+    return (ctx->topcell) ? ctx->topcell->name : NULL;
+}
+
+int
+QflowNumPorts(QflowContext *ctx)
+{
+    return ctx->numports;
+}
+
+const char *
+QflowPortName(QflowContext *ctx, int port)
+{
+    if ((port < 0) || (port >= ctx->numports)) return NULL;
+    return ctx->ports[port]->name;
+}
+
+int
+QflowPortDirection(QflowContext *ctx, int port)
+{
+    if ((port < 0) || (port >= ctx->numports)) return QFLOW_DIR_NONE;
+
+    /* readverilog.h PORT_* values are the same as QFLOW_DIR_* */
+    return ctx->ports[port]->direction;
+}
+
+int
+QflowNumInstances(QflowContext *ctx)
+{
+    return ctx->numinsts;
+}
+
+int
+QflowFindInstance(QflowContext *ctx, const char *name)
+{
+    struct instance **entry;
+
+    if (ctx->topcell == NULL) return -1;
+    hashfunc = hash;
+    matchfunc = match;
+    entry = (struct instance **)HashLookup((char *)name, &ctx->insttable);
+    return (entry) ? (int)(entry - ctx->insts) : -1;
+}
+
+const char *
+QflowInstanceName(QflowContext *ctx, int inst)
+{
+    if ((inst < 0) || (inst >= ctx->numinsts)) return NULL;
+    return ctx->insts[inst]->instname;
+}
+
+const char *
+QflowInstanceCell(QflowContext *ctx, int inst)
+{
+    if ((inst < 0) || (inst >= ctx->numinsts)) return NULL;
+    return ctx->insts[inst]->cellname;
+}
+
+/* Return the pin connection record "pin" of instance "inst" */
+
+static struct portrec *
+qflow_inst_port(QflowContext *ctx, int inst, int pin)
+{
+    struct portrec *port;
+
+    if ((inst < 0) || (inst >= ctx->numinsts) || (pin < 0)) return NULL;
+    for (port = ctx->insts[inst]->portlist; port && pin > 0; port = port->next)
+	pin--;
+    return port;
+}
+
+int
+QflowInstanceNumPins(QflowContext *ctx, int inst)
+{
+    struct portrec *port;
+    int numpins = 0;
+
+    if ((inst < 0) || (inst >= ctx->numinsts)) return 0;
+    for (port = ctx->insts[inst]->portlist; port; port = port->next)
+	numpins++;
+    return numpins;
+}
+
+const char *
+QflowInstancePin(QflowContext *ctx, int inst, int pin)
+{
+    struct portrec *port = qflow_inst_port(ctx, inst, pin);
+    return (port) ? port->name : NULL;
+}
+
+const char *
+QflowInstanceNet(QflowContext *ctx, int inst, int pin)
+{
+    struct portrec *port = qflow_inst_port(ctx, inst, pin);
+    return (port) ? port->net : NULL;
+}
+
+/*----------------------------------------------------------------------*/
+/* DEF placement of a component						*/
+/*----------------------------------------------------------------------*/
+
+int
+QflowInstancePlacement(QflowContext *ctx, const char *name, double *x,
+		double *y, int *orient)
+{
+    GATE gate;
+
+    if (!ctx->hasdef) return qflow_error(ctx, "No DEF file has been read");
+
+    qflow_activate(ctx);
+    gate = DefFindGate((char *)name);
+    if (gate == NULL) return qflow_error(ctx, "No component %s in DEF", name);
+
+    if (x) *x = gate->placedX;
+    if (y) *y = gate->placedY;
+    if (orient) *orient = gate->orient;
+    return 0;
+}
+
+/*----------------------------------------------------------------------*/
+/* Liberty pin capacitance						*/
+/*----------------------------------------------------------------------*/
+
+int
+QflowCellPinCap(QflowContext *ctx, const char *cellname, const char *pinname,
+		double *cap)
+{
+    Cell *cell;
+
+    cell = get_cell_by_name(ctx->libcells, (char *)cellname);
+    if (cell == NULL)
+	return qflow_error(ctx, "No liberty cell %s", cellname);
+    if (get_pincap(cell, (char *)pinname, cap) < 0)
+	return qflow_error(ctx, "No pin %s of liberty cell %s", pinname, cellname);
+    return 0;
+}
+
+/*----------------------------------------------------------------------*/
+/* Static timing analysis of the context's netlist			*/
+/*----------------------------------------------------------------------*/
+
+int
+QflowRunTiming(QflowContext *ctx, int argc, char *argv[])
+{
+    char **vargv;
+    int vargc, i, result;
+
+    if (ctx->topcell == NULL)
+	return qflow_error(ctx, "No verilog netlist has been read");
+    if (ctx->vestalib == NULL)
+	return qflow_error(ctx, "No liberty file has been read");
+
+    /* Command line is "vesta <options>";  the liberty files were read */
+
+    vargv = (char **)malloc((argc + 2) * sizeof(char *));
+    vargc = 0;
+    vargv[vargc++] = "vesta";
+    for (i = 0; i < argc; i++) vargv[vargc++] = argv[i];
+    vargv[vargc] = NULL;
+
+    if (ctx->hastiming) VestaFreeResults(&ctx->timing);
+    ctx->hastiming = FALSE;
+
+    qflow_activate(ctx);
+    result = VestaRun(vargc, vargv, ctx->topcell, ctx->vestalib, &ctx->timing);
+    free(vargv);
+
+    if (result != 0) return qflow_error(ctx, "Static timing analysis failed");
+    ctx->hastiming = TRUE;
+    return 0;
+}
+
+int
+QflowTimingResults(QflowContext *ctx, QflowTimingResult *result)
+{
+    if (!ctx->hastiming)
+	return qflow_error(ctx, "No timing analysis has been run");
+
+    result->maxdelay = ctx->timing.maxdelay;
+    result->mindelay = ctx->timing.mindelay;
+    result->setupslack = ctx->timing.setupslack;
+    result->holdslack = ctx->timing.holdslack;
+    result->constrained = ctx->timing.constrained;
+    result->setupfail = ctx->timing.setupfail;
+    result->holdfail = ctx->timing.holdfail;
+    result->numpaths = ctx->timing.numpaths;
+    return 0;
+}
+
+int
+QflowTimingPath(QflowContext *ctx, int path, const char **start,
+		const char **end, double *delay, double *slack)
+{
+    VestaPath *vpath;
+
+    if (!ctx->hastiming || (path < 0) || (path >= ctx->timing.numpaths))
+	return -1;
+
+    vpath = &ctx->timing.paths[path];
+    if (start) *start = vpath->start;
+    if (end) *end = vpath->end;
+    if (delay) *delay = vpath->delay;
+    if (!vpath->checked) return 1;
+    if (slack) *slack = vpath->slack;
+    return 0;
+}
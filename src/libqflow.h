@@ -0,0 +1,121 @@
+/*----------------------------------------------------------------------*/
+/* libqflow.h --							*/
+/*									*/
+/*	C interface to the qflow LEF, DEF, verilog, and liberty readers	*/
+/*	and to the vesta static timing analyzer, for use by programs	*/
+/*	that link libqflow.so instead of running the qflow tools as	*/
+/*	separate processes and parsing their output files.		*/
+/*									*/
+/*	All data belong to a context created by QflowCreate().  Any	*/
+/*	number of contexts may exist at once, each holding its own	*/
+/*	design.  The library is not thread-safe:  calls on different	*/
+/*	contexts must not be made concurrently.				*/
+/*									*/
+/*	Functions returning int return 0 on success and nonzero on	*/
+/*	error, unless noted otherwise;  QflowError() then describes	*/
+/*	the error.  Strings returned belong to the context and are	*/
+/*	valid until the context is destroyed.				*/
+/*----------------------------------------------------------------------*/
+
+#ifndef _LIBQFLOW_H
+#define _LIBQFLOW_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct _QflowContext QflowContext;
+
+/* Port and pin directions returned by QflowPortDirection() */
+
+#define QFLOW_DIR_NONE		0
+#define QFLOW_DIR_INPUT		1
+#define QFLOW_DIR_OUTPUT	2
+#define QFLOW_DIR_INOUT		3
+
+/* Context creation and destruction */
+
+extern QflowContext *QflowCreate(void);
+extern void QflowDestroy(QflowContext *ctx);
+extern const char *QflowError(QflowContext *ctx);
+
+/* File readers.  LEF must be read before DEF.  QflowReadDef() sets	*/
+/* "scale" (if non-NULL) to the DEF database units per micron.  Each	*/
+/* QflowReadVerilog() or QflowReadDef() replaces the previous netlist	*/
+/* or placement of the context.  Liberty files accumulate.		*/
+
+extern int QflowReadLef(QflowContext *ctx, const char *filename);
+extern int QflowReadDef(QflowContext *ctx, const char *filename, float *scale);
+extern int QflowReadVerilog(QflowContext *ctx, const char *filename);
+extern int QflowReadLiberty(QflowContext *ctx, const char *filename);
+
+/* Verilog netlist queries.  Instances and ports are numbered from 0	*/
+/* in the order of the verilog file.  Functions returning a count	*/
+/* return 0, and functions returning a string return NULL, for an	*/
+/* index out of range or when no netlist has been read.			*/
+
+extern const char *QflowModuleName(QflowContext *ctx);
+extern int QflowNumPorts(QflowContext *ctx);
+extern const char *QflowPortName(QflowContext *ctx, int port);
+extern int QflowPortDirection(QflowContext *ctx, int port);
+extern int QflowNumInstances(QflowContext *ctx);
+extern int QflowFindInstance(QflowContext *ctx, const char *name);  /* -1 if none */
+extern const char *QflowInstanceName(QflowContext *ctx, int inst);
+extern const char *QflowInstanceCell(QflowContext *ctx, int inst);
+extern int QflowInstanceNumPins(QflowContext *ctx, int inst);
+extern const char *QflowInstancePin(QflowContext *ctx, int inst, int pin);
+extern const char *QflowInstanceNet(QflowContext *ctx, int inst, int pin);
+
+/* DEF placement of the component "name", in microns.  "orient" is the	*/
+/* orientation bit mask defined in lef.h (MX, MY, RN, RS, ...).  Any	*/
+/* of the return pointers may be NULL.					*/
+
+extern int QflowInstancePlacement(QflowContext *ctx, const char *name,
+		double *x, double *y, int *orient);
+
+/* Liberty pin capacitance of pin "pinname" of cell "cellname", in fF */
+
+extern int QflowCellPinCap(QflowContext *ctx, const char *cellname,
+		const char *pinname, double *cap);
+
+/* Run vesta on the context's verilog netlist and liberty files.	*/
+/* "argv" holds vesta command line options only (e.g. "-p", "10000",	*/
+/* "-d", "design.dly");  "argc" may be 0.  The report is written to	*/
+/* standard output as by the vesta program, and the results are kept	*/
+/* by the context until the next run.					*/
+
+extern int QflowRunTiming(QflowContext *ctx, int argc, char *argv[]);
+
+/* Results of the last QflowRunTiming().  Times are in ps.  Slacks	*/
+/* are valid only if "constrained" is set, i.e. a clock period or	*/
+/* clock file was given.  With several corners, delays and hold slack	*/
+/* are the worst over all corners, and the setup slack and paths are	*/
+/* those of the corner with the worst setup slack.			*/
+
+typedef struct _QflowTimingResult {
+    double maxdelay;		/* Longest maximum delay path		*/
+    double mindelay;		/* Shortest minimum delay path		*/
+    double setupslack;		/* Worst setup slack			*/
+    double holdslack;		/* Worst hold slack			*/
+    int constrained;		/* Set if paths have required times	*/
+    int setupfail;		/* Set if a path fails setup		*/
+    int holdfail;		/* Set if a path fails hold		*/
+    int numpaths;		/* Number of critical paths		*/
+} QflowTimingResult;
+
+extern int QflowTimingResults(QflowContext *ctx, QflowTimingResult *result);
+
+/* Critical path "path" (0 to numpaths - 1, longest first, as in the	*/
+/* report).  "start" and "end" are "instance/pin" or an output pin	*/
+/* name.  "slack" is set only for a path with a required time, and	*/
+/* the return value is then 0;  it is 1 for a path without one, and	*/
+/* -1 for an index out of range.  Any return pointer may be NULL.	*/
+
+extern int QflowTimingPath(QflowContext *ctx, int path, const char **start,
+		const char **end, double *delay, double *slack);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _LIBQFLOW_H */
@@ -0,0 +1,80 @@
+/*----------------------------------------------------------------------*/
+/* netweight.c --							*/
+/*									*/
+/* Read the net slack file written by "vesta -N", which has one line	*/
+/* per net with the net name, the worst slack of the paths through	*/
+/* the net, and its criticality from 0 to 1 (lines starting with "#"	*/
+/* are comments).  Each net is given a weight that grows with the	*/
+/* square of its criticality, from 1 for a net with no critical path	*/
+/* to NETWEIGHT_MAX, so that only the nets near the critical paths	*/
+/* pull their cells together.						*/
+/*----------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hash.h"
+#include "netweight.h"
+
+#define WEIGHT_LINE_MAX 2048
+
+/*----------------------------------------------------------------------*/
+/* Read the net slack file "filename" into the hash table "weights",	*/
+/* which must have been initialized.  Return the number of nets read,	*/
+/* or -1 if the file cannot be read.					*/
+/*----------------------------------------------------------------------*/
+
+int NetWeightRead(char *filename, struct hashtable *weights)
+{
+    FILE *f;
+    char line[WEIGHT_LINE_MAX], name[WEIGHT_LINE_MAX + 1];
+    char *token, *sptr;
+    double slack, crit, *wptr;
+    int numnets = 0;
+
+    f = fopen(filename, "r");
+    if (f == NULL) {
+	fprintf(stderr, "Cannot open net slack file %s for reading\n", filename);
+	return -1;
+    }
+
+    while (fgets(line, WEIGHT_LINE_MAX, f) != NULL) {
+	token = strtok(line, " \t\n");
+	if ((token == NULL) || (*token == '#')) continue;
+	sptr = strtok(NULL, "\n");
+	if ((sptr == NULL) || (sscanf(sptr, "%lg %lg", &slack, &crit) != 2)) {
+	    fprintf(stderr, "Bad line for net \"%s\" in net slack file %s\n",
+			token, filename);
+	    continue;
+	}
+
+	/* A backslash-escaped verilog name ends with a space */
+	strcpy(name, token);
+	if (*name == '\\') strcat(name, " ");
+
+	if (crit < 0.0) crit = 0.0;
+	if (crit > 1.0) crit = 1.0;
+	wptr = (double *)HashLookup(name, weights);
+	if (wptr == NULL) {
+	    wptr = (double *)malloc(sizeof(double));
+	    HashPtrInstall(name, wptr, weights);
+	    numnets++;
+	}
+	*wptr = 1.0 + (NETWEIGHT_MAX - 1.0) * crit * crit;
+    }
+    fclose(f);
+    return numnets;
+}
+
+/*----------------------------------------------------------------------*/
+/* Return the weight of net "netname", or 0 if it is not in "weights".	*/
+/*----------------------------------------------------------------------*/
+
+double NetWeight(char *netname, struct hashtable *weights)
+{
+    double *wptr;
+
+    wptr = (double *)HashLookup(netname, weights);
+    return (wptr == NULL) ? 0.0 : *wptr;
+}
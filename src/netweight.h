@@ -0,0 +1,20 @@
+/*
+ * netweight.h --
+ *
+ * Net weights for timing-driven placement, from the net slack file
+ * written by "vesta -N" (vlog2Cel, vlog2Def).
+ *
+ */
+
+#ifndef _NETWEIGHT_H
+#define _NETWEIGHT_H
+
+#include "hash.h"
+
+/* Weight of a net of criticality 1;  a net of criticality 0 has weight 1 */
+#define NETWEIGHT_MAX	5.0
+
+extern int    NetWeightRead(char *filename, struct hashtable *weights);
+extern double NetWeight(char *netname, struct hashtable *weights);
+
+#endif /* _NETWEIGHT_H */
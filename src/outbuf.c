@@ -0,0 +1,101 @@
+/*----------------------------------------------------------------------*/
+/* outbuf.c --								*/
+/*									*/
+/* Buffered output shared by the netlist writers.  Output files are	*/
+/* given a large stdio buffer so that a netlist of millions of lines	*/
+/* is flushed with a few large writes, and integers are formatted	*/
+/* directly into the stream without going through fprintf().  The	*/
+/* writers use fputs() and putc() for fixed text and names, which	*/
+/* avoids parsing a format string for every port of every instance.	*/
+/*----------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "outbuf.h"
+
+/* Output files opened with OutputOpen() and their buffers */
+
+#define MAX_OUTPUTS 8
+
+static struct {
+    FILE *f;
+    char *buf;
+} Outputs[MAX_OUTPUTS];
+
+/*----------------------------------------------------------------------*/
+/* Open file "filename" for writing with a buffer of OUTPUT_BUFSIZE	*/
+/* bytes.  If "filename" is NULL, return stdout, which is left with	*/
+/* its default buffering since it may already have been written to.	*/
+/* Returns NULL if the file cannot be opened.				*/
+/*----------------------------------------------------------------------*/
+
+FILE *OutputOpen(char *filename)
+{
+    FILE *f;
+    int i;
+
+    if (filename == NULL) return stdout;
+
+    f = fopen(filename, "w");
+    if (f == NULL) return NULL;
+
+    for (i = 0; i < MAX_OUTPUTS; i++) {
+	if (Outputs[i].f == NULL) {
+	    Outputs[i].buf = (char *)malloc(OUTPUT_BUFSIZE);
+	    if (Outputs[i].buf == NULL) break;
+	    if (setvbuf(f, Outputs[i].buf, _IOFBF, OUTPUT_BUFSIZE) != 0) {
+		free(Outputs[i].buf);
+		break;
+	    }
+	    Outputs[i].f = f;
+	    break;
+	}
+    }
+    /* If no buffer could be attached, the file keeps stdio's default */
+    return f;
+}
+
+/*----------------------------------------------------------------------*/
+/* Close a file opened with OutputOpen() and release its buffer.	*/
+/* stdout is flushed but not closed.  Returns the result of fclose()	*/
+/* or fflush(), so that a failed write (e.g., disk full) is reported.	*/
+/*----------------------------------------------------------------------*/
+
+int OutputClose(FILE *f)
+{
+    int i, result;
+
+    if (f == stdout) return fflush(f);
+
+    result = fclose(f);
+    for (i = 0; i < MAX_OUTPUTS; i++) {
+	if (Outputs[i].f == f) {
+	    free(Outputs[i].buf);
+	    Outputs[i].f = NULL;
+	    Outputs[i].buf = NULL;
+	    break;
+	}
+    }
+    return result;
+}
+
+/*----------------------------------------------------------------------*/
+/* Write an integer in decimal, same as fprintf(f, "%d", value).	*/
+/*----------------------------------------------------------------------*/
+
+void OutputInt(FILE *f, int value)
+{
+    char digits[12];
+    char *dptr = digits + sizeof(digits);
+    unsigned int uval;
+
+    uval = (value < 0) ? -(unsigned int)value : (unsigned int)value;
+    do {
+	*(--dptr) = '0' + (uval % 10);
+	uval /= 10;
+    } while (uval > 0);
+    if (value < 0) *(--dptr) = '-';
+
+    fwrite(dptr, 1, digits + sizeof(digits) - dptr, f);
+}
@@ -0,0 +1,21 @@
+/*
+ * outbuf.h --
+ *
+ * Buffered output for the netlist writers (vlog2Verilog, vlog2Spice,
+ * vlog2Def, vlog2Cel, DEF2Verilog).
+ *
+ */
+
+#ifndef _OUTBUF_H
+#define _OUTBUF_H
+
+#include <stdio.h>
+
+/* Size of the stdio buffer attached to each output file */
+#define OUTPUT_BUFSIZE	(1 << 20)
+
+extern FILE *OutputOpen(char *filename);
+extern int   OutputClose(FILE *f);
+extern void  OutputInt(FILE *f, int value);
+
+#endif /* _OUTBUF_H */
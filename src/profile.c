@@ -0,0 +1,166 @@
+/*----------------------------------------------------------------------*/
+/* profile.c --								*/
+/*									*/
+/* Run time and memory profiling shared by the qflow tools.  If the	*/
+/* environment variable QFLOW_PROFILE names a file, then each tool	*/
+/* appends one line to that file for every profiled phase, and one	*/
+/* line for the whole run of the tool.  Each line has the tab-		*/
+/* separated fields:							*/
+/*									*/
+/*	<run> <stack> <wall seconds> <CPU seconds> <peak RSS in KB>	*/
+/*									*/
+/* where <stack> is the list of enclosing names separated by ";",	*/
+/* starting with the value of QFLOW_PROFILE_STAGE (if set) and the	*/
+/* tool name, and <run> is the value of QFLOW_PROFILE_RUN (or 0).	*/
+/* Peak RSS is the maximum resident size of the process up to the end	*/
+/* of the phase.  If QFLOW_PROFILE is not set, all calls do nothing.	*/
+/*----------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+
+#include "profile.h"
+
+static FILE *ProfileFile = NULL;
+static char *ProfileRun;
+
+/* Stack of open phases.  Level 0 is the whole run of the tool. */
+
+static struct {
+    char *stack;
+    double wall;
+    double cpu;
+} Phases[PROFILE_MAXDEPTH + 1];
+
+static int ProfileDepth = -1;
+static int ProfileOverflow = 0;	/* Phases begun beyond maximum depth */
+
+/*----------------------------------------------------------------------*/
+/* Get the wall clock time and the CPU time used, in seconds.		*/
+/*----------------------------------------------------------------------*/
+
+static void profile_times(double *wall, double *cpu, long *maxrss)
+{
+    struct timespec ts;
+    struct rusage ru;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    *wall = (double)ts.tv_sec + (double)ts.tv_nsec * 1.0e-9;
+
+    getrusage(RUSAGE_SELF, &ru);
+    *cpu = (double)ru.ru_utime.tv_sec + (double)ru.ru_utime.tv_usec * 1.0e-6
+		+ (double)ru.ru_stime.tv_sec + (double)ru.ru_stime.tv_usec * 1.0e-6;
+    if (maxrss) *maxrss = ru.ru_maxrss;
+}
+
+/*----------------------------------------------------------------------*/
+/* Return the peak resident set size of the process so far, in KB.	*/
+/* Unlike the routines below, this works whether or not QFLOW_PROFILE	*/
+/* is set, so that a tool can report its own memory use.		*/
+/*----------------------------------------------------------------------*/
+
+long ProfilePeakMemory(void)
+{
+    struct rusage ru;
+
+    getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_maxrss;
+}
+
+/*----------------------------------------------------------------------*/
+/* Close all open phases, including the whole run.  Called on exit.	*/
+/*----------------------------------------------------------------------*/
+
+static void profile_exit(void)
+{
+    while (ProfileDepth >= 0) ProfileEnd();
+    fclose(ProfileFile);
+    ProfileFile = NULL;
+}
+
+/*----------------------------------------------------------------------*/
+/* Start profiling the tool "progname" (normally argv[0]) if the	*/
+/* environment variable QFLOW_PROFILE is set.  Opens the level 0 phase	*/
+/* for the whole run, which is closed when the program exits.		*/
+/*----------------------------------------------------------------------*/
+
+void ProfileInit(char *progname)
+{
+    char *filename, *stage, *sptr;
+
+    filename = getenv("QFLOW_PROFILE");
+    if ((filename == NULL) || (*filename == '\0')) return;
+
+    ProfileFile = fopen(filename, "a");
+    if (ProfileFile == NULL) {
+	fprintf(stderr, "Cannot open profile file %s for writing.\n", filename);
+	return;
+    }
+
+    ProfileRun = getenv("QFLOW_PROFILE_RUN");
+    if (ProfileRun == NULL) ProfileRun = "0";
+
+    sptr = strrchr(progname, '/');
+    if (sptr != NULL) progname = sptr + 1;
+
+    stage = getenv("QFLOW_PROFILE_STAGE");
+    if ((stage != NULL) && (*stage != '\0')) {
+	Phases[0].stack = (char *)malloc(strlen(stage) + strlen(progname) + 2);
+	sprintf(Phases[0].stack, "%s;%s", stage, progname);
+    }
+    else
+	Phases[0].stack = strdup(progname);
+
+    ProfileDepth = 0;
+    profile_times(&Phases[0].wall, &Phases[0].cpu, NULL);
+    atexit(profile_exit);
+}
+
+/*----------------------------------------------------------------------*/
+/* Begin a named phase, nested inside any phase that is still open.	*/
+/*----------------------------------------------------------------------*/
+
+void ProfileBegin(char *phase)
+{
+    char *parent;
+
+    if (ProfileFile == NULL) return;
+    if (ProfileDepth == PROFILE_MAXDEPTH) {
+	ProfileOverflow++;
+	return;
+    }
+
+    parent = Phases[ProfileDepth].stack;
+    ProfileDepth++;
+    Phases[ProfileDepth].stack = (char *)malloc(strlen(parent) + strlen(phase) + 2);
+    sprintf(Phases[ProfileDepth].stack, "%s;%s", parent, phase);
+    profile_times(&Phases[ProfileDepth].wall, &Phases[ProfileDepth].cpu, NULL);
+}
+
+/*----------------------------------------------------------------------*/
+/* End the most recently begun phase and write its record.		*/
+/*----------------------------------------------------------------------*/
+
+void ProfileEnd(void)
+{
+    double wall, cpu;
+    long maxrss;
+
+    if (ProfileFile == NULL) return;
+    if (ProfileDepth < 0) return;
+    if (ProfileOverflow > 0) {
+	ProfileOverflow--;
+	return;
+    }
+
+    profile_times(&wall, &cpu, &maxrss);
+    fprintf(ProfileFile, "%s\t%s\t%.6f\t%.6f\t%ld\n", ProfileRun,
+		Phases[ProfileDepth].stack, wall - Phases[ProfileDepth].wall,
+		cpu - Phases[ProfileDepth].cpu, maxrss);
+    free(Phases[ProfileDepth].stack);
+    ProfileDepth--;
+}
@@ -0,0 +1,19 @@
+/*
+ * profile.h --
+ *
+ * Run time and memory profiling of named phases of the qflow tools.
+ *
+ */
+
+#ifndef _PROFILE_H
+#define _PROFILE_H
+
+/* Maximum nesting depth of profiled phases */
+#define PROFILE_MAXDEPTH	8
+
+extern void ProfileInit(char *progname);
+extern void ProfileBegin(char *phase);
+extern void ProfileEnd(void);
+extern long ProfilePeakMemory(void);
+
+#endif /* _PROFILE_H */
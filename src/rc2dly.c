@@ -45,6 +45,7 @@
 #include "hash.h"
 #include "readliberty.h"	/* liberty file database */
 #include "readverilog.h"	/* verilog netlist reader */
+#include "profile.h"		/* run time profiling */
 
 #define SRC     0x01    // node is a driver
 #define SNK     0x02    // node is a receiver
@@ -529,6 +530,8 @@ int main (int argc, char* argv[]) {
     // Command-line argument parsing
     int c;
 
+    ProfileInit(argv[0]);
+
     while (1) {
         static struct option long_options[] = {
             {"rc-file"      , required_argument , 0, 'r'},
@@ -580,7 +583,9 @@ int main (int argc, char* argv[]) {
                 break;
 
 	    case 'V':
+		ProfileBegin("parse Verilog");
 		topcell = ReadVerilog(optarg);
+		ProfileEnd();
 		break;
 
             case 'l':
@@ -595,7 +600,9 @@ int main (int argc, char* argv[]) {
 		else {
 		    // Read in Liberty file
 		    printf("Reading Liberty timing file %s\n", libfilename);
+		    ProfileBegin("parse Liberty");
 		    libcells = read_liberty(libfilename, 0);
+		    ProfileEnd();
 		    fclose(libfile);
 		    if (cells == NULL)
 			cells = libcells;
@@ -688,6 +695,7 @@ int main (int argc, char* argv[]) {
     int num_toks = 0;
     struct instance *inst;
 
+    ProfileBegin("write header");
     InitializeHashTable(&LibHash, SMALLHASHSIZE);
     InitializeHashTable(&InstHash, LARGEHASHSIZE);
 
@@ -728,7 +736,7 @@ int main (int argc, char* argv[]) {
 	fprintf(outfile, "*DELIMITER %c\n", delimiter);
 	fprintf(outfile, "*BUS_DELIMITER %s\n", "<>");
 	fprintf(outfile, "*T_UNIT 1 PS\n");
-	fprintf(outfile, "*C_UNIT 1 FF\n");
+	fprintf(outfile, "*C_UNIT 1 PF\n");
 	fprintf(outfile, "*R_UNIT 1 OHM\n");
 	fprintf(outfile, "*L_UNIT 1 HENRY\n");
 	fprintf(outfile, "\n");
@@ -838,7 +846,9 @@ int main (int argc, char* argv[]) {
 	fprintf(outfile, "      (DELAY\n");
 	fprintf(outfile, "         (ABSOLUTE\n");
     }
+    ProfileEnd();
 
+    ProfileBegin("compute delays");
     bytesRead = getline(&line, &nbytes, rcfile);
 
     // <net> <num_net_drivers> <driver_node_0> [drive_node_n] <num_receivers> (R1 C1
@@ -1231,6 +1241,8 @@ int main (int argc, char* argv[]) {
     }
 
     fclose(outfile);
+    ProfileEnd();
+
     // Cleanup
 
     free(delays);
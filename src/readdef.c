@@ -51,6 +51,19 @@ NET *Nlnets = NULL;
 GATE Nlgates = NULL;
 GATE PinMacro;
 
+/* Set DefCopyGeometry to TRUE before calling DefRead() to give each	*/
+/* component instance its own copy of the cell macro tap and		*/
+/* obstruction geometry, and to find the routing grid points of each	*/
+/* net node.  Tools that only need the netlist and placement leave it	*/
+/* FALSE, and can call DefGateGeometry() for any instance that needs	*/
+/* its geometry.							*/
+
+u_char DefCopyGeometry = FALSE;
+
+/* Case-insensitive lookup of cell macros for the COMPONENTS section */
+
+static struct hashtable DefMacroTable;
+
 /*--------------------------------------------------------------*/
 /* Cell macro lookup based on the hash table			*/
 /*--------------------------------------------------------------*/
@@ -65,6 +78,63 @@ DefHashInit(void)
    InitializeHashTable(&RowTable, TINYHASHSIZE);
 }
 
+/*--------------------------------------------------------------*/
+/* Grow a hash table to suit the number of entries declared at	*/
+/* the top of a DEF section, so that hash chains stay short on	*/
+/* large designs.  Entries already in the table are moved to	*/
+/* the new bins.						*/
+/*--------------------------------------------------------------*/
+
+static void
+DefHashSize(struct hashtable *table, int total)
+{
+    struct hashlist **oldtab, *p, *pnext;
+    int oldsize, i;
+    unsigned long hashval;
+
+    if (total <= table->hashsize) return;
+
+    oldtab = table->hashtab;
+    oldsize = table->hashsize;
+    InitializeHashTable(table, total | 1);
+
+    for (i = 0; i < oldsize; i++) {
+	for (p = oldtab[i]; p != NULL; p = pnext) {
+	    pnext = p->next;
+	    hashval = (*hashfunc)(p->name, table->hashsize);
+	    p->next = table->hashtab[hashval];
+	    table->hashtab[hashval] = p;
+	}
+    }
+    free(oldtab);
+}
+
+/*--------------------------------------------------------------*/
+/* Hash the cell macros by name, so that components can find	*/
+/* their macro without a case-insensitive search through the	*/
+/* whole GateInfo list.						*/
+/*--------------------------------------------------------------*/
+
+static void
+DefHashMacros(void)
+{
+    GATE gateginfo;
+
+    if (DefMacroTable.hashtab != NULL) HashKill(&DefMacroTable);
+    InitializeHashTable(&DefMacroTable, SMALLHASHSIZE);
+
+    for (gateginfo = GateInfo; gateginfo; gateginfo = gateginfo->next)
+	HashNoCasePtrInstall(gateginfo->gatename, gateginfo, &DefMacroTable);
+}
+
+/*--------------------------------------------------------------*/
+
+static GATE
+DefFindMacro(char *name)
+{
+    return (GATE)HashNoCaseLookup(name, &DefMacroTable);
+}
+
 GATE
 DefFindGate(char *name)
 {
@@ -147,6 +217,49 @@ DefDesign()
     return DEFDesignName;
 }
 
+/*--------------------------------------------------------------*/
+/* Record of the file position of each top-level section (from	*/
+/* COMPONENTS onward, including the final END DESIGN) in the	*/
+/* order found in the DEF file most recently read.		*/
+/*--------------------------------------------------------------*/
+
+static struct {
+    char *name;		/* section keyword (entry in sections[]) */
+    long offset;	/* position of start of line with keyword */
+} *DefSections = NULL;
+static int NumDefSections = 0;
+static int MaxDefSections = 0;
+
+static void
+DefRecordSection(char *name, long offset)
+{
+    if (NumDefSections == MaxDefSections) {
+	MaxDefSections = (MaxDefSections == 0) ? 16 : MaxDefSections * 2;
+	DefSections = realloc(DefSections, MaxDefSections * sizeof(*DefSections));
+    }
+    DefSections[NumDefSections].name = name;
+    DefSections[NumDefSections].offset = offset;
+    NumDefSections++;
+}
+
+/*--------------------------------------------------------------*/
+/* Return the position in the DEF file of the start of the line	*/
+/* beginning the first section "name" (e.g., "NETS", or "END"	*/
+/* for END DESIGN) found at or after position "after", or -1 if	*/
+/* there is no such section.					*/
+/*--------------------------------------------------------------*/
+
+long
+DefSectionOffset(char *name, long after)
+{
+    int i;
+
+    for (i = 0; i < NumDefSections; i++)
+	if ((DefSections[i].offset >= after) && !strcmp(DefSections[i].name, name))
+	    return DefSections[i].offset;
+    return -1;
+}
+
 /*--------------------------------------------------------------*/
 /* Net hash table generation					*/
 /* Given a net record, create an entry in the hash table for	*/
@@ -160,6 +273,25 @@ DefHashNet(NET net)
     HashPtrInstall(net->netname, net, &NetTable);
 }
 
+/*--------------------------------------------------------------*/
+/* Read a number from "token" into "value", as sscanf() with	*/
+/* format "%lg" would, but without the cost of sscanf() on the	*/
+/* route points of every net.  Returns 1 on success, 0 if the	*/
+/* token is not a number (and "value" is not changed).		*/
+/*--------------------------------------------------------------*/
+
+static int
+DefReadNumber(char *token, double *value)
+{
+    char *eptr;
+    double v;
+
+    v = strtod(token, &eptr);
+    if (eptr == token) return 0;
+    *value = v;
+    return 1;
+}
+
 /*
  *------------------------------------------------------------
  *
@@ -225,7 +357,7 @@ DefAddRoutes(FILE *f, float oscale, NET net, char special)
 	    {
 		/* SPECIALNETS has the additional width */
 		token = LefNextToken(f, TRUE);
-		if (sscanf(token, "%lg", &w) != 1)
+		if (DefReadNumber(token, &w) != 1)
 		{
 		    LefError(DEF_ERROR, "Bad width in special net\n");
 		    continue;
@@ -333,7 +465,7 @@ DefAddRoutes(FILE *f, float oscale, NET net, char special)
 		    goto endCoord;
 		}
 	    }
-	    else if (sscanf(token, "%lg", &x) == 1)
+	    else if (DefReadNumber(token, &x) == 1)
 	    {
 		x /= oscale;		// In microns
 		/* Note: offsets and stubs are always less than half a pitch,	*/
@@ -354,7 +486,7 @@ DefAddRoutes(FILE *f, float oscale, NET net, char special)
 		    goto endCoord;
 		}
 	    }
-	    else if (sscanf(token, "%lg", &y) == 1)
+	    else if (DefReadNumber(token, &y) == 1)
 	    {
 		y /= oscale;		// In microns
 		refp.y1 = (int)(0.5 + ((y - Ylowerbound) / PitchY));
@@ -475,7 +607,11 @@ DefReadGatePin(NET net, NODE node, char *instname, char *pinname)
 		node->taps = (DPOINT)NULL;
 		node->extend = (DPOINT)NULL;
 
-		for (drect = g->taps[i]; drect; drect = drect->next) {
+		// Instances read without DefCopyGeometry have no taps,
+		// and no routing gridpoints are recorded for them.
+
+		for (drect = (g->taps) ? g->taps[i] : (DSEG)NULL; drect;
+			    drect = drect->next) {
 
 		    // Add all routing gridpoints that fall inside
 		    // the rectangle.  Much to do here:
@@ -617,6 +753,7 @@ DefReadNets(FILE *f, char *sname, float oscale, char special, int total)
 	Nlnets = (NET *)realloc(Nlnets, (Numnets + total) * sizeof(NET));
 	for (i = Numnets; i < (Numnets + total); i++) Nlnets[i] = NULL;
     }
+    DefHashSize(&NetTable, Numnets + total);
 
     while ((token = LefNextToken(f, TRUE)) != NULL)
     {
@@ -828,12 +965,12 @@ DefReadLocation(gate, f, oscale)
     float oscale;
 {
     int keyword;
-    char *token;
+    char *token, *eptr;
     float x, y;
     char mxflag, myflag;
 
     static char *orientations[] = {
-	"N", "S", "E", "W", "FN", "FS", "FE", "FW"
+	"N", "S", "E", "W", "FN", "FS", "FE", "FW", NULL
     };
     static int oflags[] = {
 	RN, RS, RE, RW, RN | RF, RS | RF, RE | RF, RW | RF
@@ -842,9 +979,11 @@ DefReadLocation(gate, f, oscale)
     token = LefNextToken(f, TRUE);
     if (*token != '(') goto parse_error;
     token = LefNextToken(f, TRUE);
-    if (sscanf(token, "%f", &x) != 1) goto parse_error;
+    x = strtof(token, &eptr);
+    if (eptr == token) goto parse_error;
     token = LefNextToken(f, TRUE);
-    if (sscanf(token, "%f", &y) != 1) goto parse_error;
+    y = strtof(token, &eptr);
+    if (eptr == token) goto parse_error;
     token = LefNextToken(f, TRUE);
     if (*token != ')') goto parse_error;
     token = LefNextToken(f, TRUE);
@@ -1394,6 +1533,119 @@ DefReadBlockages(FILE *f, char *sname, float oscale, int total)
 		"the number declared (%d).\n", processed, total);
 }
 
+/*
+ *------------------------------------------------------------
+ *
+ * DefTransformRect --
+ *
+ *	Make a copy of rectangle "drect" from the cell macro of
+ *	instance "gate", moved to the instance position and
+ *	orientation.
+ *
+ * Results:
+ *	The new rectangle.
+ *
+ * Side Effects:
+ *	Memory is allocated for the rectangle.
+ *
+ *------------------------------------------------------------
+ */
+
+static DSEG
+DefTransformRect(GATE gate, DSEG drect)
+{
+    GATE gateginfo = gate->gatetype;
+    DSEG newrect;
+    double tmp;
+
+    newrect = (DSEG)malloc(sizeof(struct dseg_));
+    *newrect = *drect;
+
+    // handle offset from gate origin
+    newrect->x1 -= gateginfo->placedX;
+    newrect->x2 -= gateginfo->placedX;
+    newrect->y1 -= gateginfo->placedY;
+    newrect->y2 -= gateginfo->placedY;
+
+    // handle rotations and orientations here
+    if (gate->orient & MX) {
+	tmp = newrect->x1;
+	newrect->x1 = -newrect->x2;
+	newrect->x1 += gate->placedX + gateginfo->width;
+	newrect->x2 = -tmp;
+	newrect->x2 += gate->placedX + gateginfo->width;
+    }
+    else {
+	newrect->x1 += gate->placedX;
+	newrect->x2 += gate->placedX;
+    }
+    if (gate->orient & MY) {
+	tmp = newrect->y1;
+	newrect->y1 = -newrect->y2;
+	newrect->y1 += gate->placedY + gateginfo->height;
+	newrect->y2 = -tmp;
+	newrect->y2 += gate->placedY + gateginfo->height;
+    }
+    else {
+	newrect->y1 += gate->placedY;
+	newrect->y2 += gate->placedY;
+    }
+    return newrect;
+}
+
+/*
+ *------------------------------------------------------------
+ *
+ * DefGateGeometry --
+ *
+ *	Make the tap and obstruction geometry of a gate
+ *	instance from the geometry of its cell macro, adjusted
+ *	for the instance position and orientation.  Unless
+ *	DefCopyGeometry is set before reading the DEF file,
+ *	instances are created without geometry, and this
+ *	routine must be called before using the instance
+ *	"taps" or "obs" records.  It does nothing if the
+ *	geometry has already been made.
+ *
+ * Results:
+ *	None.
+ *
+ * Side Effects:
+ *	The "taps" and "obs" records of the instance are
+ *	allocated and filled.
+ *
+ *------------------------------------------------------------
+ */
+
+void
+DefGateGeometry(GATE gate)
+{
+    GATE gateginfo;
+    DSEG drect, newrect;
+    int i;
+
+    if (gate == NULL) return;
+    gateginfo = gate->gatetype;
+    if ((gateginfo == NULL) || (gate->taps != NULL)) return;
+
+    gate->taps = (DSEG *)malloc(gate->nodes * sizeof(DSEG));
+    for (i = 0; i < gate->nodes; i++) {
+	gate->taps[i] = (DSEG)NULL;
+	for (drect = gateginfo->taps[i]; drect; drect = drect->next) {
+	    newrect = DefTransformRect(gate, drect);
+	    newrect->next = gate->taps[i];
+	    gate->taps[i] = newrect;
+	}
+    }
+
+    gate->obs = (DSEG)NULL;
+    for (drect = gateginfo->obs; drect; drect = drect->next) {
+	newrect = DefTransformRect(gate, drect);
+	newrect->next = gate->obs;
+	gate->obs = newrect;
+    }
+}
+
 /*
  *------------------------------------------------------------
  *
@@ -1403,9 +1655,13 @@ DefReadBlockages(FILE *f, char *sname, float oscale, int total)
  *	instance hash table.  The instance is assumed to
  *	have records gatename, gatetype, placedX, and
  *	placedY already set.  The gate macro is found from
- *	the gatetype record, and all information about the
- *	cell macro is copied to the instance record, with
- *	positions adjusted for the instance.
+ *	the gatetype record.  The pin names, directions,
+ *	uses, and areas of the instance point to those of
+ *	the cell macro;  only the net connections are
+ *	allocated per instance.  Tap and obstruction
+ *	geometry is copied from the macro and adjusted for
+ *	the instance position only if DefCopyGeometry is
+ *	set;  otherwise see DefGateGeometry().
  *
  * Results:
  *	None.
@@ -1422,8 +1678,6 @@ DefAddGateInstance(GATE gate)
 {
     GATE gateginfo;
     int i;
-    DSEG drect, newrect;
-    double tmp;
 
     if (gate == NULL) return;
     gateginfo = gate->gatetype;
@@ -1434,111 +1688,29 @@ DefAddGateInstance(GATE gate)
     gate->height = gateginfo->height;   
     gate->nodes = gateginfo->nodes;   
     gate->nomirror = gateginfo->nomirror;   
+    gate->bus = gateginfo->bus;
+    gate->taps = (DSEG *)NULL;
     gate->obs = (DSEG)NULL;
 
-    gate->taps = (DSEG *)malloc(gate->nodes * sizeof(DSEG));
-    gate->noderec = (NODE *)malloc(gate->nodes * sizeof(NODE));
-    gate->direction = (u_char *)malloc(gate->nodes * sizeof(u_char));
-    gate->area = (float *)malloc(gate->nodes * sizeof(float));
-    gate->netnum = (int *)malloc(gate->nodes * sizeof(int));
-    gate->node = (char **)malloc(gate->nodes * sizeof(char *));
-
     /* Let the node names point to the master cell; */
     /* this is just diagnostic;  allows us, for	    */
     /* instance, to identify vdd and gnd nodes, so  */
     /* we don't complain about them being	    */
-    /* disconnected.				    */
-
-    for (i = 0; i < gate->nodes; i++) {
-	gate->node[i] = gateginfo->node[i];  /* copy pointer */
-	gate->direction[i] = gateginfo->direction[i];  /* copy */
-	gate->area[i] = gateginfo->area[i];
-	gate->taps[i] = (DSEG)NULL;
-	gate->netnum[i] = 0;		/* Until we read NETS */
-	gate->noderec[i] = NULL;
-
-	/* Make a copy of the gate nodes and adjust for	*/
-	/* instance position and number of layers	*/
+    /* disconnected.  Pin information that does not */
+    /* change between instances is shared with the  */
+    /* master cell in the same way.		    */
 
-	for (drect = gateginfo->taps[i]; drect; drect = drect->next) {
-	    newrect = (DSEG)malloc(sizeof(struct dseg_));
-	    *newrect = *drect;
-	    newrect->next = gate->taps[i];
-	    gate->taps[i] = newrect;
-	}
+    gate->node = gateginfo->node;
+    gate->direction = gateginfo->direction;
+    gate->use = gateginfo->use;
+    gate->area = gateginfo->area;
 
-	for (drect = gate->taps[i]; drect; drect = drect->next) {
-	    // handle offset from gate origin
-	    drect->x1 -= gateginfo->placedX;
-	    drect->x2 -= gateginfo->placedX;
-	    drect->y1 -= gateginfo->placedY;
-	    drect->y2 -= gateginfo->placedY;
-
-	    // handle rotations and orientations here
-	    if (gate->orient & MX) {
-		tmp = drect->x1;
-		drect->x1 = -drect->x2;
-		drect->x1 += gate->placedX + gateginfo->width;
-		drect->x2 = -tmp;
-		drect->x2 += gate->placedX + gateginfo->width;
-	    }
-	    else {
-		drect->x1 += gate->placedX;
-		drect->x2 += gate->placedX;
-	    }
-	    if (gate->orient & MY) {
-		tmp = drect->y1;
-		drect->y1 = -drect->y2;
-		drect->y1 += gate->placedY + gateginfo->height;
-		drect->y2 = -tmp;
-		drect->y2 += gate->placedY + gateginfo->height;
-	    }
-	    else {
-		drect->y1 += gate->placedY;
-		drect->y2 += gate->placedY;
-	    }
-	}
-    }
+    /* Net connections are set when reading NETS */
+    gate->noderec = (NODE *)calloc(gate->nodes, sizeof(NODE));
+    gate->netnum = (int *)calloc(gate->nodes, sizeof(int));
 
-    /* Make a copy of the gate obstructions and adjust	*/
-    /* for instance position				*/
-    for (drect = gateginfo->obs; drect; drect = drect->next) {
-	newrect = (DSEG)malloc(sizeof(struct dseg_));
-	*newrect = *drect;
-	newrect->next = gate->obs;
-	gate->obs = newrect;
-    }
+    if (DefCopyGeometry) DefGateGeometry(gate);
 
-    for (drect = gate->obs; drect; drect = drect->next) {
-	drect->x1 -= gateginfo->placedX;
-	drect->x2 -= gateginfo->placedX;
-	drect->y1 -= gateginfo->placedY;
-	drect->y2 -= gateginfo->placedY;
-
-	// handle rotations and orientations here
-	if (gate->orient & MX) {
-	    tmp = drect->x1;
-	    drect->x1 = -drect->x2;
-	    drect->x1 += gate->placedX + gateginfo->width;
-	    drect->x2 = -tmp;
-	    drect->x2 += gate->placedX + gateginfo->width;
-	}
-	else {
-	    drect->x1 += gate->placedX;
-	    drect->x2 += gate->placedX;
-	}
-	if (gate->orient & MY) {
-	    tmp = drect->y1;
-	    drect->y1 = -drect->y2;
-	    drect->y1 += gate->placedY + gateginfo->height;
-	    drect->y2 = -tmp;
-	    drect->y2 += gate->placedY + gateginfo->height;
-	}
-	else {
-	    drect->y1 += gate->placedY;
-	    drect->y2 += gate->placedY;
-	}
-    }
     gate->next = Nlgates;
     gate->last = (GATE)NULL;
     if (Nlgates) Nlgates->last = gate;
@@ -1583,7 +1755,6 @@ DefReadComponents(FILE *f, char *sname, float oscale, int total)
     char usename[512];
     int keyword, subkey, i;
     int processed = 0;
-    char OK;
     int err_fatal = 0;
 
     static char *component_keys[] = {
@@ -1607,6 +1778,9 @@ DefReadComponents(FILE *f, char *sname, float oscale, int total)
 	NULL
     };
 
+    DefHashSize(&InstanceTable, Numgates + total);
+    DefHashMacros();
+
     while ((token = LefNextToken(f, TRUE)) != NULL)
     {
 	keyword = Lookup(token, component_keys);
@@ -1654,14 +1828,8 @@ DefReadComponents(FILE *f, char *sname, float oscale, int total)
 		}
 
 		/* Find the corresponding macro */
-		OK = 0;
-		for (gateginfo = GateInfo; gateginfo; gateginfo = gateginfo->next) {
-		    if (!strcasecmp(gateginfo->gatename, token)) {
-			OK = 1;
-			break;
-		    }
-		}
-		if (!OK) {
+		gateginfo = DefFindMacro(token);
+		if (gateginfo == NULL) {
 		    LefError(DEF_ERROR, "Could not find a macro definition for \"%s\"\n",
 				token);
 		    gate = NULL;
@@ -1792,7 +1960,7 @@ DefRead(char *inName, float *retscale)
     ROW newrow;
 
     static char *orientations[] = {
-	"N", "S", "E", "W", "FN", "FS", "FE", "FW"
+	"N", "S", "E", "W", "FN", "FS", "FE", "FW", NULL
     };
     static int oflags[] = {
 	RN, RS, RE, RW, RN | RF, RS | RF, RE | RF, RW | RF
@@ -1844,6 +2012,7 @@ DefRead(char *inName, float *retscale)
 	*retscale = (float)0.0;
 	return 1;
     }
+    LefResetInput(f);
 
     /* Initialize */
 
@@ -1856,6 +2025,7 @@ DefRead(char *inName, float *retscale)
     lefCurrentLine = 0;
 
     DefHashInit();
+    NumDefSections = 0;
 
     /* Read file contents */
 
@@ -1870,6 +2040,8 @@ DefRead(char *inName, float *retscale)
 	    continue;
 	}
 	if (keyword != DEF_TRACKS) corient = '.';
+	if (keyword >= DEF_COMPONENTS)
+	    DefRecordSection(sections[keyword], LefLineOffset());
 
 	switch (keyword)
 	{
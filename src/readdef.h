@@ -16,16 +16,24 @@ extern int Numnets;
 extern int Numgates;
 extern int Numpins;
 extern int numSpecial;
+extern u_char DefCopyGeometry;
+extern char *DEFDesignName;
+extern DSEG UserObs;
+extern double Xlowerbound, Xupperbound, Ylowerbound, Yupperbound;
+extern double PitchX, PitchY;
 
 extern GATE  DefFindGate(char *name);
 extern NET   DefFindNet(char *name);
 extern ROW   DefFindRow(int yval);
 extern ROW   DefLowestRow();
 extern void  DefAddGateInstance(GATE gate);
+extern void  DefGateGeometry(GATE gate);
 extern char *DefDesign();
+extern long  DefSectionOffset(char *name, long after);
 
 /* External access to hash tables for recursion functions */
 extern struct hashtable InstanceTable;
 extern struct hashtable NetTable;
+extern struct hashtable RowTable;
 
 #endif /* _DEFINT_H */
@@ -73,6 +73,140 @@ LefHashMacro(GATE gateginfo)
     HashPtrInstall(gateginfo->gatename, gateginfo, &MacroTable);
 }
 
+/*---------------------------------------------------------
+ * Keyword index --
+ *	Lookup() and LookupFull() are called on nearly every
+ *	token read from a LEF or DEF file.  Rather than scan
+ *	the keyword table with case-insensitive compares each
+ *	time, a perfect hash index is made for each table the
+ *	first time the table is seen.  The index is keyed on
+ *	the significant part of each entry (up to the first
+ *	blank) and its length, and the hash seed is chosen so
+ *	that no two entries share a slot.  An exact match then
+ *	costs one hash of the token and one compare;  only
+ *	abbreviations and non-keywords fall back to the scan.
+ *
+ *	The index is found by the address of the table, so
+ *	keyword tables passed to Lookup() and LookupFull()
+ *	must be static, not built on the stack.
+ *---------------------------------------------------------
+ */
+
+#define KEYINDEX_HASHSIZE 61	/* bins for finding a table's index */
+#define KEYINDEX_MAXSEED  64	/* seeds to try before growing the index */
+
+typedef struct _lefKeyIndex *LefKeyIndex;
+
+typedef struct _lefKeyIndex {
+    LefKeyIndex next;	/* next index in the same bin */
+    char **table;	/* keyword table being indexed */
+    u_int seed;		/* hash seed giving no collisions */
+    u_int mask;		/* number of slots, minus one */
+    short *slot;	/* table position for each slot, or -1 */
+    int *keylen;	/* significant length of each table entry */
+    u_char spaced;	/* TRUE if any entry has text after a blank */
+} lefKeyIndex;
+
+static LefKeyIndex KeyIndexTable[KEYINDEX_HASHSIZE];
+
+/*---------------------------------------------------------*/
+/* Case-insensitive hash of the first "len" characters of  */
+/* string "s".						   */
+/*---------------------------------------------------------*/
+
+static u_int
+lefKeyHash(char *s, int len, u_int seed)
+{
+    u_int hashval = seed ^ (u_int)len;
+    int i;
+
+    for (i = 0; i < len; i++)
+	hashval = (hashval ^ (u_char)toupper(s[i])) * 16777619;
+    return (hashval ^ (hashval >> 15));
+}
+
+/*---------------------------------------------------------*/
+/* Find the index for a keyword table, creating it if this */
+/* is the first time the table has been used.		   */
+/*---------------------------------------------------------*/
+
+static LefKeyIndex
+lefKeyIndexFind(char **table)
+{
+    LefKeyIndex kidx;
+    short *slot;
+    u_int bin, size, seed, h;
+    int n, i, len;
+
+    bin = (u_int)(((unsigned long)table >> 3) % KEYINDEX_HASHSIZE);
+    for (kidx = KeyIndexTable[bin]; kidx; kidx = kidx->next)
+	if (kidx->table == table)
+	    return kidx;
+
+    for (n = 0; table[n] != NULL; n++);
+
+    kidx = (LefKeyIndex)malloc(sizeof(lefKeyIndex));
+    kidx->table = table;
+    kidx->spaced = FALSE;
+    kidx->keylen = (int *)malloc((n + 1) * sizeof(int));
+    for (i = 0; i < n; i++) {
+	for (len = 0; (table[i][len] != '\0') && (table[i][len] != ' '); len++);
+	kidx->keylen[i] = len;
+	if (table[i][len] == ' ') kidx->spaced = TRUE;
+    }
+
+    /* Search for a seed that places every distinct key in its own	*/
+    /* slot.  Duplicate keys keep the first entry, which is the one	*/
+    /* that the table scan in Lookup() would return.			*/
+
+    for (size = 4; size < (u_int)(2 * n); size <<= 1);
+    slot = (short *)malloc(size * sizeof(short));
+    for (seed = 1; ; seed++) {
+	if (seed > KEYINDEX_MAXSEED) {
+	    size <<= 1;
+	    slot = (short *)realloc(slot, size * sizeof(short));
+	    seed = 1;
+	}
+	for (h = 0; h < size; h++) slot[h] = -1;
+	for (i = 0; i < n; i++) {
+	    h = lefKeyHash(table[i], kidx->keylen[i], seed) & (size - 1);
+	    if (slot[h] < 0)
+		slot[h] = i;
+	    else if ((kidx->keylen[slot[h]] != kidx->keylen[i]) ||
+			strncasecmp(table[slot[h]], table[i], kidx->keylen[i]))
+		break;
+	}
+	if (i == n) break;
+    }
+    kidx->slot = slot;
+    kidx->seed = seed;
+    kidx->mask = size - 1;
+
+    kidx->next = KeyIndexTable[bin];
+    KeyIndexTable[bin] = kidx;
+    return kidx;
+}
+
+/*---------------------------------------------------------*/
+/* Return the position of the table entry exactly matching */
+/* "str" (ignoring case), or -1 if there is none.  If	   */
+/* "full" is TRUE, then the entry must not have any text   */
+/* following a blank.  "kidx" is the index of the table.   */
+/*---------------------------------------------------------*/
+
+static int
+lefKeyIndexMatch(LefKeyIndex kidx, char *str, u_char full)
+{
+    int pos, len;
+
+    len = strlen(str);
+    pos = kidx->slot[lefKeyHash(str, len, kidx->seed) & kidx->mask];
+    if ((pos < 0) || (kidx->keylen[pos] != len)) return -1;
+    if (strncasecmp(kidx->table[pos], str, len)) return -1;
+    if (full && (kidx->table[pos][len] != '\0')) return -1;
+    return pos;
+}
+
 /*---------------------------------------------------------
  * Lookup --
  *	Searches a table of strings to find one that matches a given
@@ -93,10 +227,11 @@ LefHashMacro(GATE gateginfo)
  * NOTE:  
  *      Table entries need no longer be in alphabetical order
  *      and they need not be lower case.  The irouter command parsing
- *      depends on these features.
+ *      depends on these features.  The table must be static (see
+ *	"Keyword index", above).
  *
  * Side Effects:
- *	None.
+ *	Creates the keyword index for the table on first use.
  *---------------------------------------------------------
  */
 
@@ -113,6 +248,10 @@ Lookup(str, table)
     int pos;
     int ststart = 0;
 
+    /* An exact match always takes precedence, so check the index first */
+    if ((pos = lefKeyIndexMatch(lefKeyIndexFind(table), str, FALSE)) >= 0)
+	return pos;
+
     /* search for match */
     for (pos=0; table[pos] != NULL; pos++)
     {
@@ -164,13 +303,14 @@ Lookup(str, table)
  * entry in the string table must be a NULL pointer.
  * This is much simpler than Lookup() in that it does not
  * allow abbreviations.  It does, however, ignore case.
+ * As with Lookup(), the table must be static.
  *
  * Results:
  *	Index of the name supplied in the table, or -1 if the name
  *	is not found.
  *
  * Side effects:
- *	None.
+ *	Creates the keyword index for the table on first use.
  *
  * ----------------------------------------------------------------------------
  */
@@ -181,6 +321,13 @@ LookupFull(name, table)
     char **table;
 {
     char **tp;
+    LefKeyIndex kidx;
+    int pos;
+
+    /* Only tables with blanks in an entry need the full scan */
+    kidx = lefKeyIndexFind(table);
+    if (((pos = lefKeyIndexMatch(kidx, name, TRUE)) >= 0) || !kidx->spaced)
+	return pos;
 
     for (tp = table; *tp; tp++)
     {
@@ -201,6 +348,148 @@ LookupFull(name, table)
     return (-1);
 }
 
+/*
+ *------------------------------------------------------------
+ *
+ * Block-buffered input for LefNextToken() --
+ *
+ *	The input file is read in large blocks, and each line
+ *	is terminated in place within the block buffer, so the
+ *	only per-line work is the scan for the end-of-line
+ *	character and tokens are never copied.  The buffer grows
+ *	as needed to hold the longest line of the input, so line
+ *	length is not limited to LEF_LINE_MAX.
+ *
+ *------------------------------------------------------------
+ */
+
+#define LEF_BLOCK_SIZE 262144
+
+static struct {
+    FILE   *f;		/* file that the buffer contents came from */
+    char   *buf;	/* block buffer (one extra byte for a terminator) */
+    size_t  size;	/* allocated size of buf, not counting terminator */
+    size_t  len;	/* number of bytes of input in buf */
+    size_t  line;	/* offset of the current line */
+    size_t  next;	/* offset of the line following the current line */
+    long    base;	/* file position of the start of buf */
+    u_char  eof;	/* TRUE when the file has been read to the end */
+    char   *token;	/* next token in the current line, or NULL */
+} lefInput = {NULL, NULL, 0, 0, 0, 0, 0, FALSE, NULL};
+
+/*------------------------------------------------------------*/
+/* Start reading from file "f" with an empty buffer.  Calling  */
+/* with f = NULL forces the next call to LefNextToken() to     */
+/* discard anything left from a previously read file, which   */
+/* may have been closed and its FILE pointer reused.	       */
+/*------------------------------------------------------------*/
+
+void
+LefResetInput(FILE *f)
+{
+    if (lefInput.buf == NULL) {
+	lefInput.size = LEF_BLOCK_SIZE;
+	lefInput.buf = (char *)malloc(lefInput.size + 1);
+    }
+    lefInput.f = f;
+    lefInput.len = lefInput.line = lefInput.next = 0;
+    lefInput.base = (f == NULL) ? 0 : ftell(f);
+    lefInput.eof = FALSE;
+    lefInput.token = NULL;
+}
+
+/*------------------------------------------------------------*/
+/* Return the position in the input file of the start of the  */
+/* line containing the token most recently returned by	      */
+/* LefNextToken().  Readers use this to record where sections */
+/* begin, so that tools rewriting a file can copy unmodified  */
+/* parts of it verbatim without parsing them again.	      */
+/*------------------------------------------------------------*/
+
+long
+LefLineOffset(void)
+{
+    return lefInput.base + (long)lefInput.line;
+}
+
+/*------------------------------------------------------------*/
+/* Move the current line to the front of the buffer (growing  */
+/* the buffer if the line fills it) and read another block.   */
+/* Returns the number of bytes read, 0 at end-of-file.	      */
+/* Pointers into the buffer are invalidated.		      */
+/*------------------------------------------------------------*/
+
+static size_t
+lefFillInput(void)
+{
+    size_t nread;
+
+    if (lefInput.eof) return 0;
+
+    if (lefInput.line > 0) {
+	memmove(lefInput.buf, lefInput.buf + lefInput.line,
+			lefInput.len - lefInput.line);
+	lefInput.len -= lefInput.line;
+	lefInput.next -= lefInput.line;
+	lefInput.base += (long)lefInput.line;
+	lefInput.line = 0;
+    }
+    if (lefInput.len == lefInput.size) {
+	lefInput.size <<= 1;
+	lefInput.buf = (char *)realloc(lefInput.buf, lefInput.size + 1);
+    }
+
+    nread = fread(lefInput.buf + lefInput.len, 1, lefInput.size - lefInput.len,
+			lefInput.f);
+    if (nread == 0) lefInput.eof = TRUE;
+    lefInput.len += nread;
+    return nread;
+}
+
+/*------------------------------------------------------------*/
+/* Find the end of the line beginning at offset "scan" (or    */
+/* the end of the file), terminate it, and set the offset of  */
+/* the following line.  Returns FALSE if there is no more     */
+/* input at "scan".					      */
+/*------------------------------------------------------------*/
+
+static u_char
+lefEndLine(size_t scan)
+{
+    char *eol;
+    size_t start = scan - lefInput.line;	/* relative to the line */
+
+    while ((eol = memchr(lefInput.buf + scan, '\n', lefInput.len - scan)) == NULL) {
+	scan = lefInput.len - lefInput.line;
+	if (lefFillInput() == 0) {
+	    if (lefInput.line + start == lefInput.len) return FALSE;
+	    eol = lefInput.buf + lefInput.len;	/* last line has no newline */
+	    break;
+	}
+	scan += lefInput.line;
+    }
+    *eol = '\0';
+    lefInput.next = eol - lefInput.buf;
+    if (lefInput.next < lefInput.len) lefInput.next++;
+    lefCurrentLine++;
+    return TRUE;
+}
+
+/*------------------------------------------------------------*/
+/* Advance to the next line of input.  Returns a pointer to   */
+/* the line, or NULL at end-of-file.			      */
+/*------------------------------------------------------------*/
+
+static char *
+lefReadLine(void)
+{
+    lefInput.line = lefInput.next;
+    if (!lefEndLine(lefInput.line)) {
+	lefInput.f = NULL;	/* done with this file */
+	return NULL;
+    }
+    return lefInput.buf + lefInput.line;
+}
 
 /*
  *------------------------------------------------------------
@@ -216,7 +505,7 @@ LookupFull(name, table)
  *	Pointer to next token to parse
  *
  * Side Effects:
- *	May read a new line from the specified file.
+ *	May read a new block of input from the specified file.
  *
  * Warnings:
  *	The return result of LefNextToken will be overwritten by
@@ -229,20 +518,22 @@ LookupFull(name, table)
 char *
 LefNextToken(FILE *f, u_char ignore_eol)
 {
-    static char line[LEF_LINE_MAX + 2];	/* input buffer */
-    static char *nexttoken = NULL;	/* pointer to next token */
-    static char *curtoken;		/* pointer to current token */
     static char eol_token='\n';
+    char *curtoken;		/* pointer to current token */
+    char *nexttoken;		/* pointer to next token */
+    size_t curoff, nextoff;
+
+    if (f != lefInput.f)
+	LefResetInput(f);
 
     /* Read a new line if necessary */
 
+    nexttoken = lefInput.token;
     if (nexttoken == NULL)
     {
 	for(;;)
 	{
-	    if (fgets(line, LEF_LINE_MAX + 1, f) == NULL) return NULL;
-	    lefCurrentLine++;
-	    curtoken = line;
+	    if ((curtoken = lefReadLine()) == NULL) return NULL;
 	    while (isspace(*curtoken) && (*curtoken != '\n') && (*curtoken != '\0'))
 		curtoken++;		/* skip leading whitespace */
 
@@ -252,8 +543,10 @@ LefNextToken(FILE *f, u_char ignore_eol)
 		break;
 	    }
 	}
-	if (!ignore_eol)
+	if (!ignore_eol) {
+	    lefInput.token = nexttoken;
 	    return &eol_token;
+	}
     }
     else
 	curtoken = nexttoken;
@@ -263,12 +556,19 @@ LefNextToken(FILE *f, u_char ignore_eol)
 
     if (*nexttoken == '\"') {
 	nexttoken++;
-	while (((*nexttoken != '\"') || (*(nexttoken - 1) == '\\')) &&
-		(*nexttoken != '\0')) {
-	    if (*nexttoken == '\n') { 	
-		if (fgets(nexttoken + 1, LEF_LINE_MAX -
-				(size_t)(nexttoken - line), f) == NULL)
+	while ((*nexttoken != '\"') || (*(nexttoken - 1) == '\\')) {
+	    if (*nexttoken == '\0') {
+		/* Quoted material continues past the end of the line? */
+		if (nexttoken != lefInput.buf + lefInput.next - 1) break;
+		curoff = curtoken - lefInput.buf - lefInput.line;
+		nextoff = nexttoken - lefInput.buf - lefInput.line;
+		*nexttoken = '\n';
+		if (!lefEndLine(lefInput.next)) {
+		    lefInput.token = NULL;
 		    return NULL;
+		}
+		curtoken = lefInput.buf + lefInput.line + curoff;
+		nexttoken = lefInput.buf + lefInput.line + nextoff;
 	    }
 	    nexttoken++;	/* skip all in quotes (move past current token) */
 	}
@@ -289,6 +589,7 @@ LefNextToken(FILE *f, u_char ignore_eol)
     if ((*nexttoken == '#') || (*nexttoken == '\n') || (*nexttoken == '\0'))
 	nexttoken = NULL;
 
+    lefInput.token = nexttoken;
     return curtoken;
 }
 
@@ -381,11 +682,6 @@ u_char
 LefParseEndStatement(FILE *f, char *match)
 {
     char *token;
-    int keyword;
-    char *match_name[2];
-
-    match_name[0] = match;
-    match_name[1] = NULL;
 
     token = LefNextToken(f, (match == NULL) ? FALSE : TRUE);
     if (token == NULL)
@@ -398,13 +694,10 @@ LefParseEndStatement(FILE *f, char *match)
     if ((*token == '\n') && (match == NULL)) return TRUE;
 
     /* END <section_name> */
-    else {
-	keyword = LookupFull(token, match_name);
-	if (keyword == 0)
-	    return TRUE;
-	else
-	    return FALSE;
-    }
+    else if ((match != NULL) && !strcasecmp(token, match))
+	return TRUE;
+    else
+	return FALSE;
 }
 
 /*
@@ -2212,7 +2505,8 @@ LefReadMacro(f, mname, oscale)
 	"WELLTAP",
 	"TIEHIGH",
 	"TIELOW",
-	"FEEDTHRU"
+	"FEEDTHRU",
+	NULL
     };
 
     static int lef_macro_subclass_to_bitmask[] = {
@@ -3265,6 +3559,7 @@ LefRead(inName)
 	perror(filename);
 	return 0;
     }
+    LefResetInput(f);
 
     if (Verbose > 0) {
 	fprintf(stdout, "Reading LEF data from file %s.\n", filename);
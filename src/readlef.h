@@ -163,6 +163,7 @@ typedef struct _lefLayer {
 extern int lefCurrentLine;
 extern LefList LefInfo;
 extern LinkedStringPtr AllowedVias;
+extern struct hashtable MacroTable;
 
 /* Forward declarations */
 
@@ -173,6 +174,8 @@ void  LefSkipSection(FILE *f, char *match);
 void  LefEndStatement(FILE *f);
 GATE  lefFindCell(char *name);
 char *LefNextToken(FILE *f, u_char ignore_eol);
+void  LefResetInput(FILE *f);
+long  LefLineOffset(void);
 char *LefLower(char *token);
 DSEG  LefReadGeometry(GATE lefMacro, FILE *f, float oscale);
 LefList LefRedefined(LefList lefl, char *redefname);
@@ -13,15 +13,27 @@
 #include <errno.h>
 #include <stdarg.h>
 
+#include "hash.h"
 #include "readliberty.h"
 
 /*--------------------------------------------------------------*/
  
 int libCurrentLine;
 
+/* Cells with fewer pins than this are searched without an index */
+#define PIN_INDEX_MIN	8
+
+/* Index of cell names for get_cell_by_name(), made for the cell	*/
+/* list that was last searched.						*/
+
+static struct hashtable CellIndex;
+static Cell *CellIndexList = NULL;
+
 /*--------------------------------------------------------------*/
 /* Grab a token from the input					*/
 /* Return the token, or NULL if we have reached end-of-file.	*/
+/* Calling with flib = NULL discards anything left in the line	*/
+/* buffer from a previously read file.				*/
 /*--------------------------------------------------------------*/
 
 char *
@@ -38,6 +50,10 @@ advancetoken(FILE *flib, char delimiter)
     int commentblock, concat, nest, quoted;
 
     if (token == NULL) token = (char *)malloc(LIB_LINE_MAX);
+    if (flib == NULL) {
+	linepos = NULL;
+	return NULL;
+    }
 
     commentblock = 0;
     concat = 0;
@@ -507,7 +523,8 @@ expand_buses(Pin *curpin, BUStype *curbus, char *busformat)
 /*--------------------------------------------------------------*/
 /* Read the liberty file and generate the cell database		*/
 /* If "pattern" is non-NULL, then use the pattern to filter the	*/
-/* cell results.						*/
+/* cell results.  Returns NULL if the file cannot be opened or	*/
+/* the library cannot be handled.				*/
 /*--------------------------------------------------------------*/
 
 Cell *
@@ -567,6 +584,7 @@ read_liberty(char *libfile, char *pattern)
 
     libCurrentLine = 0;
     lastcell = NULL;
+    advancetoken(NULL, 0);
 
     /* Read tokens off of the line */
     token = advancetoken(flib, 0);
@@ -588,7 +606,7 @@ read_liberty(char *libfile, char *pattern)
 		    if (strcmp(token, "{")) {
 			fprintf(stderr, "Did not find opening brace "
 					"on library block\n");
-			exit(1);
+			goto liberror;
 		    }
 		    section = LIBBLOCK;
 		}
@@ -612,7 +630,7 @@ read_liberty(char *libfile, char *pattern)
 		    if (strcasecmp(token, "table_lookup")) {
 			fprintf(stderr, "Sorry, only know how to "
 					"handle table lookup!\n");
-			exit(1);
+			goto liberror;
 		    }
 		}
 		else if (!strcasecmp(token, "lu_table_template") ||
@@ -783,6 +801,7 @@ read_liberty(char *libfile, char *pattern)
 		else if (!strcasecmp(token, "cell")) {
 		    newcell = (Cell *)malloc(sizeof(Cell));
 		    newcell->next = NULL;
+		    newcell->pinindex = NULL;
 		    if (lastcell != NULL)
 			lastcell->next = newcell;
 		    else
@@ -1373,6 +1392,11 @@ read_liberty(char *libfile, char *pattern)
     if (flib != NULL) fclose(flib);
 
     return cells;
+
+liberror:
+    fclose(flib);
+    delete_cell_list(cells);
+    return NULL;
 }
 
 /*----------------------------------------------------------------------*/
@@ -1454,16 +1478,16 @@ get_pincap(Cell *curcell, char *pinname, double *retcap)
 {
     Pin *curpin;
 
-    for (curpin = curcell->pins; curpin; curpin = curpin->next) {
-	if (!strcmp(curpin->name, pinname)) {
-	    if (curpin->type == PIN_INPUT || curpin->type == PIN_CLOCK) {
-		*retcap = curpin->cap;
-		return 0;
-	    }
-	    else {
-		*retcap = 0.0;
-		return 1;	/* pin is an output */
-	    }
+    /* Only an exact match of the pin name counts, not a bus root name */
+    curpin = get_pin_by_name(curcell, pinname);
+    if ((curpin != NULL) && !strcmp(curpin->name, pinname)) {
+	if (curpin->type == PIN_INPUT || curpin->type == PIN_CLOCK) {
+	    *retcap = curpin->cap;
+	    return 0;
+	}
+	else {
+	    *retcap = 0.0;
+	    return 1;	/* pin is an output */
 	}
     }
     *retcap = 0.0;
@@ -1472,12 +1496,70 @@ get_pincap(Cell *curcell, char *pinname, double *retcap)
 
 /*--------------------------------------------------------------------*/
 
+/*--------------------------------------------------------------------*/
+/* The pin indexes are hashed with the case-sensitive hash functions,	*/
+/* whatever the calling tool has set for its own tables.		*/
+/*--------------------------------------------------------------------*/
+
+static unsigned long (*savehashfunc)(char *, int);
+static int (*savematchfunc)(char *, char *);
+
+static void
+index_begin(void)
+{
+    savehashfunc = hashfunc;
+    savematchfunc = matchfunc;
+    hashfunc = hash;
+    matchfunc = match;
+}
+
+static void
+index_end(void)
+{
+    hashfunc = savehashfunc;
+    matchfunc = savematchfunc;
+}
+
+/*--------------------------------------------------------------------*/
+/* Index the cell list by cell name.  Cell names are compared without	*/
+/* regard to case.							*/
+/*--------------------------------------------------------------------*/
+
+static void
+index_cells(Cell *cell)
+{
+    Cell *currcell;
+    int numcells = 0;
+
+    if (CellIndexList != NULL) HashKill(&CellIndex);
+
+    for (currcell = cell; currcell; currcell = currcell->next) numcells++;
+    InitializeHashTable(&CellIndex, (numcells > SMALLHASHSIZE) ?
+		LARGEHASHSIZE : SMALLHASHSIZE);
+
+    for (currcell = cell; currcell; currcell = currcell->next)
+	HashNoCasePtrInstall(currcell->name, currcell, &CellIndex);
+    CellIndexList = cell;
+}
+
+/*--------------------------------------------------------------------*/
+/* Find a cell by name.  The list is indexed on the first search.	*/
+/* Cells not in the index (don't-use cells, and cells appended to the	*/
+/* list after it was indexed) are found by searching the list.		*/
+/*--------------------------------------------------------------------*/
+
 Cell *
 get_cell_by_name(Cell *cell, char *name)
 {
     Cell *currcell, *newcell;
     char trymore = (char)0;
 
+    if (cell == NULL) return NULL;
+
+    if (cell != CellIndexList) index_cells(cell);
+    currcell = (Cell *)HashNoCaseLookup(name, &CellIndex);
+    if (currcell != NULL) return currcell;
+
     for (currcell = cell; currcell; currcell = currcell->next) {
         if (!strcasecmp(currcell->name, name)) {
             return currcell;
@@ -1505,11 +1587,68 @@ get_cell_by_name(Cell *cell, char *name)
 
 /*--------------------------------------------------------------------*/
 
+/*--------------------------------------------------------------------*/
+/* Index the pins of a cell by name.  Full pin names are entered	*/
+/* first, then the root names of bus pins, so that a lookup finds	*/
+/* what the two searches in get_pin_by_name() would find.		*/
+/*--------------------------------------------------------------------*/
+
+static void
+index_pins(Cell *curcell)
+{
+    Pin *curpin;
+    char *dptr;
+    int numpins = 0;
+
+    for (curpin = curcell->pins; curpin; curpin = curpin->next) numpins++;
+
+    curcell->pinindex = (struct hashtable *)malloc(sizeof(struct hashtable));
+    InitializeHashTable(curcell->pinindex, numpins | 1);
+
+    for (curpin = curcell->pins; curpin; curpin = curpin->next)
+	if (HashLookup(curpin->name, curcell->pinindex) == NULL)
+	    HashPtrInstall(curpin->name, curpin, curcell->pinindex);
+
+    for (curpin = curcell->pins; curpin; curpin = curpin->next) {
+	dptr = strchr(curpin->name, '[');
+	if (dptr != NULL) {
+	    *dptr = '\0';
+	    if (HashLookup(curpin->name, curcell->pinindex) == NULL)
+		HashPtrInstall(curpin->name, curpin, curcell->pinindex);
+	    *dptr = '[';
+	}
+    }
+}
+
+/*--------------------------------------------------------------------*/
+/* Find a pin of a cell by name, or by the root name of a bus pin.	*/
+/* Pins of cells with many pins are found through an index made on	*/
+/* the first search.							*/
+/*--------------------------------------------------------------------*/
+
 Pin *
 get_pin_by_name(Cell *curcell, char *pinname)
 {
     Pin *curpin;
     char *dptr;
+    int numpins;
+
+    if (curcell->pinindex == NULL) {
+	numpins = 0;
+	for (curpin = curcell->pins; curpin; curpin = curpin->next)
+	    if (++numpins >= PIN_INDEX_MIN) break;
+	if (numpins >= PIN_INDEX_MIN) {
+	    index_begin();
+	    index_pins(curcell);
+	    index_end();
+	}
+    }
+    if (curcell->pinindex != NULL) {
+	index_begin();
+	curpin = (Pin *)HashLookup(pinname, curcell->pinindex);
+	index_end();
+	return curpin;
+    }
 
     for (curpin = curcell->pins; curpin; curpin = curpin->next) {
         if (!strcmp(curpin->name, pinname)) {
@@ -1557,6 +1696,10 @@ void delete_Cell(Cell *cell) {
     if (cell->times != NULL) free(cell->times);
     if (cell->caps != NULL) free(cell->caps);
     if (cell->values != NULL) free(cell->values);
+    if (cell->pinindex != NULL) {
+	HashKill(cell->pinindex);
+	free(cell->pinindex);
+    }
 
     while (curpin != NULL) {
         tmppin = curpin->next;
@@ -1573,6 +1716,11 @@ delete_cell_list(Cell *cell)
     Cell *currcell = cell;
     Cell *tmpcell;
 
+    if ((cell != NULL) && (cell == CellIndexList)) {
+	HashKill(&CellIndex);
+	CellIndexList = NULL;
+    }
+
     while (currcell != NULL) {
         tmpcell = currcell->next;
         delete_Cell(currcell);
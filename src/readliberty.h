@@ -85,6 +85,7 @@ typedef struct _cell {
     double *times;	// Local values for time indexes, if given
     double *caps;	// Local values for cap indexes, if given
     double *values;	// Matrix of all values
+    struct hashtable *pinindex;	// Pin name index (see get_pin_by_name())
     cellptr next;
 } Cell;
 
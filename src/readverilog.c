@@ -1673,7 +1673,7 @@ nextinst:
 			break;
 		    }
 		    else {
-			new_port = InstPort(thisinst, strdup(nexttok + 1), NULL);
+			new_port = InstPort(thisinst, nexttok + 1, NULL);
 			SkipTokComments(VLOG_DELIMITERS);
 			if (strcmp(nexttok, "(")) {
 			    fprintf(stdout, "Badly formed subcircuit pin line "
@@ -1893,8 +1893,10 @@ struct cellrec *ReadVerilogTop(char *fname, int blackbox)
 
     RecurseHashTable(&verilogparams, freeprop);
     HashKill(&verilogparams);
+    HashKill(&verilogvectors);
     RecurseHashTable(&verilogdefs, freeprop);
     HashKill(&verilogdefs);
+    dictinit = FALSE;	/* So that the next read initializes verilogdefs */
 
     if (CellStackPtr == NULL) return NULL;
 
@@ -1956,6 +1958,30 @@ void IncludeVerilog(char *fname, struct cellstack **CellStackPtr, int blackbox)
     CloseParseFile();
 }
 
+/*------------------------------------------------------*/
+/* Free one instance record of a cellrec.  The caller	*/
+/* must first unlink it from the cell's instance list.	*/
+/*------------------------------------------------------*/
+
+void FreeInstance(struct instance *inst)
+{
+    struct portrec *port, *dport;
+
+    if (inst->instname) free(inst->instname);
+    if (inst->cellname) free(inst->cellname);
+    port = inst->portlist;
+    while (port) {
+	if (port->name) free(port->name);
+	if (port->net) free(port->net);
+	dport = port->next;
+	free(port);
+	port = dport;
+    }
+    RecurseHashTable(&inst->propdict, freeprop);
+    HashKill(&inst->propdict);
+    free(inst);
+}
+
 /*------------------------------------------------------*/
 /* Free the cellrec structure created by ReadVerilog()	*/
 /*------------------------------------------------------*/
@@ -1975,20 +2001,8 @@ void FreeVerilog(struct cellrec *topcell)
     }
     inst = topcell->instlist;
     while (inst) {
-	if (inst->instname) free(inst->instname);
-	if (inst->cellname) free(inst->cellname);
-	port = inst->portlist;
-	while (port) {
-	    if (port->name) free(port->name);
-	    if (port->net) free(port->net);
-	    dport = port->next;
-	    free(port);
-	    port = dport;
-	}
-        RecurseHashTable(&inst->propdict, freeprop);
-        HashKill(&inst->propdict);
 	dinst = inst->next;
-	free(inst);
+	FreeInstance(inst);
 	inst = dinst;
     }
 
@@ -1999,6 +2013,9 @@ void FreeVerilog(struct cellrec *topcell)
     /* Delete properties hashtable. */
     RecurseHashTable(&topcell->propdict, freeprop);
     HashKill(&topcell->propdict);
+
+    free(topcell->name);
+    free(topcell);
 }
 
 
@@ -109,6 +109,7 @@ extern int vlinenum;
 extern void IncludeVerilog(char *, struct cellstack **, int);
 extern struct cellrec *ReadVerilog(char *);
 extern void FreeVerilog(struct cellrec *);
+extern void FreeInstance(struct instance *);
 extern void VerilogDefine(char *, char *);
 extern struct instance *AppendInstance(struct cellrec *cell, char *cellname);
 extern struct instance *PrependInstance(struct cellrec *cell, char *cellname);
@@ -17,6 +17,7 @@
 
 #include "hash.h"
 #include "readliberty.h"	/* liberty file database */
+#include "profile.h"		/* run time profiling */
 
 #define SRC     0x01    // node is a driver
 #define SNK     0x02    // node is a receiver
@@ -503,6 +504,8 @@ int main (int argc, char* argv[]) {
     // create first item in cell io list
     cell_io_ptr cell_io_list = NULL;
 
+    ProfileInit(argv[0]);
+
     while ((opt = getopt(argc, argv, "s:l:o:v:")) != -1) {
         switch (opt) {
 
@@ -23,6 +23,14 @@
 /*              -e              exhaustive search               */
 /*		-s <file>	summary file or directory	*/
 /*		-c		cleanup of net name syntax	*/
+/*		-k <file>	clock and path exception file	*/
+/*		-b		latch time borrowing		*/
+/*		-r <late>[,<early>]				*/
+/*				delay derating factors		*/
+/*		-N <file>	net slack file			*/
+/*		-M		low-memory mode			*/
+/*		-C <name>=<lib>[,<lib>...]			*/
+/*				analyze another corner		*/
 /*                                                              */
 /*      Currently the only output this tool generates is a      */
 /*      list of paths with negative slack.  If no paths have    */
@@ -34,6 +42,38 @@
 /*      slack are output, following a statement indicated the   */
 /*      computed minimum clock period.                          */
 /*								*/
+/*	Each option -C adds a process corner with its own set	*/
+/*	of liberty files (the liberty files after the verilog	*/
+/*	file, if any, are the first corner).  The netlist,	*/
+/*	delays, and loads are computed once, and the paths are	*/
+/*	reported for each corner in turn, followed by a summary	*/
+/*	of the worst paths of all corners.			*/
+/*								*/
+/*	Option -r scales the maximum delays by the factor	*/
+/*	<late> and the minimum delays by <early> (default 1.0)	*/
+/*	for on-chip variation.  The clock skew of each path	*/
+/*	does not count the pessimism of the late and early	*/
+/*	delays on the part of the clock tree common to the	*/
+/*	launch and capture clocks (see find_clock_skews()).	*/
+/*								*/
+/*	Option -N writes the worst slack of each net on a	*/
+/*	checked path, and its criticality, to a file (see	*/
+/*	write_net_slack()).  vlog2Cel and vlog2Def read it to	*/
+/*	weight the critical nets for placement.			*/
+/*								*/
+/*	Option -M reduces the peak memory on very large		*/
+/*	netlists:  the netlist read by ReadVerilog() is freed	*/
+/*	one instance at a time as it is converted, and the	*/
+/*	collapsed delay vectors of pins of the same cell with	*/
+/*	the same load are shared.  The peak memory is reported	*/
+/*	at the end of each phase.				*/
+/*								*/
+/*	With option -b, latch enables are path starts like	*/
+/*	flop clocks, and data arriving at a latch while it is	*/
+/*	transparent borrows time from the paths through the	*/
+/*	latch (see latch_borrow()).  Without it, paths stop at	*/
+/*	latches and are not checked.				*/
+/*								*/
 /*	Debug level (developer diagnostics):			*/
 /*	    Not cumulative.  Each number does something unique.	*/
 /*		1:  Print delay file parsing information	*/
@@ -66,6 +106,11 @@
 /*      -Values <delay_i> are in ps                             */
 /*      -<input_terminal_N> line *must* be following by a blank */
 /*       line                                                   */
+/*                                                              */
+/*      If the delay file name ends in ".spef", the file is     */
+/*      read as SPEF parasitics instead (such as written by     */
+/*      "rc2dly -d <name>.spef"), and the wiring delays are     */
+/*      computed from the RC network of each net.               */
 /*--------------------------------------------------------------*/
 
 #include <stdio.h>
@@ -76,9 +121,12 @@
 #include <stdarg.h>
 #include <sys/types.h>	// For mkdir()
 #include <sys/stat.h>	// For mkdir()
+#include <sys/time.h>	// For gettimeofday()
 #include <math.h>       // Temporary, for fabs()
 #include "hash.h"       // For net hash table
 #include "readverilog.h"
+#include "profile.h"
+#include "vesta.h"
 
 #define LIB_LINE_MAX  65535
 
@@ -98,6 +146,7 @@ int fileCurrentLine;
 #define MAXIMUM_TIME    1
 
 #define INITVAL		-1.0E50		/* Value to detect uninitialized delay */
+#define NOSLACK		1.0E50		/* Slack of a net on no path */
 
 // Multiple-use definition
 #define UNKNOWN         -1
@@ -289,6 +338,7 @@ typedef struct _cell {
     double area;
     double maxtrans;    /* Maximum transition time */
     double maxcap;      /* Maximum allowable load */
+    struct hashtable *pinhash;	/* Pin name index, or NULL (see cellIndexBuild) */
     cellptr next;
 } cell;
 
@@ -308,11 +358,24 @@ typedef struct _net {
    connptr *receivers;
    double loadr;        /* Total load capacitance for rising input */
    double loadf;        /* Total load capacitance for falling input */
+   int clocknode;	/* Index of the net in the clock tree, or -1 */
+   float crit;		/* Highest criticality of the paths through the net */
+   double slack;	/* Worst slack of the paths through the net (see net_slack) */
    netptr next;
 } net;
 
 typedef struct _instance *instptr;
 
+// Timing data of an input connection at one corner (see cornerBind)
+
+typedef struct _cornerdata {
+   pinptr   refpin;
+   double   *prvector;
+   double   *pfvector;
+   double   *trvector;
+   double   *tfvector;
+} cornerdata;
+
 typedef struct _connect {
    double   metric;             /* Delay metric at connection */
    double   icDelay;            /* interconnect delay in ps */
@@ -325,6 +388,10 @@ typedef struct _connect {
    double   *pfvector;          /* Prop delay falling (at load condition) vector */
    double   *trvector;          /* Transition time rising (at load condition) vector */
    double   *tfvector;          /* Transition time falling (at load condition) vector */
+   cornerdata *corners;		/* Per-corner pin and vectors, or NULL */
+   unsigned int domains;	/* Clock domains of the endpoints downstream */
+   unsigned int exthru;		/* Exceptions with a "-through" matching here */
+   unsigned int exto;		/* Exceptions matching all endpoints downstream */
    connptr  next;
 } connect;
 
@@ -333,9 +400,25 @@ typedef struct _instance {
    cellptr refcell;
    connptr in_connects;
    connptr out_connects;
+   unsigned char domain;	/* Clock domain of a flop (0 if none) */
+   unsigned char edge;		/* Clock source edge that clocks the flop */
+   double borrow;		/* Time borrowed by a latch (see latch_borrow) */
    instptr next;
 } instance;
 
+// Liberty data of one process corner
+
+typedef struct _corner *cornerptr;
+
+typedef struct _corner {
+   char *name;
+   char *libfiles;		/* Comma-separated list of liberty files */
+   lutable *tables;
+   cell *cells;
+   struct hashtable Cellhash;
+   cornerptr next;
+} corner;
+
 // Linked list of delays (backtrace to source)
 
 typedef struct _btdata *btptr;
@@ -356,6 +439,8 @@ typedef struct _delaydata {
    double skew;		/* Part of total delay attributed to clock skew */
    double setup;	/* Part of total delay attributed to setup (+) or hold (-) */
    double trans;        /* Transition time at destination, used to find setup */
+   double required;	/* Time allowed by the launch and capture clocks */
+   int cycles;		/* Number of clock cycles allowed (multicycle path) */
    btptr backtrace;
    ddataptr  next;
 } delaydata;
@@ -370,19 +455,113 @@ typedef struct _connlist {
    connlistptr next;
 } connlist;
 
+// Summary of the timing analysis of one corner
+
+typedef struct _timingresult {
+   double maxdelay;		/* Longest maximum delay path, in ps */
+   double mindelay;		/* Shortest minimum delay path, in ps */
+   double setupslack;		/* Worst setup slack, if constrained */
+   double holdslack;		/* Worst hold slack, in ps */
+   char constrained;		/* Set if any path has a required time */
+   char setupfail;		/* Set if a path fails the clock period */
+   char holdfail;		/* Set if a path fails hold */
+   int numpaths;		/* Number of entries in paths */
+   VestaPath *paths;		/* Reported maximum delay paths */
+} timingresult;
+
+// Path starting or ending on a latch (see latch_borrow)
+
+typedef struct _latchpath {
+   ddataptr path;
+   instptr  srcinst;		/* Latch at the path start, or NULL */
+   instptr  destinst;		/* Latch at the path end, or NULL */
+   double   open;		/* Time the destination latch opens */
+   double   window;		/* Time the destination latch is open */
+   char     changed;		/* Set if the path changed the borrowed time */
+} latchpath;
+
+// Net of the clock tree (see clock_tree_build).  Arrival times are
+// indexed by edge (RISING - 1 or FALLING - 1) and are measured from
+// the root of the tree, which is a module input or an undriven net.
+
+typedef struct _clocknode {
+   netptr   net;
+   int      parent;		/* Index of the parent net, or -1 for a root */
+   int      depth;		/* Number of nets between this net and the root */
+   short    regs;		/* Flops and latches between this net and the root */
+   short    invert;		/* Inversions from the root (0 or 1), or -1 if not unate */
+   double   late[2];		/* Latest arrival (maximum delay, late derate) */
+   double   early[2];		/* Earliest arrival (minimum delay, early derate) */
+   double   latetrans[2];	/* Transition time of the latest arrival */
+   double   earlytrans[2];	/* Transition time of the earliest arrival */
+} clocknode;
+
+// Clock domain of a clock constraint (see clockRead).  Domain 0 is
+// the default domain of flops not clocked by any constrained clock.
+
+#define MAX_DOMAINS	30
+
+#define DOMAIN_PENDING	0x40000000	/* Domain mask is being computed */
+#define DOMAIN_DONE	0x80000000	/* Domain mask has been computed */
+#define DOMAIN_ALL	0x3fffffff
+
+typedef struct _clockdef {
+   char *name;
+   netptr source;		/* Clock source net */
+   double period;		/* Clock period, in ps */
+   double rise;			/* Time of the rising edge, in ps */
+   double fall;			/* Time of the falling edge, in ps */
+   unsigned int related;	/* Domains whose paths from this one are checked */
+} clockdef;
+
+// Path exception (see clockRead).  Exception "i" is bit i of the
+// exception masks of each connection.
+
+#define MAX_EXCEPTIONS	32
+
+typedef struct _exception {
+   char *from;			/* Pattern for the path start, or NULL */
+   char *through;		/* Pattern for a point on the path, or NULL */
+   char *to;			/* Pattern for the path end, or NULL */
+   int cycles;			/* Cycles allowed, or 0 for a false path */
+} exception;
+
 /* Global variables */
 
 unsigned char verbose;       /* Level of user output generated */
 unsigned char debug;	     /* Level of debug output generated */
 unsigned char exhaustive;    /* Exhaustive search mode */
 unsigned char cleanup;       /* Clean up net name syntax */
+unsigned char latchmode;     /* Latches are path starts and borrow time */
+unsigned char netslack;      /* Record the worst slack of each net */
+unsigned char lowmem;	     /* Low-memory mode for very large netlists */
+
+clockdef clockdefs[MAX_DOMAINS];	/* Clock domains (see clockRead) */
+int numdomains;			/* Number of clock domains, including 0 */
+unsigned int pathmask;		/* Domains checked from the current path start */
+
+exception exceptions[MAX_EXCEPTIONS];	/* Path exceptions (see clockRead) */
+int numexceptions;		/* Number of path exceptions */
+unsigned int thrumask;		/* Exceptions that have a "-through" pattern */
+unsigned int pathfalse;		/* False path exceptions of the current path start */
+unsigned int pathmulti;		/* Multicycle exceptions of the current path start */
+
+double derate[2];		/* Delay factors, [MINIMUM_TIME] early, [MAXIMUM_TIME] late */
+
+clocknode *clocknodes;		/* Clock tree (see clock_tree_build) */
+int numclocknodes;		/* Number of nets in the clock tree */
+int maxclocknodes;		/* Allocated size of clocknodes */
+int **clockup;			/* Ancestors of each net at 2^k levels up */
+int clocklevels;		/* Number of levels of clockup */
 
 /*--------------------------------------------------------------*/
 /* Grab a token from the input                                  */
 /* Return the token, or NULL if we have reached end-of-file.    */
+/* Calling with flib = NULL discards anything left in the line	*/
+/* buffer from a previously read file.				*/
 /*--------------------------------------------------------------*/
 
-char *
+static char *
 advancetoken0(FILE *flib, char delimiter, char nocontline)
 {
     static char *token = NULL;
@@ -396,6 +575,10 @@ advancetoken0(FILE *flib, char delimiter, char nocontline)
     int commentblock, concat, nest;
 
     if (token == NULL) token = (char *)malloc(LIB_LINE_MAX);
+    if (flib == NULL) {
+	linepos = NULL;
+	return NULL;
+    }
 
     commentblock = 0;
     concat = 0;
@@ -544,22 +727,12 @@ advancetoken0(FILE *flib, char delimiter, char nocontline)
 /* Wrapper for advancetoken0():  Default nocontline = 0		*/
 /*--------------------------------------------------------------*/
 
-char *
+static char *
 advancetoken(FILE *flib, char delimiter)
 {
     return advancetoken0(flib, delimiter, 0);
 }
 
-/*--------------------------------------------------------------*/
-/* Wrapper for advancetoken0():  nocontline = 1	for delay file	*/
-/*--------------------------------------------------------------*/
-
-char *
-advancetokennocont(FILE *flib, char delimiter)
-{
-    return advancetoken0(flib, delimiter, 1);
-}
-
 /*--------------------------------------------------------------*/
 /* Wrapper around strdup() to remove any quotes from around the	*/
 /* text being copied.						*/
@@ -672,6 +845,9 @@ netptr create_net(netptr *netlist) {
     newnet->loadr = 0.0;
     newnet->loadf = 0.0;
     newnet->type = NET;
+    newnet->clocknode = -1;
+    newnet->slack = NOSLACK;
+    newnet->crit = 0.0;
 
     return newnet;
 }
@@ -1138,6 +1314,8 @@ makehead:
     newdataptr->skew = 0.0;
     newdataptr->setup = 0.0;
     newdataptr->trans = 0.0;
+    newdataptr->required = 0.0;
+    newdataptr->cycles = 1;
     newdataptr->next = *clocklist;
     *clocklist = newdataptr;
     
@@ -1145,91 +1323,105 @@ makehead:
 }
 
 /*--------------------------------------------------------------*/
-/* Determine the delay to a clock pin from the farthest point   */
-/* back in the network, either to an input pin or the output of */
-/* another flop (e.g., a ripple counter).  If there is more     */
-/* than one such source (which can happen with, say, a gated    */
-/* clock, because this routine will not differentiate between   */
-/* the clock signal and the gating signal), then all sources    */
-/* recorded (it is only necessary to find a common root of all  */
-/* other related clocks downstream).                            */
-/*                                                              */
-/* This is a recursive routine, continuing to find all delays   */
-/* through the circuit until it reaches "terminal".  The        */
-/* "delaylist" linked list is not modified by this routine.     */
-/* However, it depends on routine find_clock_source marking	*/
-/* each connection as visited, so that the search is restricted	*/
-/* to the space visited on the upstream search, so it is not	*/
-/* blindly recursive.						*/
+/* Match a name against a pattern in which "*" matches any	*/
+/* string and "?" matches any one character.  Brackets are not	*/
+/* special, so that bus names like "data[3]" match themselves.	*/
 /*--------------------------------------------------------------*/
 
-void find_clock_delay(int dir, double delay, double trans,
-                btptr backtrace, connptr terminal, char minmax,
-		unsigned char mode) {
+int
+patternMatch(char *pattern, char *name)
+{
+    char *pstar = NULL, *nstar = NULL;
 
-    pinptr  testpin;
-    netptr  loadnet;
-    cellptr testcell;
-    connptr receiver;
-    connptr nextrcvr;
-    instptr testinst;
-    btptr   testbtdata, newbtdata;
-    double  newdelayr, newdelayf, newtransr, newtransf;
-    short   outdir;
-    int     i;
-
-    receiver = backtrace->receiver;
-
-    if (minmax == MAXIMUM_TIME) {
-        /* Is delay greater than that already recorded?  If so, replace it */
-        if ((delay > backtrace->delay) || (backtrace->delay == INITVAL)) {
-            backtrace->delay = delay;
-            backtrace->trans = trans;
-            backtrace->dir = dir;
-        }
-    }
-    else {
-        /* Is delay less than that already recorded?  If so, replace it */
-        if ((delay < backtrace->delay) || (backtrace->delay == INITVAL)) {
-            backtrace->delay = delay;
-            backtrace->trans = trans;
-            backtrace->dir = dir;
-        }
+    while (*name != '\0') {
+	if (*pattern == '*') {
+	    pstar = pattern++;
+	    nstar = name;
+	}
+	else if ((*pattern == '?') || (*pattern == *name)) {
+	    pattern++;
+	    name++;
+	}
+	else if (pstar != NULL) {
+	    pattern = pstar + 1;
+	    name = ++nstar;
+	}
+	else
+	    return 0;
     }
+    while (*pattern == '*') pattern++;
+    return (*pattern == '\0');
+}
 
-    // Stop when receiver matches terminal.
+/*--------------------------------------------------------------*/
+/* Check if an exception pattern matches connection "testconn".	*/
+/* A pin matches by its instance name or by "instance/pin".	*/
+/* A module pin matches by its net name, and if "usenet" is	*/
+/* set, so does any pin on a net.				*/
+/*--------------------------------------------------------------*/
 
-    if (receiver != terminal) {
+int
+exceptionMatch(char *pattern, connptr testconn, unsigned char usenet)
+{
+    static char *pinname = NULL;
+    static int pinsize = 0;
+    int len;
+
+    if (((testconn->refinst == NULL) || usenet) && (testconn->refnet != NULL))
+	if (patternMatch(pattern, testconn->refnet->name))
+	    return 1;
+    if (testconn->refinst == NULL) return 0;
+    if (patternMatch(pattern, testconn->refinst->name)) return 1;
+    if (testconn->refpin == NULL) return 0;
+
+    len = strlen(testconn->refinst->name) + strlen(testconn->refpin->name) + 2;
+    if (len > pinsize) {
+	pinsize = len;
+	pinname = (char *)realloc(pinname, pinsize);
+    }
+    sprintf(pinname, "%s/%s", testconn->refinst->name, testconn->refpin->name);
+    return patternMatch(pattern, pinname);
+}
 
-        // Don't follow signal through any DFF pins
-	testpin = receiver->refpin;
-        testinst = receiver->refinst;
-        testcell = (testpin) ? testpin->refcell : NULL;
-        if (testcell && (testcell->type & DFF)) return;
+/*--------------------------------------------------------------*/
+/* Set the false path and multicycle exceptions that apply to	*/
+/* paths starting at connection "thisconn".			*/
+/*--------------------------------------------------------------*/
 
-        // Compute delay from gate input to output
+void
+start_exceptions(connptr thisconn)
+{
+    int i;
 
-        outdir = calc_dir(testpin, dir);
-        if (outdir & RISING) {
-            newdelayr = backtrace->delay +
-			calc_prop_delay(trans, receiver, RISING, minmax);
-            newtransr = calc_transition(trans, receiver, RISING, minmax);
-        }
-        if (outdir & FALLING) {
-            newdelayf = backtrace->delay +
-			calc_prop_delay(trans, receiver, FALLING, minmax);
-            newtransf = calc_transition(trans, receiver, FALLING, minmax);
-        }
+    pathfalse = pathmulti = 0;
+    for (i = 0; i < numexceptions; i++) {
+	if ((exceptions[i].from != NULL) &&
+		!exceptionMatch(exceptions[i].from, thisconn, (unsigned char)0))
+	    continue;
+	if (exceptions[i].cycles == 0)
+	    pathfalse |= (1U << i);
+	else
+	    pathmulti |= (1U << i);
+    }
+}
 
-        /* Continue calculating down the backtrace */
+/*--------------------------------------------------------------*/
+/* Return the number of clock cycles allowed for a path from	*/
+/* the current path start to endpoint "receiver", passing the	*/
+/* "-through" points in "thrubits".				*/
+/*--------------------------------------------------------------*/
 
-	if (outdir & RISING)
-	    find_clock_delay(RISING, newdelayr, newtransr, backtrace->next,
-			terminal, minmax, mode);
-	if (outdir & FALLING)
-	    find_clock_delay(FALLING, newdelayf, newtransf, backtrace->next,
-			terminal, minmax, mode);
-    }
+int
+path_cycles(connptr receiver, unsigned int thrubits)
+{
+    unsigned int multi;
+    int i, cycles = 1;
+
+    multi = pathmulti & receiver->exto & (~thrumask | thrubits);
+    for (i = 0; multi != 0; i++, multi >>= 1)
+	if ((multi & 1) && (exceptions[i].cycles > cycles))
+	    cycles = exceptions[i].cycles;
+    return cycles;
 }
 
 /*--------------------------------------------------------------*/
@@ -1237,24 +1429,29 @@ void find_clock_delay(int dir, double delay, double trans,
 /*                                                              */
 /* This is a recursive routine, continuing to find all delays   */
 /* through the circuit until it reaches a terminal or flop      */
-/* input.  It is similar to find_clock_delay, but stops on all  */
-/* terminal points found in the path, rather than stopping on   */
-/* a specific connection.                                       */
+/* input, stopping on all terminal points found in the path.    */
+/*                                                              */
+/* The routine keeps a running record of the path followed      */
+/* from the source.  When a terminal is found, the path and     */
+/* delay are saved and added to "delaylist".  After the         */
+/* recursive search, "delaylist" contains a list of all paths   */
+/* starting from the original connection "receiver" and ending  */
+/* on a clock or an output pin.  Where multiple paths exist     */
+/* between source and destination, only the path with the       */
+/* longest delay is kept.                                       */
 /*                                                              */
-/* Also unlike find_clock_delay, the routine keeps a running    */
-/* record of the path followed from the source, as a character  */
-/* string.  When a terminal is found, the path and delay are    */
-/* saved and added to "delaylist".  After the recursive search, */
-/* "delaylist" contains a list of all paths starting from the   */
-/* original connection "receiver" and ending on a clock or an   */
-/* output pin.  Where multiple paths exist between source and   */
-/* destination, only the path with the longest delay is kept.   */
+/* Gate and interconnect delays are scaled by the late (maximum */
+/* time) or early (minimum time) derating factor.		*/
+/*                                                              */
+/* "thrubits" are the exceptions whose "-through" point is on	*/
+/* the path up to "receiver".					*/
 /*                                                              */
 /* Return the number of new paths recorded.                     */
 /*--------------------------------------------------------------*/
 
 int find_path_delay(int dir, double delay, double trans, connptr receiver,
-                btptr backtrace, ddataptr *delaylist, char minmax) {
+                btptr backtrace, ddataptr *delaylist, char minmax,
+		unsigned int thrubits) {
 
     pinptr   testpin;
     netptr   loadnet;
@@ -1281,6 +1478,22 @@ int find_path_delay(int dir, double delay, double trans, connptr receiver,
     // implies that the final result may not be the absolute maximum delay,
     // although it will typically vary by less than an average gate delay.
 
+    // Do not trace logic that reaches no endpoint in a clock domain
+    // checked from the start of the path (see assign_clock_domains()).
+
+    if (pathmask && backtrace && !(receiver->domains & pathmask))
+	return numpaths;
+
+    // Do not trace paths that can only be false paths from the start
+    // of the path (see compile_exceptions()).  Exceptions with a
+    // "-through" point apply only once the path has passed it.
+
+    if (numexceptions > 0) {
+	thrubits |= receiver->exthru;
+	if (backtrace && (pathfalse & receiver->exto & (~thrumask | thrubits)))
+	    return numpaths;
+    }
+
     if (!exhaustive) {
         if (minmax == MAXIMUM_TIME) {
             if (delay <= receiver->metric)
@@ -1302,7 +1515,8 @@ int find_path_delay(int dir, double delay, double trans, connptr receiver,
 
     newbtdata = (btptr)malloc(sizeof(btdata));
     newbtdata->receiver = receiver;
-    newbtdata->delay = delay + newbtdata->receiver->icDelay;
+    newbtdata->delay = delay + newbtdata->receiver->icDelay *
+		derate[(int)minmax];
     newbtdata->trans = trans;
     newbtdata->dir = dir;
     newbtdata->refcnt = 0;
@@ -1322,11 +1536,13 @@ int find_path_delay(int dir, double delay, double trans, connptr receiver,
 
         outdir = calc_dir(testpin, dir);
         if (outdir & RISING) {
-            newdelayr = delay + calc_prop_delay(trans, receiver, RISING, minmax);
+            newdelayr = delay + derate[(int)minmax] *
+			calc_prop_delay(trans, receiver, RISING, minmax);
             newtransr = calc_transition(trans, receiver, RISING, minmax);
         }
         if (outdir & FALLING) {
-            newdelayf = delay + calc_prop_delay(trans, receiver, FALLING, minmax);
+            newdelayf = delay + derate[(int)minmax] *
+			calc_prop_delay(trans, receiver, FALLING, minmax);
             newtransf = calc_transition(trans, receiver, FALLING, minmax);
         }
 
@@ -1335,10 +1551,12 @@ int find_path_delay(int dir, double delay, double trans, connptr receiver,
 	    for (i = 0; i < loadnet->fanout; i++) {
 		if (outdir & RISING)
 		    numpaths += find_path_delay(RISING, newdelayr, newtransr,
-				loadnet->receivers[i], newbtdata, delaylist, minmax);
+				loadnet->receivers[i], newbtdata, delaylist, minmax,
+				thrubits);
 		if (outdir & FALLING)
 		    numpaths += find_path_delay(FALLING, newdelayf, newtransf,
-				loadnet->receivers[i], newbtdata, delaylist, minmax);
+				loadnet->receivers[i], newbtdata, delaylist, minmax,
+				thrubits);
 	    }
 	}
         receiver->tag = NULL;
@@ -1379,6 +1597,7 @@ int find_path_delay(int dir, double delay, double trans, connptr receiver,
 		    /* Update the delay at testddata */
 		    testddata->delay = newbtdata->delay + testddata->setup
 				+ testddata->skew;
+		    testddata->cycles = path_cycles(receiver, thrubits);
                 }
             }
             else
@@ -1397,6 +1616,8 @@ int find_path_delay(int dir, double delay, double trans, connptr receiver,
             newddata->setup = 0.0;
             newddata->skew = 0.0;
             newddata->trans = 0.0;
+            newddata->required = 0.0;
+            newddata->cycles = path_cycles(receiver, thrubits);
             newddata->backtrace = newbtdata;
 	    if (newbtdata) newbtdata->refcnt++;
             newddata->next = *delaylist;
@@ -1408,83 +1629,47 @@ int find_path_delay(int dir, double delay, double trans, connptr receiver,
     }
 
     receiver->metric = delay;
-    if (newbtdata->refcnt <= 0) free(newbtdata);
-    return numpaths;
-}
 
-/*--------------------------------------------------------------*/
-/* Search the list "clocklist" for all points that are module   */
-/* inputs or flop outputs, and compute the worst-case           */
-/* transition time downstream at testlink.                      */
-/*                                                              */
-/* Upon return, the worst-case transition time is held in	*/
-/* returned backtrace pointer.					*/
-/*								*/
-/* If mode is non-zero, then only trace paths marked visited ==	*/
-/* mode.  This restricts the computation to nodes that were	*/
-/* found on the upstream search find_clock_source().		*/
-/*--------------------------------------------------------------*/
+    // Free the record if no path through it was kept, and release its
+    // reference to the rest of the backtrace.
 
-void find_clock_transition(ddataptr clocklist, connptr testlink, short dir,
-	char minmax, unsigned char mode)
-{
-    ddataptr testclock;
-    btptr  backtrace;
-    double tdriver, ddelay;
-
-    ddelay = 0.0;
-    for (testclock = clocklist; testclock; testclock = testclock->next) {
-        backtrace = testclock->backtrace;
-        tdriver = 0.0;          // to-do:  set to default input transition time
-        find_clock_delay(RISING, ddelay, tdriver, backtrace, testlink,
-                        minmax, mode);
-        find_clock_delay(FALLING, ddelay, tdriver, backtrace, testlink,
-                        minmax, mode);
-
-        // In mode 2, only check timing from 1st item in the list 
-	if (mode == (unsigned char)2) break;
+    if (newbtdata->refcnt <= 0) {
+	if (backtrace) backtrace->refcnt--;
+	free(newbtdata);
     }
+    return numpaths;
 }
 
 /*--------------------------------------------------------------*/
-/* Find the common point between two clock lists (it has	*/
-/* already been determined that a common point exists).		*/
-/* The 1st record of clock2list points to the connection	*/
-/* record that is the common point.  What is needed is to find	*/
-/* the backtrace record in clocklist that points to the same	*/
-/* connection record.						*/
+/* Return the clock edge (RISING or FALLING) that clocks a	*/
+/* flop, or that opens a latch, of cell "testcell".		*/
 /*--------------------------------------------------------------*/
 
-btptr
-find_common_clock(ddataptr clock2list, ddataptr clocklist)
+short clock_edge(cellptr testcell)
 {
-    ddataptr ddsearch;
-    btptr btsearch;
-    connptr ccommon;
-
-    ccommon = clock2list->backtrace->receiver;
-
-    for (ddsearch = clocklist; ddsearch; ddsearch = ddsearch->next)
-	for (btsearch = ddsearch->backtrace; btsearch; btsearch = btsearch->next)
-	    if (btsearch->receiver == ccommon)
-		return btsearch;
-
-    return NULL;
+    if (testcell->type & LATCH)
+	return (testcell->type & EN_SENSE_MASK) ? FALLING : RISING;
+    else
+	return (testcell->type & CLK_SENSE_MASK) ? FALLING : RISING;
 }
 
 /*--------------------------------------------------------------*/
 /* Given an instance record, find the pin of the instance that  */
-/* is the clock, if the instance is a flop.  If the instance is */
-/* not a flop, return NULL.                                     */
+/* is the clock, if the instance is a flop.  In latch mode, the	*/
+/* enable pin of a latch is also returned.  If the instance is	*/
+/* not a flop (or latch), return NULL.				*/
 /*--------------------------------------------------------------*/
 
 connptr find_register_clock(instptr testinst)
 {
     connptr testconn;
 
-    for (testconn = testinst->in_connects; testconn; testconn = testconn->next)
+    for (testconn = testinst->in_connects; testconn; testconn = testconn->next) {
         if (testconn->refpin && (testconn->refpin->type & DFFCLK))
             return testconn;
+        if (latchmode && testconn->refpin && (testconn->refpin->type & LATCHEN))
+            return testconn;
+    }
 
     return NULL;
 }
@@ -1628,12 +1813,25 @@ int find_clock_to_term_paths(connlistptr clockedlist, ddataptr *masterlist, netp
 
         thisconn = testlink->connection;
         testpin = thisconn->refpin;
+
+	// Set the clock domains and the exceptions that apply from
+	// this path start
+	if (numexceptions > 0)
+	    start_exceptions(thisconn);
+
+	if (numdomains > 1)
+	    pathmask = (testpin && thisconn->refinst) ?
+			clockdefs[thisconn->refinst->domain].related : DOMAIN_ALL;
+	else
+	    pathmask = 0;
+
         if (testpin) {
             testcell = testpin->refcell;
 
             // Sense is positive for rising edge-triggered flops, negative for
-            // falling edge-triggered flops
-            srcdir = (testcell->type & CLK_SENSE_MASK) ? FALLING : RISING;
+            // falling edge-triggered flops (and likewise for the edge that
+            // opens a latch)
+            srcdir = clock_edge(testcell);
 
             // Report on paths and their maximum delays
             if (verbose > 1)
@@ -1653,11 +1851,27 @@ int find_clock_to_term_paths(connlistptr clockedlist, ddataptr *masterlist, netp
         if (verbose > 1) fflush(stdout);
 
         // Find all paths from "thisconn" to output or a flop input, and compute delay
-        n = find_path_delay(srcdir, 0.0, 0.0, thisconn, NULL, &delaylist, minmax);
+        n = find_path_delay(srcdir, 0.0, 0.0, thisconn, NULL, &delaylist, minmax, 0);
         numpaths += n;
 
         if (verbose > 1) fprintf(stdout, "%d paths traced (%d total).\n\n", n, numpaths);
 
+	// An endpoint normally keeps only the worst path from any start.
+	// In latch mode, the paths starting or ending on a latch are kept
+	// apart from the paths of later starts, as the time borrowed by
+	// each latch is added to the paths from it (see latch_borrow()).
+
+	if (latchmode) {
+	    for (testddata = delaylist; testddata; testddata = testddata->next) {
+		testconn = testddata->backtrace->receiver;
+		if ((testpin && (testpin->type & LATCHEN)) || (testconn->refpin &&
+			(testconn->refpin->type & LATCHIN))) {
+		    testconn->tag = NULL;
+		    testconn->metric = (minmax == MAXIMUM_TIME) ? -1.0 : 1E50;
+		}
+	    }
+	}
+
         // Link delaylist data to the beginning of masterlist, and null out
         // delaylist for the next set of paths.
 
@@ -1724,7 +1938,7 @@ int get_table_type(char *token) {
 /* Expand a bus into individual pins.				*/
 /*--------------------------------------------------------------*/
 
-void
+static void
 expand_buses(pin *curpin, bus *curbus, char *busformat)
 {
     pin *newpin;
@@ -1779,12 +1993,14 @@ expand_buses(pin *curpin, bus *curbus, char *busformat)
 
 /*--------------------------------------------------------------*/
 /* Read a liberty format file and collect information about     */
-/* the timing properties of each standard cell.                 */
+/* the timing properties of each standard cell.  Returns 0 on	*/
+/* success, 1 if the library cannot be handled.			*/
 /*--------------------------------------------------------------*/
 
-void
+int
 libertyRead(FILE *flib, lutable **tablelist, cell **celllist)
 {
+    int status = 0;
     char *token;
     char *libname = NULL;
     int section = INIT;
@@ -1795,7 +2011,7 @@ libertyRead(FILE *flib, lutable **tablelist, cell **celllist)
     pinptr testpin;
     lutable *tableptr;
 
-    pin proxypin;
+    pin proxypin, latcharc;
     int i, j;
     double gval;
     char *iptr;
@@ -1807,7 +2023,8 @@ libertyRead(FILE *flib, lutable **tablelist, cell **celllist)
     pin *newpin;
     bus *buses = NULL, *newbus, *curbus = NULL;
 
-    lastcell = NULL;
+    /* Append to the cells of any liberty files already read */
+    for (lastcell = *celllist; lastcell && lastcell->next; lastcell = lastcell->next);
     timing_type = UNKNOWN;
 
     /* Set up pin placeholder */
@@ -1822,11 +2039,13 @@ libertyRead(FILE *flib, lutable **tablelist, cell **celllist)
     proxypin.transf = NULL;
     proxypin.refcell = NULL;
     proxypin.next = NULL;
+    latcharc = proxypin;
 
     /* Set default bus format (verilog style) */
     busformat = strdup("%s[%d]");
 
     /* Read tokens off of the line */
+    advancetoken(NULL, 0);
     token = advancetoken(flib, 0);
 
     while (token != NULL) {
@@ -1847,7 +2066,8 @@ libertyRead(FILE *flib, lutable **tablelist, cell **celllist)
                     if (strcmp(token, "{")) {
                         fprintf(stderr, "Did not find opening brace "
                                         "on library block\n");
-                        exit(1);
+                        status = 1;
+                        goto libdone;
                     }
                     section = LIBBLOCK;
                 }
@@ -1872,7 +2092,8 @@ libertyRead(FILE *flib, lutable **tablelist, cell **celllist)
                     if (tokencasecmp(token, "table_lookup")) {
                         fprintf(stderr, "Sorry, only know how to "
                                         "handle table lookup!\n");
-                        exit(1);
+                        status = 1;
+                        goto libdone;
                     }
                 }
                 else if (!tokencasecmp(token, "lu_table_template") ||
@@ -2071,6 +2292,7 @@ libertyRead(FILE *flib, lutable **tablelist, cell **celllist)
                     newcell->type = GATE;               // Default type
                     newcell->function = NULL;
                     newcell->pins = NULL;
+                    newcell->pinhash = NULL;
                     newcell->area = 1.0;
                     newcell->maxtrans = 0.0;
                     newcell->maxcap = 0.0;
@@ -2487,6 +2709,10 @@ libertyRead(FILE *flib, lutable **tablelist, cell **celllist)
 		    }
                     // Create the related pin
                     testpin = parse_pin(newcell, token);
+		    // A latch data input keeps its setup and hold tables, so
+		    // its arc to the latch output (which is not used) is
+		    // read into a placeholder.
+		    if (testpin->type & LATCHIN) testpin = &latcharc;
 		    // Copy any records from the placeholder
 		    testpin->sense = proxypin.sense;
                     testpin->propdelr = proxypin.propdelr;
@@ -2837,20 +3063,202 @@ libertyRead(FILE *flib, lutable **tablelist, cell **celllist)
         }
         token = advancetoken(flib, 0);
     }
+
+libdone:
+    if (libname != NULL) free(libname);
+    free(busformat);
+    while (buses != NULL) {
+	newbus = buses;
+	buses = buses->next;
+	free(newbus->name);
+	free(newbus);
+    }
+    return status;
 }
 
 /*--------------------------------------------------------------*/
-/* Read a verilog netlist and collect information about the     */
-/* cells instantiated and the network structure                 */
+/* Index the liberty cells by name, so that binding a large	*/
+/* netlist to the library does not search the cell list for	*/
+/* every instance.  Cell names are compared without regard to	*/
+/* case.  Cells with many pins (large macros and buses) also get	*/
+/* an index of their pins.					*/
+/*--------------------------------------------------------------*/
+
+#define PIN_HASH_MIN	8	/* Cells with fewer pins are searched */
+
+void
+cellIndexBuild(cell *cells, struct hashtable *Cellhash)
+{
+    cellptr testcell;
+    pinptr testpin;
+    int numpins;
+
+    InitializeHashTable(Cellhash, SMALLHASHSIZE);
+
+    for (testcell = cells; testcell; testcell = testcell->next) {
+	HashNoCasePtrInstall(testcell->name, testcell, Cellhash);
+
+	if (testcell->pinhash != NULL) continue;
+	numpins = 0;
+	for (testpin = testcell->pins; testpin; testpin = testpin->next)
+	    numpins++;
+	if (numpins < PIN_HASH_MIN) continue;
+
+	testcell->pinhash = (struct hashtable *)malloc(sizeof(struct hashtable));
+	InitializeHashTable(testcell->pinhash, numpins | 1);
+	for (testpin = testcell->pins; testpin; testpin = testpin->next)
+	    if (HashLookup(testpin->name, testcell->pinhash) == NULL)
+		HashPtrInstall(testpin->name, testpin, testcell->pinhash);
+    }
+}
+
+/*--------------------------------------------------------------*/
+/* Find a cell by name in the index made by cellIndexBuild()	*/
+/*--------------------------------------------------------------*/
+
+cellptr
+cellFind(struct hashtable *Cellhash, char *name)
+{
+    return (cellptr)HashNoCaseLookup(name, Cellhash);
+}
+
+/*--------------------------------------------------------------*/
+/* Find a pin of a cell by name					*/
+/*--------------------------------------------------------------*/
+
+pinptr
+pinFind(cellptr testcell, char *name)
+{
+    pinptr testpin;
+
+    if (testcell->pinhash != NULL)
+	return (pinptr)HashLookup(name, testcell->pinhash);
+
+    for (testpin = testcell->pins; testpin; testpin = testpin->next)
+	if (!strcmp(testpin->name, name))
+	    break;
+    return testpin;
+}
+
+/*--------------------------------------------------------------*/
+/* Free a lookup table						*/
+/*--------------------------------------------------------------*/
+
+static void
+table_free(lutable *tableptr)
+{
+    if (tableptr->name) free(tableptr->name);
+    if (tableptr->idx1.times) free(tableptr->idx1.times);
+    if (tableptr->idx2.caps) free(tableptr->idx2.caps);
+    if (tableptr->values) free(tableptr->values);
+    free(tableptr);
+}
+
+/*--------------------------------------------------------------*/
+/* Generate the table template for the "scalar" case, which	*/
+/* ends the table list of each corner.				*/
+/*--------------------------------------------------------------*/
+
+static lutable *
+scalar_table(void)
+{
+    lutable *scalar;
+
+    scalar = (lutable *)malloc(sizeof(lutable));
+    scalar->name = strdup("scalar");
+    scalar->invert = 0;
+    scalar->var1 = CONSTRAINED_TIME;
+    scalar->var2 = OUTPUT_CAP;
+    scalar->size1 = 1;
+    scalar->size2 = 1;
+    scalar->idx1.times = (double *)malloc(sizeof(double));
+    scalar->idx2.caps = (double *)malloc(sizeof(double));
+    scalar->values = (double *)malloc(sizeof(double));
+
+    scalar->idx1.times[0] = 0.0;
+    scalar->idx2.caps[0] = 0.0;
+    scalar->values[0] = 0.0;
+
+    scalar->next = NULL;
+    return scalar;
+}
+
+/*--------------------------------------------------------------*/
+/* Free the liberty database of a corner, and the corner.	*/
+/* The pins of a bus share the tables of the first pin of the	*/
+/* bus (see expand_buses), so a table is freed only with the	*/
+/* last pin of the cell that refers to it.  The cell index	*/
+/* "Cellhash" is not freed here (see VestaRun).			*/
+/*--------------------------------------------------------------*/
+
+static void
+cornerFree(corner *cornerptr)
+{
+    lutable *tableptr, *reftables[4];
+    cell *testcell;
+    pin *testpin, *prevpin;
+    int j, k;
+
+    while (cornerptr->tables != NULL) {
+	tableptr = cornerptr->tables;
+	cornerptr->tables = tableptr->next;
+	table_free(tableptr);
+    }
+
+    while (cornerptr->cells != NULL) {
+	testcell = cornerptr->cells;
+	cornerptr->cells = testcell->next;
+	while (testcell->pins != NULL) {
+	    testpin = testcell->pins;
+	    testcell->pins = testpin->next;
+	    reftables[0] = testpin->propdelr;
+	    reftables[1] = testpin->propdelf;
+	    reftables[2] = testpin->transr;
+	    reftables[3] = testpin->transf;
+	    for (j = 0; j < 4; j++) {
+		if (reftables[j] == NULL) continue;
+		for (k = 0; k < j; k++)
+		    if (reftables[k] == reftables[j]) break;
+		if (k < j) continue;
+		for (prevpin = testcell->pins; prevpin; prevpin = prevpin->next)
+		    if ((prevpin->propdelr == reftables[j]) ||
+				(prevpin->propdelf == reftables[j]) ||
+				(prevpin->transr == reftables[j]) ||
+				(prevpin->transf == reftables[j]))
+			break;
+		if (prevpin == NULL) table_free(reftables[j]);
+	    }
+	    free(testpin->name);
+	    free(testpin);
+	}
+	if (testcell->pinhash != NULL) {
+	    HashKill(testcell->pinhash);
+	    free(testcell->pinhash);
+	}
+	if (testcell->function) free(testcell->function);
+	free(testcell->name);
+	free(testcell);
+    }
+    free(cornerptr->name);
+    free(cornerptr);
+}
+
+/*--------------------------------------------------------------*/
+/* Collect information about the cells instantiated and the	*/
+/* network structure from a netlist read by ReadVerilog().	*/
+/* All names are copied.  If "consume" is set, each instance	*/
+/* of the netlist is freed as soon as it has been converted,	*/
+/* so that both copies of the netlist are never in memory at	*/
+/* once;  otherwise the netlist is not modified.		*/
 /*--------------------------------------------------------------*/
 
 void
-verilogRead(char *filename, cell *cells, net **netlist, instance **instlist,
-                connect **inputlist, connect **outputlist, struct hashtable *Nethash)
+verilogBuild(struct cellrec *topcell, struct hashtable *Cellhash, net **netlist,
+		instance **instlist, connect **inputlist, connect **outputlist,
+		struct hashtable *Nethash, char consume)
 {
     struct portrec  *port;
-    struct instance *inst;
-    struct cellrec  *topcell;
+    struct instance *inst, *nextinst;
     struct netrec   *net;
 
     connptr newconn, testconn;
@@ -2861,8 +3269,6 @@ verilogRead(char *filename, cell *cells, net **netlist, instance **instlist,
 
     int vstart, vtarget;
 
-    /* Get verilog netlist structure using routines in readverilog.c */
-    topcell = ReadVerilog(filename);
     if (topcell && topcell->name) {
 	fprintf(stdout, "Parsing module \"%s\"\n", topcell->name);
     }
@@ -2892,6 +3298,10 @@ verilogRead(char *filename, cell *cells, net **netlist, instance **instlist,
 	    testconn->pfvector = NULL;
 	    testconn->trvector = NULL;
 	    testconn->tfvector = NULL;
+	    testconn->corners = NULL;
+	    testconn->domains = 0;
+	    testconn->exthru = 0;
+	    testconn->exto = 0;
 
             if (port->direction == PORT_INPUT) {    // driver (input)
 		testconn->next = *inputlist;
@@ -2925,6 +3335,10 @@ verilogRead(char *filename, cell *cells, net **netlist, instance **instlist,
 		testconn->pfvector = NULL;
 		testconn->trvector = NULL;
 		testconn->tfvector = NULL;
+		testconn->corners = NULL;
+		testconn->domains = 0;
+		testconn->exthru = 0;
+		testconn->exto = 0;
 
 		if (port->direction == PORT_INPUT) {    // driver (input)
 		    testconn->next = *inputlist;
@@ -2938,10 +3352,11 @@ verilogRead(char *filename, cell *cells, net **netlist, instance **instlist,
 	}
     }
 
-    for (inst = topcell->instlist; inst; inst = inst->next) {
-        for (testcell = cells; testcell; testcell = testcell->next)
-            if (!strcasecmp(testcell->name, inst->cellname))
-                break;
+    for (inst = topcell->instlist; inst; inst = nextinst) {
+	nextinst = inst->next;
+	if (consume) topcell->instlist = nextinst;
+
+        testcell = cellFind(Cellhash, inst->cellname);
 
 	// NOTE:  testcell may be NULL for non-functional cells like
 	// filler cells which have no I/O and so have no timing.  Only
@@ -2951,6 +3366,7 @@ verilogRead(char *filename, cell *cells, net **netlist, instance **instlist,
         if ((testcell == NULL) && (inst->portlist != NULL)) {
 	    fprintf(stderr, "Cell \"%s\" was not in the liberty database!\n",
 		    inst->cellname);
+	    if (consume) FreeInstance(inst);
 	    continue;
 	}
 
@@ -2960,14 +3376,14 @@ verilogRead(char *filename, cell *cells, net **netlist, instance **instlist,
         newinst->refcell = testcell;
         newinst->in_connects = NULL;
         newinst->out_connects = NULL;
+        newinst->domain = 0;
+        newinst->edge = RISING;
+        newinst->borrow = 0.0;
         newinst->name = tokendup(inst->instname);
 
 	for (port = inst->portlist; port; port = port->next) {
             newconn = (connptr)malloc(sizeof(connect));
-            for (testpin = testcell->pins; testpin; testpin = testpin->next) {
-                if (!strcmp(testpin->name, port->name))
-                    break;
-            }
+            testpin = pinFind(testcell, port->name);
             // Sanity check
             if (testpin == NULL) {
                 fprintf(stderr, "No such pin \"%s\" in cell \"%s\"!\n",
@@ -2994,6 +3410,10 @@ verilogRead(char *filename, cell *cells, net **netlist, instance **instlist,
             newconn->pfvector = NULL;
             newconn->trvector = NULL;
             newconn->tfvector = NULL;
+            newconn->corners = NULL;
+            newconn->domains = 0;
+            newconn->exthru = 0;
+            newconn->exto = 0;
 
             testnet = (netptr)HashLookup(port->net, Nethash);
             if (testnet == NULL) {
@@ -3006,71 +3426,265 @@ verilogRead(char *filename, cell *cells, net **netlist, instance **instlist,
             else
                 newconn->refnet = testnet;
 	}
+	if (consume) FreeInstance(inst);
     }
+    if (consume) topcell->lastinst = NULL;
+}
+
+/*--------------------------------------------------------------*/
+/* Read a verilog netlist and collect information about the     */
+/* cells instantiated and the network structure                 */
+/*--------------------------------------------------------------*/
+
+void
+verilogRead(char *filename, struct hashtable *Cellhash, net **netlist,
+		instance **instlist, connect **inputlist, connect **outputlist,
+		struct hashtable *Nethash)
+{
+    struct cellrec  *topcell;
+
+    /* Get verilog netlist structure using routines in readverilog.c */
+    topcell = ReadVerilog(filename);
+    verilogBuild(topcell, Cellhash, netlist, instlist, inputlist, outputlist,
+		Nethash, lowmem);
     FreeVerilog(topcell);   // All structures transferred
 }
 
 /*--------------------------------------------------------------*/
-/* For each net, go through the list of receivers and add the   */
-/* contributions of each to the total load.  This is either     */
-/* the input pin capacitance, if the receiver is a pin, or the  */
-/* designated output load (given on the command line), if the   */
-/* receiver is an output pin.                                   */
+/* Bind the input connections of each instance to the pins of	*/
+/* the same cell in the liberty data of each additional corner	*/
+/* (corner 0 is the one the netlist was read against).  Where a	*/
+/* corner has no such cell or pin, the corner 0 pin is used.	*/
 /*--------------------------------------------------------------*/
 
 void
-computeLoads(netptr netlist, instptr instlist, double out_load)
+cornerBind(instptr instlist, corner *corners, int numcorners)
 {
     instptr testinst;
-    pinptr testpin;
-    netptr testnet, driver, loadnet;
     connptr testconn;
-    int i;
-
-    for (testnet = netlist; testnet; testnet = testnet->next) {
-        for (i = 0; i < testnet->fanout; i++) {
-            testconn = testnet->receivers[i];
-            testpin = testconn->refpin;
-            if (testpin == NULL) {
-                testnet->loadr += out_load;
-                testnet->loadf += out_load;
-            }
-            else {
-                testnet->loadr += testpin->capr;
-                testnet->loadf += testpin->capf;
-            }
-        }
-    }
-
-    // For each instance input pin, collapse the pin's lookup table
-    // to a vector by interpolating/extrapolating the table at the
-    // calculated output load.  Save this vector in the connection
-    // record for the pin.
+    cornerptr testcorner;
+    cellptr testcell;
+    pinptr testpin;
+    struct hashtable Missing;
+    int k;
 
     for (testinst = instlist; testinst; testinst = testinst->next) {
-	double loadr, loadf;
-	if (testinst->out_connects != NULL) {
-	    loadnet = testinst->out_connects->refnet;
-	    loadr = loadnet->loadr;
-	    loadf = loadnet->loadf;
+	for (testconn = testinst->in_connects; testconn; testconn = testconn->next) {
+	    testconn->corners = (cornerdata *)calloc(numcorners, sizeof(cornerdata));
+	    for (k = 0; k < numcorners; k++)
+		testconn->corners[k].refpin = testconn->refpin;
 	}
-	else {
-	    loadr = 0.0;
-	    loadf = 0.0;
+    }
+
+    for (k = 1, testcorner = corners->next; testcorner;
+		k++, testcorner = testcorner->next) {
+	InitializeHashTable(&Missing, SMALLHASHSIZE);
+	for (testinst = instlist; testinst; testinst = testinst->next) {
+	    if (testinst->refcell == NULL) continue;
+	    testcell = cellFind(&testcorner->Cellhash, testinst->refcell->name);
+	    if (testcell == NULL) {
+		if (HashLookup(testinst->refcell->name, &Missing) == NULL) {
+		    fprintf(stderr, "Cell \"%s\" was not in the liberty database "
+				"of corner \"%s\"!\n", testinst->refcell->name,
+				testcorner->name);
+		    HashPtrInstall(testinst->refcell->name, testinst, &Missing);
+		}
+		continue;
+	    }
+	    for (testconn = testinst->in_connects; testconn; testconn = testconn->next) {
+		if (testconn->refpin == NULL) continue;
+		testpin = pinFind(testcell, testconn->refpin->name);
+		if (testpin != NULL) testconn->corners[k].refpin = testpin;
+	    }
 	}
-	     
-	for (testconn = testinst->in_connects; testconn; testconn = testconn->next) {
-	    testpin = testconn->refpin;
-
-            if (testpin->propdelr)
-                testconn->prvector = table_collapse(testpin->propdelr, loadr);
-            if (testpin->propdelf)
-                testconn->pfvector = table_collapse(testpin->propdelf, loadf);
-            if (testpin->transr)
-                testconn->trvector = table_collapse(testpin->transr, loadr);
-            if (testpin->transf)
-                testconn->tfvector = table_collapse(testpin->transf, loadf);
-        }
+	HashKill(&Missing);
+    }
+}
+
+/*--------------------------------------------------------------*/
+/* Make corner "k" the corner used by the timing analysis, by	*/
+/* copying its pins and vectors into the input connections.	*/
+/*--------------------------------------------------------------*/
+
+void
+cornerSelect(instptr instlist, int k)
+{
+    instptr testinst;
+    connptr testconn;
+    cornerdata *cdata;
+
+    for (testinst = instlist; testinst; testinst = testinst->next) {
+	for (testconn = testinst->in_connects; testconn; testconn = testconn->next) {
+	    if (testconn->corners == NULL) continue;
+	    cdata = &testconn->corners[k];
+	    testconn->refpin = cdata->refpin;
+	    testconn->prvector = cdata->prvector;
+	    testconn->pfvector = cdata->pfvector;
+	    testconn->trvector = cdata->trvector;
+	    testconn->tfvector = cdata->tfvector;
+	}
+    }
+}
+
+/*--------------------------------------------------------------*/
+/* Collapse the tables of pin "testpin" at the loads "loadr"	*/
+/* and "loadf" into the vectors of "cdata".  If "pool" is not	*/
+/* NULL, then pins of the same cell driving the same load	*/
+/* share one set of vectors, recorded in the hash table "pool"	*/
+/* (used in low-memory mode, see computeLoads).			*/
+/*--------------------------------------------------------------*/
+
+void
+pinCollapse(pinptr testpin, double loadr, double loadf, cornerdata *cdata,
+		struct hashtable *pool)
+{
+    char key[80];
+    cornerdata *shared;
+
+    if (pool != NULL) {
+	sprintf(key, "%p %a %a", (void *)testpin, loadr, loadf);
+	shared = (cornerdata *)HashLookup(key, pool);
+	if (shared != NULL) {
+	    *cdata = *shared;
+	    return;
+	}
+    }
+
+    cdata->refpin = testpin;
+    if (testpin->propdelr)
+	cdata->prvector = table_collapse(testpin->propdelr, loadr);
+    if (testpin->propdelf)
+	cdata->pfvector = table_collapse(testpin->propdelf, loadf);
+    if (testpin->transr)
+	cdata->trvector = table_collapse(testpin->transr, loadr);
+    if (testpin->transf)
+	cdata->tfvector = table_collapse(testpin->transf, loadf);
+
+    if (pool != NULL) {
+	shared = (cornerdata *)malloc(sizeof(cornerdata));
+	*shared = *cdata;
+	HashPtrInstall(key, shared, pool);
+    }
+}
+
+/* Free a shared vector record of "pool" (see pinCollapse) */
+
+int freeshared(struct hashlist *p)
+{
+    free(p->ptr);
+    return 1;
+}
+
+/*--------------------------------------------------------------*/
+/* For each net, go through the list of receivers and add the   */
+/* contributions of each to the total load.  This is either     */
+/* the input pin capacitance, if the receiver is a pin, or the  */
+/* designated output load (given on the command line), if the   */
+/* receiver is an output pin.                                   */
+/*								*/
+/* With more than one corner (see cornerBind), the tables of	*/
+/* each corner are also collapsed at that corner's load, which	*/
+/* differs from the corner 0 load by the difference of the	*/
+/* receivers' pin capacitances.					*/
+/*								*/
+/* In low-memory mode, vectors of the same pin and load are	*/
+/* shared (see pinCollapse).					*/
+/*--------------------------------------------------------------*/
+
+void
+computeLoads(netptr netlist, instptr instlist, double out_load, int numcorners)
+{
+    instptr testinst;
+    pinptr testpin;
+    netptr testnet, driver, loadnet;
+    connptr testconn, rcvr;
+    cornerdata *cdata, cbase;
+    struct hashtable Vectorhash, *pool;
+    int i, k;
+
+    if (lowmem) {
+	/* Size the index to the netlist, as most pins share vectors */
+	for (i = 0, testinst = instlist; testinst; testinst = testinst->next) i++;
+	InitializeHashTable(&Vectorhash, (i > LARGEHASHSIZE) ? i : LARGEHASHSIZE);
+	pool = &Vectorhash;
+    }
+    else
+	pool = NULL;
+
+    for (testnet = netlist; testnet; testnet = testnet->next) {
+        for (i = 0; i < testnet->fanout; i++) {
+            testconn = testnet->receivers[i];
+            testpin = testconn->refpin;
+            if (testpin == NULL) {
+                testnet->loadr += out_load;
+                testnet->loadf += out_load;
+            }
+            else {
+                testnet->loadr += testpin->capr;
+                testnet->loadf += testpin->capf;
+            }
+        }
+    }
+
+    // For each instance input pin, collapse the pin's lookup table
+    // to a vector by interpolating/extrapolating the table at the
+    // calculated output load.  Save this vector in the connection
+    // record for the pin.
+
+    for (testinst = instlist; testinst; testinst = testinst->next) {
+	double loadr, loadf, cloadr, cloadf;
+	if (testinst->out_connects != NULL) {
+	    loadnet = testinst->out_connects->refnet;
+	    loadr = loadnet->loadr;
+	    loadf = loadnet->loadf;
+	}
+	else {
+	    loadnet = NULL;
+	    loadr = 0.0;
+	    loadf = 0.0;
+	}
+	     
+	for (testconn = testinst->in_connects; testconn; testconn = testconn->next) {
+	    memset(&cbase, 0, sizeof(cornerdata));
+	    pinCollapse(testconn->refpin, loadr, loadf, &cbase, pool);
+	    testconn->prvector = cbase.prvector;
+	    testconn->pfvector = cbase.pfvector;
+	    testconn->trvector = cbase.trvector;
+	    testconn->tfvector = cbase.tfvector;
+        }
+
+	if (numcorners < 2) continue;
+
+	for (k = 0; k < numcorners; k++) {
+	    cloadr = loadr;
+	    cloadf = loadf;
+	    if ((k > 0) && (loadnet != NULL)) {
+		for (i = 0; i < loadnet->fanout; i++) {
+		    rcvr = loadnet->receivers[i];
+		    if ((rcvr->corners == NULL) || (rcvr->refpin == NULL)) continue;
+		    testpin = rcvr->corners[k].refpin;
+		    cloadr += testpin->capr - rcvr->refpin->capr;
+		    cloadf += testpin->capf - rcvr->refpin->capf;
+		}
+	    }
+	    for (testconn = testinst->in_connects; testconn; testconn = testconn->next) {
+		cdata = &testconn->corners[k];
+		if (k == 0) {
+		    cdata->prvector = testconn->prvector;
+		    cdata->pfvector = testconn->pfvector;
+		    cdata->trvector = testconn->trvector;
+		    cdata->tfvector = testconn->tfvector;
+		    continue;
+		}
+		pinCollapse(cdata->refpin, cloadr, cloadf, cdata, pool);
+	    }
+	}
+    }
+
+    /* The vectors stay in use;  only the index is freed */
+    if (pool) {
+	RecurseHashTable(pool, freeshared);
+	HashKill(pool);
     }
 }
 
@@ -3080,7 +3694,8 @@ computeLoads(netptr netlist, instptr instlist, double out_load)
 /* asynchronous set/reset inputs,.                              */
 /*                                                              */
 /* Whenever a clock input to a flop is found, add the           */
-/* connection record to clockedlist                             */
+/* connection record to clockedlist.  In latch mode, do the	*/
+/* same for each enable input to a latch.			*/
 /*                                                              */
 /* For diagnostics, return the number of entries in clockedlist */
 /*--------------------------------------------------------------*/
@@ -3125,6 +3740,13 @@ int assign_net_types(netptr netlist, connlistptr *clockedlist)
                         break;
                     case LATCHEN:
                         testnet->type |= ENABLE;
+                        if (latchmode) {
+                            newclocked = (connlistptr)malloc(sizeof(connlist));
+                            newclocked->connection = testrcvr;
+                            newclocked->next = *clockedlist;
+                            *clockedlist = newclocked;
+                            numterms++;
+                        }
                         break;
                 }
             }
@@ -3206,6 +3828,117 @@ createLinks(netptr netlist, instptr instlist, connptr inputlist, connptr outputl
     }
 }
 
+/*--------------------------------------------------------------*/
+/* Free the netlist database built by verilogBuild() and	*/
+/* createLinks().  In low-memory mode, the input connections	*/
+/* share vectors (see pinCollapse), so each vector is recorded	*/
+/* in a hash table as it is freed and is freed only once.	*/
+/*--------------------------------------------------------------*/
+
+static void
+vector_free(double *vector, struct hashtable *freed)
+{
+    char key[32];
+
+    if (vector == NULL) return;
+    if (freed != NULL) {
+	sprintf(key, "%p", (void *)vector);
+	if (HashLookup(key, freed) != NULL) return;
+	HashPtrInstall(key, vector, freed);
+    }
+    free(vector);
+}
+
+static void
+netlistFree(netptr netlist, instptr instlist, connptr inputlist,
+		connptr outputlist, int numcorners)
+{
+    netptr testnet;
+    instptr testinst;
+    connptr testconn;
+    cornerdata *cdata;
+    struct hashtable Freed, *freed;
+    int k;
+
+    if (lowmem) {
+	InitializeHashTable(&Freed, LARGEHASHSIZE);
+	freed = &Freed;
+    }
+    else
+	freed = NULL;
+
+    while (instlist != NULL) {
+	testinst = instlist;
+	instlist = testinst->next;
+	while (testinst->in_connects != NULL) {
+	    testconn = testinst->in_connects;
+	    testinst->in_connects = testconn->next;
+	    if (testconn->corners != NULL) {
+		/* Corner 0 holds the connection's own vectors */
+		for (k = 0; k < numcorners; k++) {
+		    cdata = &testconn->corners[k];
+		    vector_free(cdata->prvector, freed);
+		    vector_free(cdata->pfvector, freed);
+		    vector_free(cdata->trvector, freed);
+		    vector_free(cdata->tfvector, freed);
+		}
+		free(testconn->corners);
+	    }
+	    else {
+		vector_free(testconn->prvector, freed);
+		vector_free(testconn->pfvector, freed);
+		vector_free(testconn->trvector, freed);
+		vector_free(testconn->tfvector, freed);
+	    }
+	    free(testconn);
+	}
+	while (testinst->out_connects != NULL) {
+	    testconn = testinst->out_connects;
+	    testinst->out_connects = testconn->next;
+	    free(testconn);
+	}
+	free(testinst->name);
+	free(testinst);
+    }
+
+    while (inputlist != NULL) {
+	testconn = inputlist;
+	inputlist = testconn->next;
+	free(testconn);
+    }
+    while (outputlist != NULL) {
+	testconn = outputlist;
+	outputlist = testconn->next;
+	free(testconn);
+    }
+
+    while (netlist != NULL) {
+	testnet = netlist;
+	netlist = testnet->next;
+	if (testnet->receivers) free(testnet->receivers);
+	free(testnet->name);
+	free(testnet);
+    }
+
+    if (freed != NULL) HashKill(freed);
+}
+
+/*--------------------------------------------------------------*/
+/* Free a list of connection pointers				*/
+/*--------------------------------------------------------------*/
+
+static void
+connlistFree(connlistptr clist)
+{
+    connlistptr nextc;
+
+    while (clist != NULL) {
+	nextc = clist->next;
+	free(clist);
+	clist = nextc;
+    }
+}
+
 /*--------------------------------------------------------------*/
 /* Delay comparison used by qsort() to sort paths in order from */
 /* longest to shortest propagation delay.                       */
@@ -3217,173 +3950,321 @@ compdelay(ddataptr *a, ddataptr *b)
     ddataptr p = *a;
     ddataptr q = *b;
 
-    if (p->delay < q->delay)
+    // Paths are ordered by the delay in excess of the required time,
+    // which is the same as ordering by delay unless paths have clock
+    // constraints.
+
+    if ((p->delay - p->required) < (q->delay - q->required))
         return (1);
-    if (p->delay > q->delay)
+    if ((p->delay - p->required) > (q->delay - q->required))
         return (-1);
     return (0);
 }
 
-void
-delayRead(FILE *fdly, struct hashtable *Nethash)
+/*--------------------------------------------------------------*/
+/* Read one line of the delay file into "*line", which is grown	*/
+/* as needed so that there is no limit on the line length.  The	*/
+/* trailing newline and whitespace are removed.  Return the	*/
+/* line, or NULL at the end of the file.			*/
+/*--------------------------------------------------------------*/
+
+static char *
+delayReadLine(FILE *fdly, char **line, int *linesize)
 {
-    char c[128];
-    char d[128];
-    char *token;
-    char *result;
-    char *tokencopy = NULL;
+    int len = 0;
+    char *lptr;
 
-    netptr newnet, testnet;
+    if (*line == NULL) {
+	*linesize = 1024;
+	*line = (char *)malloc(*linesize);
+    }
+
+    while (1) {
+	if (fgets(*line + len, *linesize - len, fdly) == NULL) {
+	    if (len == 0) return NULL;
+	    break;
+	}
+	len += strlen(*line + len);
+	if ((len > 0) && ((*line)[len - 1] == '\n')) break;
+	if (len < *linesize - 1) break;		/* Last line, no newline */
+	*linesize <<= 1;
+	*line = (char *)realloc(*line, *linesize);
+    }
+    fileCurrentLine++;
+
+    lptr = *line + len;
+    while ((lptr > *line) && isspace(*(lptr - 1))) lptr--;
+    *lptr = '\0';
+    return *line;
+}
+
+/*--------------------------------------------------------------*/
+/* Find the receiver of "testnet" named in a delay file line.	*/
+/* "rxname" is "<instance>/<pin>", or "PIN/<name>" for a module	*/
+/* output.  "Rxhash" is an index of the net's receivers by	*/
+/* name, or NULL if the net has few enough receivers to search.	*/
+/* If no receiver has the instance and pin name, the first	*/
+/* receiver on the instance is used.				*/
+/*--------------------------------------------------------------*/
+
+static connptr
+delayFindReceiver(netptr testnet, char *rxname, struct hashtable *Rxhash)
+{
     connptr testconn;
-    pinptr testpin;
+    char *pinname;
     int i;
-    int numRxers;
 
-    if (debug == 1)
-	fprintf(stdout, "delayRead\n");
+    pinname = strrchr(rxname, '/');
+    if (pinname == NULL) return NULL;
 
-    /* NOTE:  Do not use 0 for delimiter, or else ':' is considered to	*/
-    /* be a standard delimiter, breaking up certain yosys-generated	*/
-    /* net names.							*/
-    
-    token = advancetokennocont(fdly, '\n');
-    result = token;
+    if (!strncmp(rxname, "PIN/", 4)) {
+	for (i = 0; i < testnet->fanout; i++)
+	    if (testnet->receivers[i]->refinst == NULL)
+		return testnet->receivers[i];
+	return NULL;
+    }
 
-    while (token != NULL) {
+    if (Rxhash != NULL) {
+	testconn = (connptr)HashLookup(rxname, Rxhash);
+	if (testconn != NULL) return testconn;
+    }
 
-        char *saveptr;
-        char *saveptr2;
-
-        numRxers = 0;
-        testnet = (netptr)HashLookup(token, Nethash);
-
-	/* Syntax cleanup for net renaming between various	*/
-	/* netlist formats.					*/
-
-	if ((testnet == NULL) && cleanup) {
-	    char *mchr, *dchr;
-	    /* Handle the insane backslash-escape names in verilog.
-	     * To make these compatible with SPICE, qflow opts to
-	     * replace the ending space character with another
-	     * backslash.  The 2nd backslash has to be replaced by
-	     * the original space character to match the original
-	     * verilog net name.
-	     */
-	    
-	    if (*token == '\\') {
-	        if ((mchr = strchr(token + 1, '\\')) != NULL) {
-		    dchr = strchr(token + 1, ' ');
-		    if ((dchr == NULL) || (dchr > mchr)) *mchr = ' ';
-		}
+    *pinname = '\0';
+    testconn = NULL;
+    if (Rxhash == NULL) {
+	for (i = 0; i < testnet->fanout; i++) {
+	    connptr rxconn = testnet->receivers[i];
+	    if ((rxconn->refinst == NULL) || (rxconn->refpin == NULL)) continue;
+	    if (!strcmp(rxconn->refinst->name, rxname) &&
+			!strcmp(rxconn->refpin->name, pinname + 1)) {
+		testconn = rxconn;
+		break;
 	    }
-	    testnet = (netptr)HashLookup(token, Nethash);
+	}
+    }
+    if (testconn == NULL) {
+	for (i = 0; i < testnet->fanout; i++) {
+	    connptr rxconn = testnet->receivers[i];
+	    if ((rxconn->refinst != NULL) && !strcmp(rxconn->refinst->name, rxname)) {
+		testconn = rxconn;
+		break;
+	    }
+	}
+    }
+    *pinname = '/';
+    return testconn;
+}
 
-	    /* Other, legacy stuff. */
-	    if (testnet == NULL) {
-		tokencopy = strdup(token);
-		if ((mchr = strrchr(tokencopy, '<')) != NULL) {
-		    if ((dchr = strrchr(tokencopy, '>')) != NULL) {
-			if (mchr < dchr) {
-			    *mchr = '[';
-			    *dchr = ']';
-			}
+/*--------------------------------------------------------------*/
+/* Find the net named "token" in a delay or SPEF file.  With	*/
+/* the cleanup option, net names that do not match are		*/
+/* translated to the syntax used in the verilog netlist.	*/
+/* "token" may be modified.  Return NULL if the net is not	*/
+/* found.							*/
+/*--------------------------------------------------------------*/
+
+static netptr
+delayFindNet(char *token, struct hashtable *Nethash)
+{
+    netptr testnet;
+    char *tokencopy = NULL;
+
+    testnet = (netptr)HashLookup(token, Nethash);
+
+    /* Syntax cleanup for net renaming between various	*/
+    /* netlist formats.					*/
+
+    if ((testnet == NULL) && cleanup) {
+	char *mchr, *dchr;
+	/* Handle the insane backslash-escape names in verilog.
+	 * To make these compatible with SPICE, qflow opts to
+	 * replace the ending space character with another
+	 * backslash.  The 2nd backslash has to be replaced by
+	 * the original space character to match the original
+	 * verilog net name.
+	 */
+
+	if (*token == '\\') {
+	    if ((mchr = strchr(token + 1, '\\')) != NULL) {
+		dchr = strchr(token + 1, ' ');
+		if ((dchr == NULL) || (dchr > mchr)) *mchr = ' ';
+	    }
+	}
+	testnet = (netptr)HashLookup(token, Nethash);
+
+	/* Other, legacy stuff. */
+	if (testnet == NULL) {
+	    tokencopy = strdup(token);
+	    if ((mchr = strrchr(tokencopy, '<')) != NULL) {
+		if ((dchr = strrchr(tokencopy, '>')) != NULL) {
+		    if (mchr < dchr) {
+			*mchr = '[';
+			*dchr = ']';
 		    }
 		}
-		testnet = (netptr)HashLookup(tokencopy, Nethash);
 	    }
+	    testnet = (netptr)HashLookup(tokencopy, Nethash);
+	}
 
-	    if (testnet == NULL) {
-		for (mchr = tokencopy; *mchr != '\0'; mchr++) {
-		    if ((*mchr == ':') || (*mchr == '.') || (*mchr == '$')
-				|| (*mchr == '<') || (*mchr == '>'))
-			*mchr = '_';
-		}
-		testnet = (netptr)HashLookup(tokencopy, Nethash);
+	if (testnet == NULL) {
+	    for (mchr = tokencopy; *mchr != '\0'; mchr++) {
+		if ((*mchr == ':') || (*mchr == '.') || (*mchr == '$')
+			|| (*mchr == '<') || (*mchr == '>'))
+		    *mchr = '_';
 	    }
+	    testnet = (netptr)HashLookup(tokencopy, Nethash);
+	}
 
-	    if (testnet == NULL) {
-		for (mchr = tokencopy; *mchr != '\0'; mchr++) {
-		    if ((*mchr == '[') || (*mchr == ']'))
-			*mchr = '_';
-		}
-		testnet = (netptr)HashLookup(tokencopy, Nethash);
+	if (testnet == NULL) {
+	    for (mchr = tokencopy; *mchr != '\0'; mchr++) {
+		if ((*mchr == '[') || (*mchr == ']'))
+		    *mchr = '_';
 	    }
+	    testnet = (netptr)HashLookup(tokencopy, Nethash);
+	}
+    }
+    if (tokencopy != NULL) free(tokencopy);
+    return testnet;
+}
+
+/*--------------------------------------------------------------*/
+/* Index the receivers of "testnet" by "<instance>/<pin>" name	*/
+/* in "Rxhash" for delayFindReceiver().  "key" and "keysize"	*/
+/* are a name buffer kept by the caller.			*/
+/*--------------------------------------------------------------*/
+
+static void
+delayHashReceivers(netptr testnet, struct hashtable *Rxhash, char **key,
+		int *keysize)
+{
+    connptr testconn;
+    int i, len;
+
+    InitializeHashTable(Rxhash, testnet->fanout | 1);
+    for (i = testnet->fanout - 1; i >= 0; i--) {
+	testconn = testnet->receivers[i];
+	if ((testconn->refinst == NULL) || (testconn->refpin == NULL))
+	    continue;
+	len = strlen(testconn->refinst->name) +
+		strlen(testconn->refpin->name) + 2;
+	if (len > *keysize) {
+	    *keysize = len;
+	    *key = (char *)realloc(*key, *keysize);
+	}
+	sprintf(*key, "%s/%s", testconn->refinst->name,
+		testconn->refpin->name);
+	/* Install in reverse so that the first receiver is kept */
+	HashPtrInstall(*key, testconn, Rxhash);
+    }
+}
+
+/*--------------------------------------------------------------*/
+/* Read the wiring delay file generated by rc2dly.  For each	*/
+/* net, the file has a line with the net name, a line with the	*/
+/* driver and the total load capacitance (in pF), one line per	*/
+/* receiver with the receiver and its interconnect delay (in	*/
+/* ps), and a blank line.  Returns 0 on success, 1 if the file	*/
+/* names a net that is not in the netlist.			*/
+/*--------------------------------------------------------------*/
+
+#define RX_HASH_MIN	16	/* Nets with fewer receivers are searched */
+
+int
+delayRead(FILE *fdly, struct hashtable *Nethash)
+{
+    int status = 0;
+    char *line = NULL;
+    int linesize = 0;
+    char *token;
+    char *result;
+    char *key = NULL;
+    int keysize = 0;
+    char *dptr;
+
+    netptr testnet;
+    connptr testconn;
+    struct hashtable Rxhash;
+    int numRxers;
+    int numNets = 0, totalRxers = 0;
+    struct timeval tstart, tend;
+    double elapsed;
+
+    if (debug == 1)
+	fprintf(stdout, "delayRead\n");
+
+    gettimeofday(&tstart, NULL);
+
+    /* Read through a large buffer;  delay files can be many MB */
+    setvbuf(fdly, NULL, _IOFBF, 1 << 20);
+    fileCurrentLine = 0;
+
+    while (1) {
+
+	/* Net name, skipping any blank lines */
+	while ((result = delayReadLine(fdly, &line, &linesize)) != NULL) {
+	    token = line;
+	    while (isblank(*token)) token++;
+	    if (*token != '\0') break;
 	}
-	if (tokencopy != NULL) free(tokencopy);
+	if (result == NULL) break;
 
+	numRxers = 0;
+	testnet = delayFindNet(token, Nethash);
 	if (testnet == NULL) {
 	    fprintf(stderr, "ERROR: Net %s not found in hash table\n", token);
-	    exit(-1);
+	    status = 1;
+	    break;
 	}
 
         // Read driver of interconnect and total interconnect capacitance
-        result = fgets(c, 128, fdly);
-	if (result == NULL) break;
-
-        strtok_r(c, "/", &saveptr);
-        if (debug == 1)
-            fprintf(stdout, "\tDriver Inst: %s\n", saveptr);
-        strtok_r(NULL, " ", &saveptr);
-        if (debug == 1) {
-            fprintf(stdout, "\tDriver Pin: %s\n", saveptr);
-            fprintf(stdout, "\tTotC: %f\n", strtof(saveptr, NULL));
+	result = delayReadLine(fdly, &line, &linesize);
+	if (result == NULL) {
+	    fprintf(stderr, "ERROR: Unexpected end-of-file while reading "
+			"delay file.\n");
+	    break;
 	}
 
-	if (c[1] == '\0') {
+	dptr = strrchr(line, ' ');
+	if ((strchr(line, '/') == NULL) || (dptr == NULL)) {
 	    fprintf(stderr, "ERROR: Driver not found for net %s\n", testnet->name);
+	    dptr = line;
+	}
+	if (debug == 1) {
+	    fprintf(stdout, "\tDriver: %s\n", line);
+	    fprintf(stdout, "\tTotC: %f\n", strtod(dptr, NULL));
 	}
 
         /* Load in .dly file is in pF, but we keep fF in loadr/loadf */
-        testnet->loadr = (strtod(saveptr, NULL)) * 1e3;
+        testnet->loadr = (strtod(dptr, NULL)) * 1e3;
         testnet->loadf = testnet->loadr;
 
-        result = fgets(c, 128, fdly);
-	if (result == NULL) break;
+	/* Index the receivers of nets with large fanout by name */
 
-        while (c[0] != '\n') {
-            if (debug == 1) fprintf(stdout, "\t%s\n", c);
+	if (testnet->fanout >= RX_HASH_MIN)
+	    delayHashReceivers(testnet, &Rxhash, &key, &keysize);
 
-            //separate receiver name and delay value
-            strtok_r(c, " ", &saveptr);
-	    if (debug == 1) {
-                fprintf(stdout, "\tDelay: %s\n", saveptr);
-                fprintf(stdout, "\tRxer Name: %s\n", c);
-	    }
-            strtok_r(c, "/", &saveptr2);
+	while ((result = delayReadLine(fdly, &line, &linesize)) != NULL) {
+	    if (line[0] == '\0') break;
+            if (debug == 1) fprintf(stdout, "\t%s\n", line);
+
+            // Separate receiver name and delay value
+	    dptr = strrchr(line, ' ');
+	    if (dptr != NULL) *dptr++ = '\0';
 	    if (debug == 1) {
-                fprintf(stdout, "\tRxer Name: %s\n", c);
-                fprintf(stdout, "\tRxer Name: %s\n", saveptr2);
-                fprintf(stdout, "\tDelay: %f\n", strtof(saveptr, NULL));
+                fprintf(stdout, "\tRxer Name: %s\n", line);
+                fprintf(stdout, "\tDelay: %s\n", (dptr) ? dptr : "(none)");
 	    }
 
-            for (i = 0; i < testnet->fanout; i++) {
-
-                testconn = testnet->receivers[i];
-
-                if (testnet->type == OUTTERM) {
-		    if (debug == 1)
-                        fprintf(stdout, "\tNet connects to output and has no "
-				"receiving instance pin\n");
-                    testconn->icDelay = strtod(saveptr, NULL);
-                } else {
-		    if (debug == 1)
-                        fprintf(stdout, "\trefinstname: %s\n", testconn->refinst->name);
-
-                    if (!strcmp(testconn->refinst->name, c)) {
-
-                        testconn->icDelay = strtod(saveptr, NULL);
-                        break;
-                    }
-                }
-		if (debug == 1)
-                    fprintf(stdout, "\tName: %s\n", c);
-            }
+	    testconn = delayFindReceiver(testnet, line,
+			(testnet->fanout >= RX_HASH_MIN) ? &Rxhash : NULL);
+	    if ((testconn != NULL) && (dptr != NULL))
+		testconn->icDelay = strtod(dptr, NULL);
+	    else if (debug == 1)
+		fprintf(stdout, "\tNo receiver %s\n", line);
 
-            result = fgets(c, 128, fdly);
-	    if (result == NULL) break;
             numRxers += 1;
         }
-	if (result == NULL) break;
+	if (testnet->fanout >= RX_HASH_MIN) HashKill(&Rxhash);
 
         if (numRxers != testnet->fanout) {
 	    if (numRxers != 1 || testnet->fanout > 0 || testnet->type != OUTTERM)
@@ -3392,30 +4273,830 @@ delayRead(FILE *fdly, struct hashtable *Nethash)
 			numRxers, (numRxers == 1) ? "" : "s",
 			testnet->fanout);
         }
-
-        token = advancetokennocont(fdly, '\n');
+	numNets++;
+	totalRxers += numRxers;
     }
-    if (result == NULL) {
-	fprintf(stderr, "ERROR: Unexpected end-of-file while reading delay file.\n");
+    free(line);
+    if (key != NULL) free(key);
+
+    if (verbose > 0) {
+	gettimeofday(&tend, NULL);
+	elapsed = (double)(tend.tv_sec - tstart.tv_sec) +
+		(double)(tend.tv_usec - tstart.tv_usec) * 1e-6;
+	fprintf(stdout, "Delay file read:  %d nets, %d receivers, %d lines "
+		"in %.3f s", numNets, totalRxers, fileCurrentLine, elapsed);
+	if (elapsed > 0.0)
+	    fprintf(stdout, " (%.0f nets/s)", (double)numNets / elapsed);
+	fprintf(stdout, "\n");
     }
+    return status;
 }
 
 /*--------------------------------------------------------------*/
-/* Print a path component                                       */
-/* (code contributed by Karl-Filip Faxen)			*/
+/* SPEF (IEEE 1481) parasitics reader.  This reads the detailed	*/
+/* parasitics (*D_NET) of each net directly, so that the RC	*/
+/* output of rc2dly (or of any other extractor) in SPEF format	*/
+/* can be used in place of a delay file.  Each net's RC tree is	*/
+/* reduced to an Elmore delay at each receiver, computed the	*/
+/* same way as rc2dly does for the delay file.  Nets are read	*/
+/* one at a time and forgotten when done, so memory use does	*/
+/* not depend on the size of the file.				*/
 /*--------------------------------------------------------------*/
 
-void
-print_path_component(int netFWidth, int instFWidth, int pinFWidth, int recvFWidth, 
-                     btptr backtrace, FILE *file)
-{
-    // Return immediately if we have niether a driver or a receiver instance
-    if (backtrace->receiver->refnet->driver == NULL &&
-		backtrace->receiver->refinst == NULL) return;
+/* Resistance (in ohms) modeling the driver of each net, as in rc2dly */
+#define SPEF_DRIVER_RES	1.0
+
+#define SPEF_HASH_MIN	16	/* Nets with fewer nodes are searched */
+#define SPEF_MAX_TOKENS	16	/* Tokens per line that are looked at */
+
+/* Parser states */
+#define SPEF_HEADER	0
+#define SPEF_NAMEMAP	1
+#define SPEF_SKIP	2	/* Sections not used by vesta */
+#define SPEF_CONN	3
+#define SPEF_CAP	4
+#define SPEF_RES	5
+#define SPEF_NETSKIP	6	/* Section of a net not used by vesta */
+
+typedef struct _spefnode *spefnodeptr;
+
+typedef struct _spefnode {
+    char    *name;	/* Node name as written in the SPEF file */
+    int     index;	/* Index of the node in the current net */
+    double  cap;	/* Wire capacitance to ground, in pF */
+    double  pincap;	/* Receiver pin capacitance, in pF */
+    connptr conn;	/* Receiver connection at the node, or NULL */
+    int     edges;	/* Index of first resistor in the adjacency list */
+    int     numedges;	/* Number of resistors at the node */
+    int     parent;	/* Upstream node on the path from the driver */
+    double  res;	/* Resistance to the upstream node, in ohms */
+    double  downcap;	/* Capacitance at and downstream of the node */
+    double  delay;	/* Elmore delay from the driver, in ps */
+} spefnode;
+
+typedef struct _spefres {
+    int    node1;
+    int    node2;
+    double res;		/* Resistance in ohms */
+} spefres;
+
+typedef struct _spefdata {
+    char   **namemap;	/* Names indexed by *NAME_MAP number */
+    int    mapsize;
+    char   delimiter;	/* Instance/pin delimiter (*DELIMITER) */
+    double cscale;	/* File capacitance units to pF */
+    double rscale;	/* File resistance units to ohms */
+
+    /* Current net */
+    netptr net;
+    int    driver;	/* Index of the driver node, or -1 */
+    int    numrx;	/* Number of receivers found in *CONN */
+    int    portdriver;	/* Net is driven by a module input */
+    spefnodeptr *nodes;	/* Node records, kept between nets */
+    int    numnodes;
+    int    maxnodes;
+    int    hashsize;	/* Size of Nodehash, or 0 if not used */
+    struct hashtable Nodehash;
+    spefres *res;
+    int    numres;
+    int    maxres;
+    int    *adj;	/* Resistor adjacency lists of all nodes */
+    int    *order;	/* Nodes in order of the tree walk */
+    int    maxadj;
+    int    maxorder;
+
+    /* Receiver index of the current net (see delayHashReceivers) */
+    struct hashtable Rxhash;
+    char   *key;
+    int    keysize;
+} spefdata;
 
-    fprintf(file, " %8.1f ps", backtrace->delay);
-    if (backtrace->receiver->refnet != NULL) {
-        netptr net = backtrace->receiver->refnet;
+/*--------------------------------------------------------------*/
+/* Split a SPEF line into whitespace-separated tokens, ignoring	*/
+/* "//" comments.  At most SPEF_MAX_TOKENS are returned.	*/
+/*--------------------------------------------------------------*/
+
+static int
+spefTokenize(char *line, char **tokens)
+{
+    int numtokens = 0;
+    char *lptr = line;
+
+    while (numtokens < SPEF_MAX_TOKENS) {
+	while (isspace(*lptr)) lptr++;
+	if ((*lptr == '\0') || !strncmp(lptr, "//", 2)) break;
+	tokens[numtokens++] = lptr;
+	while ((*lptr != '\0') && !isspace(*lptr)) lptr++;
+	if (*lptr == '\0') break;
+	*lptr++ = '\0';
+    }
+    return numtokens;
+}
+
+/*--------------------------------------------------------------*/
+/* Return the name for "name", which may be a *NAME_MAP index	*/
+/* ("*<number>").  The result is in "*buf" (grown as needed),	*/
+/* with SPEF escape backslashes removed except from names that	*/
+/* are verilog escaped identifiers.				*/
+/*--------------------------------------------------------------*/
+
+static char *
+spefMapName(spefdata *sd, char *name, char **buf, int *bufsize)
+{
+    char *endptr, *sptr, *dptr;
+    long idx;
+    int len;
+
+    if ((*name == '*') && isdigit(*(name + 1))) {
+	idx = strtol(name + 1, &endptr, 10);
+	if ((*endptr == '\0') && (idx < sd->mapsize) && (sd->namemap[idx] != NULL))
+	    name = sd->namemap[idx];
+    }
+
+    len = strlen(name) + 1;
+    if (len > *bufsize) {
+	*bufsize = len;
+	*buf = (char *)realloc(*buf, *bufsize);
+    }
+    if (*name == '\\') {
+	strcpy(*buf, name);
+	return *buf;
+    }
+    for (sptr = name, dptr = *buf; *sptr != '\0'; sptr++) {
+	if ((*sptr == '\\') && (*(sptr + 1) != '\0')) sptr++;
+	*dptr++ = *sptr;
+    }
+    *dptr = '\0';
+    return *buf;
+}
+
+/*--------------------------------------------------------------*/
+/* (Re)build the node index of the current net with "size"	*/
+/* hash bins.							*/
+/*--------------------------------------------------------------*/
+
+static void
+spefHashNodes(spefdata *sd, int size)
+{
+    int i;
+
+    if (sd->hashsize > 0) HashKill(&sd->Nodehash);
+    InitializeHashTable(&sd->Nodehash, size);
+    sd->hashsize = size;
+    for (i = 0; i < sd->numnodes; i++)
+	HashPtrInstall(sd->nodes[i]->name, sd->nodes[i], &sd->Nodehash);
+}
+
+/*--------------------------------------------------------------*/
+/* Find the node named "name" in the current net, creating it	*/
+/* if it does not exist.  Return the node index.		*/
+/*--------------------------------------------------------------*/
+
+static int
+spefFindNode(spefdata *sd, char *name)
+{
+    spefnodeptr node;
+    int i;
+
+    if (sd->hashsize > 0) {
+	node = (spefnodeptr)HashLookup(name, &sd->Nodehash);
+	if (node != NULL) return node->index;
+    }
+    else {
+	for (i = 0; i < sd->numnodes; i++)
+	    if (!strcmp(sd->nodes[i]->name, name))
+		return i;
+    }
+
+    if (sd->numnodes == sd->maxnodes) {
+	sd->maxnodes = (sd->maxnodes == 0) ? 64 : sd->maxnodes << 1;
+	sd->nodes = (spefnodeptr *)realloc(sd->nodes, sd->maxnodes *
+		sizeof(spefnodeptr));
+	for (i = sd->numnodes; i < sd->maxnodes; i++)
+	    sd->nodes[i] = NULL;
+    }
+    i = sd->numnodes++;
+    if (sd->nodes[i] == NULL)
+	sd->nodes[i] = (spefnodeptr)malloc(sizeof(spefnode));
+    node = sd->nodes[i];
+    node->name = strdup(name);
+    node->index = i;
+    node->cap = 0.0;
+    node->pincap = 0.0;
+    node->conn = NULL;
+    node->numedges = 0;
+
+    /* Index the nodes of large nets, growing the index with the net */
+    if (sd->numnodes > 2 * sd->hashsize) {
+	if (sd->numnodes >= SPEF_HASH_MIN)
+	    spefHashNodes(sd, (4 * sd->numnodes) | 1);
+    }
+    else
+	HashPtrInstall(node->name, node, &sd->Nodehash);
+    return i;
+}
+
+/*--------------------------------------------------------------*/
+/* Handle one *CONN entry of the current net:			*/
+/*	*P <port> <dir> [*L <cap>] ...				*/
+/*	*I <instance><delimiter><pin> <dir> [*L <cap>] ...	*/
+/* Find the netlist connection of the node:  either the net's	*/
+/* driver, or one of its receivers.				*/
+/*--------------------------------------------------------------*/
+
+static void
+spefConn(spefdata *sd, char **tokens, int numtokens, char **buf, int *bufsize)
+{
+    netptr testnet = sd->net;
+    connptr testconn, driver;
+    spefnodeptr node;
+    char *name, *pinname;
+    char portname[] = "PIN/";
+    int i, n;
+
+    n = spefFindNode(sd, tokens[1]);
+    node = sd->nodes[n];
+
+    driver = testnet->driver;
+    testconn = NULL;
+
+    if (!strcmp(tokens[0], "*P")) {
+	/* Module port.  The direction written for ports varies between	*/
+	/* extractors, so use the netlist:  the first port of a net	*/
+	/* with no driver cell (a module input) is the driver.		*/
+	if (((driver == NULL) || (driver->refinst == NULL)) &&
+			(sd->portdriver == 0)) {
+	    sd->portdriver = 1;
+	    sd->driver = n;
+	    return;
+	}
+	testconn = delayFindReceiver(testnet, portname, NULL);
+    }
+    else {
+	/* Instance pin.  The instance name may be mapped, the pin	*/
+	/* name is not.							*/
+	pinname = strrchr(tokens[1], sd->delimiter);
+	if (pinname == NULL) {
+	    fprintf(stderr, "ERROR: SPEF line %d: bad instance pin %s\n",
+			fileCurrentLine, tokens[1]);
+	    return;
+	}
+	*pinname = '\0';
+	name = spefMapName(sd, tokens[1], buf, bufsize);
+	*pinname++ = sd->delimiter;
+
+	if ((driver != NULL) && (driver->refinst != NULL) &&
+		(driver->refpin != NULL) && (sd->driver < 0) &&
+		!strcmp(driver->refinst->name, name) &&
+		!strcmp(driver->refpin->name, pinname)) {
+	    sd->driver = n;
+	    return;
+	}
+
+	/* Append "/<pin>" for delayFindReceiver() */
+	i = strlen(name);
+	if (i + strlen(pinname) + 2 > *bufsize) {
+	    *bufsize = i + strlen(pinname) + 2;
+	    *buf = (char *)realloc(*buf, *bufsize);
+	}
+	sprintf(*buf + i, "/%s", pinname);
+	testconn = delayFindReceiver(testnet, *buf,
+		(testnet->fanout >= RX_HASH_MIN) ? &sd->Rxhash : NULL);
+    }
+
+    sd->numrx++;
+    if (testconn == NULL) {
+	if (debug == 1) fprintf(stdout, "\tNo receiver %s\n", tokens[1]);
+	return;
+    }
+    node->conn = testconn;
+
+    /* Receiver pin capacitance from the SPEF file, or else from	*/
+    /* the liberty file (which is kept in fF).				*/
+    if (testconn->refpin != NULL)
+	node->pincap = testconn->refpin->capr * 1e-3;
+    for (i = 3; i < numtokens - 1; i++) {
+	if (!strcmp(tokens[i], "*L")) {
+	    node->pincap = strtod(tokens[i + 1], NULL) * sd->cscale;
+	    break;
+	}
+    }
+}
+
+/*--------------------------------------------------------------*/
+/* Finish the current net:  set the net load to the total wire	*/
+/* capacitance, and set the interconnect delay of each receiver	*/
+/* to the Elmore delay from the driver through the RC tree.	*/
+/* Then forget the net.						*/
+/*--------------------------------------------------------------*/
+
+static void
+spefNetDone(spefdata *sd)
+{
+    netptr testnet = sd->net;
+    spefnodeptr node, next;
+    spefres *res;
+    double wirecap;
+    int i, j, n, head, tail;
+
+    if (testnet == NULL) return;
+
+    wirecap = 0.0;
+    for (i = 0; i < sd->numnodes; i++)
+	wirecap += sd->nodes[i]->cap;
+
+    /* Net load is kept in fF */
+    testnet->loadr = wirecap * 1e3;
+    testnet->loadf = testnet->loadr;
+
+    if (sd->driver < 0)
+	fprintf(stderr, "ERROR: Driver not found for net %s\n", testnet->name);
+    else {
+	/* Build the resistor adjacency list of each node */
+	if (2 * sd->numres > sd->maxadj) {
+	    sd->maxadj = 2 * sd->numres;
+	    sd->adj = (int *)realloc(sd->adj, sd->maxadj * sizeof(int));
+	}
+	if (sd->numnodes > sd->maxorder) {
+	    sd->maxorder = sd->numnodes;
+	    sd->order = (int *)realloc(sd->order, sd->maxorder * sizeof(int));
+	}
+	for (i = 0, j = 0; i < sd->numnodes; i++) {
+	    node = sd->nodes[i];
+	    node->edges = j;
+	    j += node->numedges;
+	    node->numedges = 0;
+	    node->parent = -2;		/* Not yet visited */
+	}
+	for (i = 0; i < sd->numres; i++) {
+	    res = &sd->res[i];
+	    node = sd->nodes[res->node1];
+	    sd->adj[node->edges + node->numedges++] = i;
+	    node = sd->nodes[res->node2];
+	    sd->adj[node->edges + node->numedges++] = i;
+	}
+
+	/* Walk the tree breadth-first from the driver.  Any resistor	*/
+	/* closing a loop is ignored.					*/
+	head = tail = 0;
+	sd->order[tail++] = sd->driver;
+	sd->nodes[sd->driver]->parent = -1;
+	sd->nodes[sd->driver]->res = 0.0;
+	while (head < tail) {
+	    n = sd->order[head++];
+	    node = sd->nodes[n];
+	    node->downcap = node->cap + node->pincap;
+	    for (i = 0; i < node->numedges; i++) {
+		res = &sd->res[sd->adj[node->edges + i]];
+		j = (res->node1 == n) ? res->node2 : res->node1;
+		next = sd->nodes[j];
+		if (next->parent != -2) continue;
+		next->parent = n;
+		next->res = res->res;
+		sd->order[tail++] = j;
+	    }
+	}
+
+	/* Sum the capacitance downstream of each node */
+	for (i = tail - 1; i > 0; i--) {
+	    node = sd->nodes[sd->order[i]];
+	    sd->nodes[node->parent]->downcap += node->downcap;
+	}
+
+	/* Accumulate the delay along each path from the driver */
+	node = sd->nodes[sd->driver];
+	node->delay = SPEF_DRIVER_RES * node->downcap;
+	for (i = 1; i < tail; i++) {
+	    node = sd->nodes[sd->order[i]];
+	    node->delay = sd->nodes[node->parent]->delay +
+			node->res * node->downcap;
+	}
+
+	for (i = 0; i < sd->numnodes; i++) {
+	    node = sd->nodes[i];
+	    if (node->conn == NULL) continue;
+	    if (node->parent == -2) {
+		fprintf(stderr, "ERROR: Net %s receiver node %s is not "
+			"connected to the driver\n", testnet->name, node->name);
+		continue;
+	    }
+	    node->conn->icDelay = node->delay;
+	    if (debug == 1)
+		fprintf(stdout, "\t%s %f\n", node->name, node->delay);
+	}
+    }
+
+    if (sd->numrx != testnet->fanout) {
+	if (sd->numrx != 1 || testnet->fanout > 0 || testnet->type != OUTTERM)
+	    fprintf(stderr, "ERROR: Net %s had %d receiver%s in SPEF file, "
+			" but expected a fanout of %d\n", testnet->name,
+			sd->numrx, (sd->numrx == 1) ? "" : "s",
+			testnet->fanout);
+    }
+
+    /* Forget the net */
+    for (i = 0; i < sd->numnodes; i++)
+	free(sd->nodes[i]->name);
+    if (sd->hashsize > 0) HashKill(&sd->Nodehash);
+    if (testnet->fanout >= RX_HASH_MIN) HashKill(&sd->Rxhash);
+    sd->hashsize = 0;
+    sd->numnodes = 0;
+    sd->numres = 0;
+    sd->net = NULL;
+}
+
+/*--------------------------------------------------------------*/
+/* Read a SPEF file and set the interconnect delay of each	*/
+/* receiver and the wire load of each net, as delayRead() does	*/
+/* for a delay file.  Only the *D_NET sections are used;  the	*/
+/* name map is followed, and the capacitance and resistance	*/
+/* units of the header are applied.  Coupling capacitances are	*/
+/* counted as capacitance to ground.				*/
+/*--------------------------------------------------------------*/
+
+void
+spefRead(FILE *fspef, struct hashtable *Nethash)
+{
+    spefdata sd;
+    char *line = NULL;
+    int linesize = 0;
+    char *buf = NULL;
+    int bufsize = 0;
+    char *tokens[SPEF_MAX_TOKENS];
+    int numtokens, state, i, n;
+    long idx;
+    double value;
+    char *name;
+    int numNets = 0, totalRxers = 0;
+    struct timeval tstart, tend;
+    double elapsed;
+
+    if (debug == 1)
+	fprintf(stdout, "spefRead\n");
+
+    gettimeofday(&tstart, NULL);
+
+    memset(&sd, 0, sizeof(spefdata));
+    sd.delimiter = ':';
+    sd.cscale = 1.0;
+    sd.rscale = 1.0;
+    sd.driver = -1;
+
+    setvbuf(fspef, NULL, _IOFBF, 1 << 20);
+    fileCurrentLine = 0;
+    state = SPEF_HEADER;
+
+    while (delayReadLine(fspef, &line, &linesize) != NULL) {
+	numtokens = spefTokenize(line, tokens);
+	if (numtokens == 0) continue;
+
+	if (*tokens[0] == '*' && !isdigit(*(tokens[0] + 1))) {
+
+	    /* Keywords */
+
+	    if (!strcmp(tokens[0], "*D_NET")) {
+		spefNetDone(&sd);
+		state = SPEF_SKIP;
+		if (numtokens < 2) continue;
+		name = spefMapName(&sd, tokens[1], &buf, &bufsize);
+		sd.net = delayFindNet(name, Nethash);
+		if (sd.net == NULL) {
+		    fprintf(stderr, "ERROR: Net %s not found in hash table\n",
+				name);
+		    continue;
+		}
+		if (debug == 1) fprintf(stdout, "Net %s\n", sd.net->name);
+		sd.driver = -1;
+		sd.numrx = 0;
+		sd.portdriver = 0;
+		if (sd.net->fanout >= RX_HASH_MIN)
+		    delayHashReceivers(sd.net, &sd.Rxhash, &sd.key, &sd.keysize);
+		numNets++;
+		state = SPEF_NETSKIP;
+	    }
+	    else if (!strcmp(tokens[0], "*END")) {
+		if (sd.net != NULL) totalRxers += sd.numrx;
+		spefNetDone(&sd);
+		state = SPEF_SKIP;
+	    }
+	    else if (sd.net != NULL) {
+		if (!strcmp(tokens[0], "*CONN"))
+		    state = SPEF_CONN;
+		else if (!strcmp(tokens[0], "*CAP"))
+		    state = SPEF_CAP;
+		else if (!strcmp(tokens[0], "*RES"))
+		    state = SPEF_RES;
+		else if (!strcmp(tokens[0], "*P") || !strcmp(tokens[0], "*I")) {
+		    if ((state == SPEF_CONN) && (numtokens >= 2))
+			spefConn(&sd, tokens, numtokens, &buf, &bufsize);
+		}
+		else if (state != SPEF_CONN)
+		    state = SPEF_NETSKIP;	/* *INDUC and others */
+	    }
+	    else if (!strcmp(tokens[0], "*NAME_MAP"))
+		state = SPEF_NAMEMAP;
+	    else if (!strcmp(tokens[0], "*DELIMITER") && (numtokens > 1))
+		sd.delimiter = *tokens[1];
+	    else if (!strcmp(tokens[0], "*C_UNIT") && (numtokens > 2)) {
+		value = strtod(tokens[1], NULL);
+		if (!strcasecmp(tokens[2], "FF"))
+		    sd.cscale = value * 1e-3;
+		else if (!strcasecmp(tokens[2], "PF"))
+		    sd.cscale = value;
+		else
+		    fprintf(stderr, "ERROR: Unknown SPEF capacitance unit %s\n",
+				tokens[2]);
+	    }
+	    else if (!strcmp(tokens[0], "*R_UNIT") && (numtokens > 2)) {
+		value = strtod(tokens[1], NULL);
+		if (!strcasecmp(tokens[2], "OHM"))
+		    sd.rscale = value;
+		else if (!strcasecmp(tokens[2], "KOHM"))
+		    sd.rscale = value * 1e3;
+		else
+		    fprintf(stderr, "ERROR: Unknown SPEF resistance unit %s\n",
+				tokens[2]);
+	    }
+	    else if (state != SPEF_HEADER)
+		state = SPEF_SKIP;	/* *PORTS, *R_NET, and others */
+	    continue;
+	}
+
+	switch (state) {
+	    case SPEF_NAMEMAP:
+		/* *<index> <name> */
+		if ((numtokens < 2) || (*tokens[0] != '*')) break;
+		idx = strtol(tokens[0] + 1, NULL, 10);
+		if (idx < 0) break;
+		if (idx >= sd.mapsize) {
+		    n = sd.mapsize;
+		    sd.mapsize = (idx >= 2 * n) ? idx + 1 : 2 * n;
+		    sd.namemap = (char **)realloc(sd.namemap, sd.mapsize *
+				sizeof(char *));
+		    for (i = n; i < sd.mapsize; i++) sd.namemap[i] = NULL;
+		}
+		if (sd.namemap[idx] != NULL) free(sd.namemap[idx]);
+		sd.namemap[idx] = strdup(tokens[1]);
+		break;
+
+	    case SPEF_CAP:
+		/* <id> <node> <cap>, or <id> <node> <node2> <cap> for	*/
+		/* a coupling capacitance.  Values may be triplets;	*/
+		/* strtod() takes the first.				*/
+		if (numtokens < 3) break;
+		n = spefFindNode(&sd, tokens[1]);
+		sd.nodes[n]->cap += strtod(tokens[numtokens - 1], NULL) * sd.cscale;
+		break;
+
+	    case SPEF_RES:
+		/* <id> <node1> <node2> <res> */
+		if (numtokens < 4) break;
+		if (sd.numres == sd.maxres) {
+		    sd.maxres = (sd.maxres == 0) ? 64 : sd.maxres << 1;
+		    sd.res = (spefres *)realloc(sd.res, sd.maxres * sizeof(spefres));
+		}
+		sd.res[sd.numres].node1 = spefFindNode(&sd, tokens[1]);
+		sd.res[sd.numres].node2 = spefFindNode(&sd, tokens[2]);
+		sd.res[sd.numres].res = strtod(tokens[3], NULL) * sd.rscale;
+		sd.nodes[sd.res[sd.numres].node1]->numedges++;
+		sd.nodes[sd.res[sd.numres].node2]->numedges++;
+		sd.numres++;
+		break;
+	}
+    }
+    if (sd.net != NULL) {
+	fprintf(stderr, "ERROR: Unexpected end-of-file while reading "
+			"SPEF file.\n");
+	totalRxers += sd.numrx;
+	spefNetDone(&sd);
+    }
+
+    for (i = 0; i < sd.mapsize; i++)
+	if (sd.namemap[i] != NULL) free(sd.namemap[i]);
+    free(sd.namemap);
+    for (i = 0; i < sd.maxnodes; i++)
+	if (sd.nodes[i] != NULL) free(sd.nodes[i]);
+    free(sd.nodes);
+    free(sd.res);
+    free(sd.adj);
+    free(sd.order);
+    free(sd.key);
+    free(buf);
+    free(line);
+
+    if (verbose > 0) {
+	gettimeofday(&tend, NULL);
+	elapsed = (double)(tend.tv_sec - tstart.tv_sec) +
+		(double)(tend.tv_usec - tstart.tv_usec) * 1e-6;
+	fprintf(stdout, "SPEF file read:  %d nets, %d receivers, %d lines "
+		"in %.3f s", numNets, totalRxers, fileCurrentLine, elapsed);
+	if (elapsed > 0.0)
+	    fprintf(stdout, " (%.0f nets/s)", (double)numNets / elapsed);
+	fprintf(stdout, "\n");
+    }
+}
+
+/*--------------------------------------------------------------*/
+/* Read a clock constraint file.  Each line is one of:		*/
+/*								*/
+/*	clock <name> <net> <period> [<rise> <fall>]		*/
+/*	async <clock> <clock> [<clock> ...]			*/
+/*	false <from_clock> <to_clock>				*/
+/*	false_path [-from <pat>] [-through <pat>] [-to <pat>]	*/
+/*	multicycle <N> [-from <pat>] [-through <pat>] [-to <pat>] */
+/*								*/
+/* "clock" defines a clock domain for all flops clocked from	*/
+/* net <net>, with the given period and times of the rising	*/
+/* and falling edges in the period (default 0 and half the	*/
+/* period), all in ps.  Paths between two clock domains are	*/
+/* checked against the edges of both clocks, unless the clocks	*/
+/* are listed together on an "async" line, or are the source	*/
+/* and destination of a "false" line, in which case the paths	*/
+/* are not traced at all.  Clocks must be defined before they	*/
+/* are used.							*/
+/*								*/
+/* "false_path" and "multicycle" are path exceptions.  Patterns	*/
+/* match instance names, "instance/pin" names, and the names of	*/
+/* module pins, with "*" and "?" wildcards;  a "-through"	*/
+/* pattern also matches net names.  Paths starting at a match	*/
+/* of "-from", passing a match of "-through", and ending at a	*/
+/* match of "-to" (any of which may be omitted) are not traced	*/
+/* if false, or are allowed <N> cycles of the capture clock if	*/
+/* multicycle.  Only the setup check is relaxed by "multicycle";	*/
+/* the hold check stays at the original clock edge.  Text	*/
+/* following "#" is a comment.					*/
+/*								*/
+/* Return the number of clocks defined.				*/
+/*--------------------------------------------------------------*/
+
+static int
+clockFind(char *name)
+{
+    int d;
+
+    for (d = 1; d < numdomains; d++)
+	if (!strcmp(clockdefs[d].name, name))
+	    return d;
+    return 0;
+}
+
+int
+clockRead(FILE *fclk, struct hashtable *Nethash)
+{
+    char *line = NULL, *token, *cptr;
+    char *name, *netname, *value;
+    int linesize = 0, numgroup, i, j, d, bad;
+    int group[MAX_DOMAINS];
+    netptr testnet;
+    clockdef *newclock;
+    exception *newexcept;
+
+    fileCurrentLine = 0;
+    while (delayReadLine(fclk, &line, &linesize) != NULL) {
+	if ((cptr = strchr(line, '#')) != NULL) *cptr = '\0';
+	token = strtok(line, " \t");
+	if (token == NULL) continue;
+
+	if (!strcmp(token, "clock")) {
+	    name = strtok(NULL, " \t");
+	    netname = strtok(NULL, " \t");
+	    value = strtok(NULL, " \t");
+	    if (value == NULL) {
+		fprintf(stderr, "Clock file line %d:  Expected clock name, "
+			"source net, and period\n", fileCurrentLine);
+		continue;
+	    }
+	    if (clockFind(name) != 0) {
+		fprintf(stderr, "Clock file line %d:  Clock \"%s\" is already "
+			"defined\n", fileCurrentLine, name);
+		continue;
+	    }
+	    if (numdomains == MAX_DOMAINS) {
+		fprintf(stderr, "Clock file line %d:  Too many clocks (maximum "
+			"%d)\n", fileCurrentLine, MAX_DOMAINS - 1);
+		continue;
+	    }
+	    testnet = delayFindNet(netname, Nethash);
+	    if (testnet == NULL) {
+		fprintf(stderr, "Clock file line %d:  No net \"%s\" for clock "
+			"\"%s\"\n", fileCurrentLine, netname, name);
+		continue;
+	    }
+	    newclock = &clockdefs[numdomains];
+	    newclock->period = strtod(value, NULL);
+	    if (newclock->period <= 0.0) {
+		fprintf(stderr, "Clock file line %d:  Bad period \"%s\"\n",
+			fileCurrentLine, value);
+		continue;
+	    }
+	    newclock->rise = 0.0;
+	    newclock->fall = newclock->period / 2.0;
+	    if ((value = strtok(NULL, " \t")) != NULL) {
+		newclock->rise = strtod(value, NULL);
+		if ((value = strtok(NULL, " \t")) != NULL)
+		    newclock->fall = strtod(value, NULL);
+	    }
+	    newclock->name = strdup(name);
+	    newclock->source = testnet;
+	    newclock->related = DOMAIN_ALL;
+	    numdomains++;
+	}
+	else if (!strcmp(token, "async") || !strcmp(token, "false")) {
+	    numgroup = 0;
+	    while ((name = strtok(NULL, " \t")) != NULL) {
+		if ((d = clockFind(name)) == 0)
+		    fprintf(stderr, "Clock file line %d:  Unknown clock \"%s\"\n",
+				fileCurrentLine, name);
+		else if (numgroup < MAX_DOMAINS)
+		    group[numgroup++] = d;
+	    }
+	    if (*token == 'f') {
+		/* Paths from the first clock to the second are false */
+		if (numgroup == 2)
+		    clockdefs[group[0]].related &= ~(1 << group[1]);
+		else
+		    fprintf(stderr, "Clock file line %d:  Expected two clocks\n",
+				fileCurrentLine);
+	    }
+	    else {
+		/* Paths between any two clocks of the group are false */
+		for (i = 0; i < numgroup; i++)
+		    for (j = 0; j < numgroup; j++)
+			if (group[i] != group[j])
+			    clockdefs[group[i]].related &= ~(1 << group[j]);
+	    }
+	}
+	else if (!strcmp(token, "false_path") || !strcmp(token, "multicycle")) {
+	    if (numexceptions == MAX_EXCEPTIONS) {
+		fprintf(stderr, "Clock file line %d:  Too many exceptions (maximum "
+			"%d)\n", fileCurrentLine, MAX_EXCEPTIONS);
+		continue;
+	    }
+	    newexcept = &exceptions[numexceptions];
+	    newexcept->from = newexcept->through = newexcept->to = NULL;
+	    newexcept->cycles = 0;
+	    bad = 0;
+	    if (*token == 'm') {
+		value = strtok(NULL, " \t");
+		if (value != NULL) newexcept->cycles = atoi(value);
+		if (newexcept->cycles < 1) {
+		    fprintf(stderr, "Clock file line %d:  Bad cycle count\n",
+				fileCurrentLine);
+		    continue;
+		}
+	    }
+	    while ((value = strtok(NULL, " \t")) != NULL) {
+		name = strtok(NULL, " \t");
+		if (name == NULL) {
+		    fprintf(stderr, "Clock file line %d:  Expected a pattern "
+				"after \"%s\"\n", fileCurrentLine, value);
+		    bad = 1;
+		}
+		else if (!strcmp(value, "-from") && (newexcept->from == NULL))
+		    newexcept->from = strdup(name);
+		else if (!strcmp(value, "-through") && (newexcept->through == NULL))
+		    newexcept->through = strdup(name);
+		else if (!strcmp(value, "-to") && (newexcept->to == NULL))
+		    newexcept->to = strdup(name);
+		else {
+		    fprintf(stderr, "Clock file line %d:  Bad option \"%s\"\n",
+				fileCurrentLine, value);
+		    bad = 1;
+		}
+		if (bad) break;
+	    }
+	    if (bad) {
+		if (newexcept->from) free(newexcept->from);
+		if (newexcept->through) free(newexcept->through);
+		if (newexcept->to) free(newexcept->to);
+		continue;
+	    }
+	    numexceptions++;
+	}
+	else
+	    fprintf(stderr, "Clock file line %d:  Unknown keyword \"%s\"\n",
+			fileCurrentLine, token);
+    }
+    free(line);
+    return numdomains - 1;
+}
+
+/*--------------------------------------------------------------*/
+/* Print a path component                                       */
+/* (code contributed by Karl-Filip Faxen)			*/
+/*--------------------------------------------------------------*/
+
+void
+print_path_component(int netFWidth, int instFWidth, int pinFWidth, int recvFWidth, 
+                     btptr backtrace, FILE *file)
+{
+    // Return immediately if we have niether a driver or a receiver instance
+    if (backtrace->receiver->refnet->driver == NULL &&
+		backtrace->receiver->refinst == NULL) return;
+
+    fprintf(file, " %8.1f ps", backtrace->delay);
+    if (backtrace->receiver->refnet != NULL) {
+        netptr net = backtrace->receiver->refnet;
         fprintf(file, "  %*s: ", netFWidth, net->name);
         if (net->driver != NULL) {   // If the driver exists, it has a refinst
             fprintf(file, "%*s/%*s",
@@ -3495,131 +5176,509 @@ print_path(btptr backtrace, FILE *file)
 }
 
 /*--------------------------------------------------------------*/
-/* Given a list of paths, find the clock at the source and the	*/
-/* destination (if neither is a pin), and compute the clock	*/
-/* skew between them.  Also compute the setup or hold at the	*/
-/* destination.	 Save these values in the path record.		*/
+/* Free a list of clock sources made by find_clock_source(),	*/
+/* and clear the "visited" marks of "mode" along the way.	*/
 /*--------------------------------------------------------------*/
 
 void
-find_clock_skews(ddataptr pathlist, char minmax)
+free_clock_list(ddataptr *clocklist, unsigned char mode)
 {
-    connptr testconn, thisconn;
-    instptr  testinst;
+    ddataptr freeddata;
+    btptr freebt;
+    connptr testconn;
 
-    ddataptr testddata, srcddata, freeddata;
-    ddataptr clocklist, clock2list;
-    btptr    backtrace, freebt, pathbt, btcommon;
-    btptr    selectedsource, selecteddest;
+    for (freeddata = *clocklist; freeddata; freeddata = freeddata->next) {
+	while (freeddata->backtrace != NULL) {
+	    freebt = freeddata->backtrace;
+	    testconn = freebt->receiver;
+	    freeddata->backtrace = freeddata->backtrace->next;
+	    freebt->refcnt--;
+	    if (freebt->refcnt == 0) free(freebt);
+	    else break;
+	    if (testconn->visited != mode)
+		break;
+	    testconn->visited = (unsigned char)0;
+	}
+    }
 
-    short srcdir, destdir;		// Signal direction in/out
-    double setupdelay, holddelay;
-    unsigned char result;
-    char	clk_invert, clk_sense_inv;
+    while (*clocklist != NULL) {
+	freeddata = *clocklist;
+	*clocklist = (*clocklist)->next;
+	free(freeddata);
+    }
+}
 
-    clocklist = NULL;
-    clock2list = NULL;
-    srcdir = EDGE_UNKNOWN;
-    
-    for (testddata = pathlist; testddata; testddata = testddata->next) {
+/*--------------------------------------------------------------*/
+/* Find the time allowed for a path launched by flop "srcinst"	*/
+/* and captured by flop "destinst" from the waveforms of their	*/
+/* clock domains.  For maximum time, this is the shortest time	*/
+/* from a launching edge to the following capturing edge (the	*/
+/* setup relationship).  For minimum time, it is the largest	*/
+/* time from a launching edge back to the capturing edge before	*/
+/* that one (the hold relationship).  The edges are compared	*/
+/* over the common period of the two clocks.  Return 0 if	*/
+/* either flop is not in a constrained clock domain.		*/
+/*--------------------------------------------------------------*/
 
-        // Find the end of the linked list, which is the path start.
-        for (pathbt = testddata->backtrace; pathbt->next; pathbt = pathbt->next);
-	thisconn = pathbt->receiver;
+#define MAX_CLOCK_EDGES	1000	/* Launching edges compared, at most */
 
-        if (thisconn && thisconn->refpin) {
-            // Find the sources of the clock at the path start.  Create
-	    // a tree of backtraces from thisconn to all clock sources,
-	    // and return clocklist, which is a list of the sources.
+double
+clock_relation(instptr srcinst, instptr destinst, char minmax)
+{
+    clockdef *lclock, *cclock;
+    double l0, c0, ltime, ctime, setup, hold;
+    long lper, cper, t;
+    int k, numedges;
+
+    if ((srcinst->domain == 0) || (destinst->domain == 0)) return 0.0;
+
+    lclock = &clockdefs[srcinst->domain];
+    cclock = &clockdefs[destinst->domain];
+    l0 = (srcinst->edge == FALLING) ? lclock->fall : lclock->rise;
+    c0 = (destinst->edge == FALLING) ? cclock->fall : cclock->rise;
+
+    /* The number of launching edges in the common period is the	*/
+    /* capture period divided by the greatest common divisor of the	*/
+    /* two periods (rounded to 1ps).					*/
+
+    lper = (long)(lclock->period + 0.5);
+    cper = (long)(cclock->period + 0.5);
+    while (cper != 0) {
+	t = lper % cper;
+	lper = cper;
+	cper = t;
+    }
+    numedges = (lper > 0) ? (int)((long)(cclock->period + 0.5) / lper) : 1;
+    if (numedges > MAX_CLOCK_EDGES) numedges = MAX_CLOCK_EDGES;
+    if (numedges < 1) numedges = 1;
+
+    setup = 1.0E50;
+    hold = -1.0E50;
+    for (k = 0; k < numedges; k++) {
+	ltime = l0 + k * lclock->period;
+	ctime = c0 + (floor((ltime - c0) / cclock->period + 1.0E-9) + 1.0)
+			* cclock->period;
+	if (ctime - ltime < setup) setup = ctime - ltime;
+	if (ctime - ltime - cclock->period > hold)
+	    hold = ctime - ltime - cclock->period;
+    }
+    return (minmax == MAXIMUM_TIME) ? setup : hold;
+}
 
-            find_clock_source(thisconn, &clocklist, NULL, srcdir, (unsigned char)1);
+/*--------------------------------------------------------------*/
+/* Add net "clknet" and the nets upstream of it to the clock	*/
+/* tree, and return its index in "clocknodes".  The parent of	*/
+/* a net is the net at one input of the gate driving it:  the	*/
+/* clock of a flop, the data input of a latch, or otherwise	*/
+/* the input passing through the fewest flops and latches from	*/
+/* a root and, of those, arriving latest (so that the parent of	*/
+/* a clock gate is the clock, not the gating signal).  A net	*/
+/* with no driver, or reached again through a loop, is a root.	*/
+/*								*/
+/* The late and early arrival times use the maximum and minimum	*/
+/* delays scaled by the late and early derating factors.  As	*/
+/* for the data paths, they do not include interconnect delay.	*/
+/* A parent is always added to the tree before its children.	*/
+/*--------------------------------------------------------------*/
 
-            // Calculate the worst-case transition times to testlink on
-	    // each clocklist backtrace.
+int
+clock_tree_node(netptr clknet)
+{
+    connptr driver, iinput, parentconn;
+    clocknode *pnode, *newnode;
+    double best, late, early, dly;
+    short edge, outdir, bestregs;
+    int pidx, bestidx, idx, e, o;
+
+    if (clknet->clocknode >= 0) return clknet->clocknode;
+    clknet->clocknode = -2;		/* Pending, to detect loops */
+
+    bestidx = -1;
+    bestregs = 0;
+    best = 0.0;
+    parentconn = NULL;
+    driver = clknet->driver;
+    if (driver && driver->refinst && driver->refpin) {
+	for (iinput = driver->refinst->in_connects; iinput; iinput = iinput->next) {
+	    if (iinput->refpin == NULL) continue;
+	    if ((driver->refpin->type & DFFOUT) && !(iinput->refpin->type & DFFCLK))
+		continue;
+	    if ((driver->refpin->type & LATCHOUT) && !(iinput->refpin->type & LATCHIN))
+		continue;
+	    if (iinput->refnet->clocknode == -2) continue;
+	    pidx = clock_tree_node(iinput->refnet);
+	    pnode = &clocknodes[pidx];
+	    late = (pnode->late[0] > pnode->late[1]) ? pnode->late[0] : pnode->late[1];
+	    if ((bestidx < 0) || (pnode->regs < bestregs) ||
+			((pnode->regs == bestregs) && (late > best))) {
+		bestidx = pidx;
+		bestregs = pnode->regs;
+		best = late;
+		parentconn = iinput;
+	    }
+	}
+    }
 
-            find_clock_transition(clocklist, thisconn, srcdir, minmax,
-			(unsigned char)1);
+    if (numclocknodes == maxclocknodes) {
+	maxclocknodes = (maxclocknodes == 0) ? 64 : (maxclocknodes << 1);
+	clocknodes = (clocknode *)realloc(clocknodes,
+			maxclocknodes * sizeof(clocknode));
+    }
+    idx = numclocknodes++;
+    newnode = &clocknodes[idx];
+    newnode->net = clknet;
+    clknet->clocknode = idx;
+
+    if (bestidx < 0) {
+	newnode->parent = -1;
+	newnode->depth = 0;
+	newnode->regs = 0;
+	newnode->invert = 0;
+	for (o = 0; o < 2; o++) {
+	    newnode->late[o] = newnode->early[o] = 0.0;
+	    newnode->latetrans[o] = newnode->earlytrans[o] = 0.0;
 	}
+	return idx;
+    }
 
-        // Copy last backtrace delay to testddata.
-        testddata->delay = testddata->backtrace->delay;
-        testddata->trans = testddata->backtrace->trans;
-        testinst = testddata->backtrace->receiver->refinst;
-        selecteddest = selectedsource = NULL;
+    pnode = &clocknodes[bestidx];
+    newnode->parent = bestidx;
+    newnode->depth = pnode->depth + 1;
+    newnode->regs = pnode->regs +
+		((driver->refpin->type & (DFFOUT | LATCHOUT)) ? 1 : 0);
+    if ((pnode->invert < 0) || (driver->refpin->type & (DFFOUT | LATCHOUT)))
+	newnode->invert = -1;
+    else if (parentconn->refpin->sense == SENSE_POSITIVE)
+	newnode->invert = pnode->invert;
+    else if (parentconn->refpin->sense == SENSE_NEGATIVE)
+	newnode->invert = 1 - pnode->invert;
+    else
+	newnode->invert = -1;
+    for (o = 0; o < 2; o++) {
+	newnode->late[o] = newnode->early[o] = INITVAL;
+	newnode->latetrans[o] = newnode->earlytrans[o] = 0.0;
+    }
 
-        if (testinst != NULL) {
-            // Find the sources of the clock at the path end
-            destdir = (testinst->refcell->type & CLK_SENSE_MASK) ? FALLING : RISING;
-            testconn = find_register_clock(testinst);
-            // If testconn is NULL, this is not a register (latch, maybe?)
-            if (testconn == NULL) continue;
+    for (e = 0; e < 2; e++) {
+	edge = e + 1;
 
-            // Find the connection that is common to both clocks
-            result = find_clock_source(testconn, &clock2list, NULL, destdir,
-			(unsigned char)2);
+	// A flop output follows only the clock edge of the flop
+	if ((driver->refpin->type & DFFOUT) &&
+			(edge != clock_edge(parentconn->refpin->refcell)))
+	    continue;
 
-	    if ((result == (unsigned char)0) && (clocklist != NULL)) {
-		// If both paths end on the same input net, then there
-		// is no connection pointer, so deal with that separately.
+	outdir = calc_dir(parentconn->refpin, edge);
+	for (o = 0; o < 2; o++) {
+	    if (!(outdir & (o + 1))) continue;
+	    late = pnode->late[e] + derate[MAXIMUM_TIME] *
+			calc_prop_delay(pnode->latetrans[e], parentconn, o + 1,
+			MAXIMUM_TIME);
+	    if ((newnode->late[o] == INITVAL) || (late > newnode->late[o])) {
+		newnode->late[o] = late;
+		newnode->latetrans[o] = calc_transition(pnode->latetrans[e],
+			parentconn, o + 1, MAXIMUM_TIME);
+	    }
+	    early = pnode->early[e] + derate[MINIMUM_TIME] *
+			calc_prop_delay(pnode->earlytrans[e], parentconn, o + 1,
+			MINIMUM_TIME);
+	    if ((newnode->early[o] == INITVAL) || (early < newnode->early[o])) {
+		newnode->early[o] = early;
+		newnode->earlytrans[o] = calc_transition(pnode->earlytrans[e],
+			parentconn, o + 1, MINIMUM_TIME);
+	    }
+	}
+    }
 
-		if (clocklist->backtrace->receiver->refnet !=
-			    	clock2list->backtrace->receiver->refnet) {
+    // An edge that does not propagate takes the times of the other one
+    for (o = 0; o < 2; o++) {
+	if (newnode->late[o] != INITVAL) continue;
+	dly = (newnode->late[1 - o] != INITVAL) ? newnode->late[1 - o] : pnode->late[0];
+	newnode->late[o] = dly;
+	newnode->latetrans[o] = newnode->latetrans[1 - o];
+	dly = (newnode->early[1 - o] != INITVAL) ? newnode->early[1 - o] : pnode->early[0];
+	newnode->early[o] = dly;
+	newnode->earlytrans[o] = newnode->earlytrans[1 - o];
+    }
+    return idx;
+}
 
-		    // Warn about asynchronous clock sources
-		    if (verbose > 1) {
-		 	fflush(stdout);
-			fprintf(stderr, "Independent clock nets \"%s\" and \"%s\""
-					" drive related gates!\n",
-					testconn->refnet->name,
-					thisconn->refnet->name);
-		    }
-		    clk_invert = -1;
-		}
-            }
+/*--------------------------------------------------------------*/
+/* Build the clock tree of the clock nets of all registers in	*/
+/* "clockedlist" (see clock_tree_node()), and the table of	*/
+/* ancestors used by clock_common().  Arrival times depend on	*/
+/* the corner, so the tree is built for each corner analyzed	*/
+/* and freed by clock_tree_free().				*/
+/*--------------------------------------------------------------*/
 
-	    // If clocklist is NULL then this is an input and there is
-	    // no way to compute relative to a common clock, because
-	    // there is no common clock.
-
-	    if (clocklist != NULL) {
-		// Find clock arrival times from common clock point.  Note that
-		// the check is opposite to what is computed for the source;  if
-		// maximum time was used to find clock-to-source, then minimum
-		// time is used to find clock-to-destination.
-
-		btcommon = find_common_clock(clock2list, clocklist);
-                find_clock_transition(clock2list, testconn,
-				(btcommon) ? btcommon->dir : RISING,
-				~minmax, (unsigned char)2);
-
-		// selectedsource is the end of the btcommon backtrace
-		for (selectedsource = (btcommon) ? btcommon : clocklist->backtrace;
-				selectedsource->next;
-				selectedsource = selectedsource->next);
-		// selecteddest is the end of the clock2list backtrace
-		for (selecteddest = clock2list->backtrace; selecteddest->next;
-				selecteddest = selecteddest->next);
+void
+clock_tree_build(connlistptr clockedlist)
+{
+    connlistptr testlink;
+    connptr testconn;
+    int i, k;
 
-                // Add or subtract difference in arrival times between source and
-                // destination clocks
+    clocknodes = NULL;
+    numclocknodes = 0;
+    maxclocknodes = 0;
 
-                testddata->skew = selectedsource->delay - selecteddest->delay -
-					((btcommon) ? btcommon->delay : 0.0);
-                testddata->delay += testddata->skew;
-	    }
-	    else if (clock2list) {
-		// Still need to know destination's clock source to
-		// calculate setup or hold time.
-		for (selecteddest = clock2list->backtrace; selecteddest->next;
-				selecteddest = selecteddest->next);
-		testddata->skew = 0.0;
+    for (testlink = clockedlist; testlink; testlink = testlink->next) {
+	testconn = testlink->connection;
+	if (testconn->refpin == NULL) continue;		/* Module input */
+	clock_tree_node(testconn->refnet);
+    }
+
+    // clockup[k][i] is the ancestor of net i at 2^k levels up, or the
+    // root if the tree is not that deep.
+
+    clocklevels = 1;
+    while ((1 << clocklevels) < numclocknodes) clocklevels++;
+    clockup = (int **)malloc(clocklevels * sizeof(int *));
+    for (k = 0; k < clocklevels; k++)
+	clockup[k] = (int *)malloc((numclocknodes + 1) * sizeof(int));
+    for (i = 0; i < numclocknodes; i++)
+	clockup[0][i] = (clocknodes[i].parent >= 0) ? clocknodes[i].parent : i;
+    for (k = 1; k < clocklevels; k++)
+	for (i = 0; i < numclocknodes; i++)
+	    clockup[k][i] = clockup[k - 1][clockup[k - 1][i]];
+}
+
+/*--------------------------------------------------------------*/
+/* Free the clock tree made by clock_tree_build().		*/
+/*--------------------------------------------------------------*/
+
+void
+clock_tree_free()
+{
+    int i, k;
+
+    for (i = 0; i < numclocknodes; i++)
+	clocknodes[i].net->clocknode = -1;
+    for (k = 0; k < clocklevels; k++)
+	free(clockup[k]);
+    free(clockup);
+    free(clocknodes);
+    clocknodes = NULL;
+    clockup = NULL;
+    numclocknodes = maxclocknodes = 0;
+}
+
+/*--------------------------------------------------------------*/
+/* Return the index of the last net common to the clock tree	*/
+/* paths to nets "a" and "b", or -1 if they have different	*/
+/* roots.  This takes time O(log n) in the size of the tree.	*/
+/*--------------------------------------------------------------*/
+
+int
+clock_common(int a, int b)
+{
+    int k, t;
+
+    if (clocknodes[a].depth < clocknodes[b].depth) {
+	t = a;
+	a = b;
+	b = t;
+    }
+    for (k = clocklevels - 1; k >= 0; k--)
+	if (clocknodes[a].depth - (1 << k) >= clocknodes[b].depth)
+	    a = clockup[k][a];
+    if (a == b) return a;
+
+    for (k = clocklevels - 1; k >= 0; k--) {
+	if (clockup[k][a] != clockup[k][b]) {
+	    a = clockup[k][a];
+	    b = clockup[k][b];
+	}
+    }
+    return (clocknodes[a].parent == clocknodes[b].parent) ? clocknodes[a].parent : -1;
+}
+
+/*--------------------------------------------------------------*/
+/* Return the edge at clock tree net "common" that becomes edge	*/
+/* "edge" at net "idx" downstream of it, or EITHER if the clock	*/
+/* tree between them is not unate.				*/
+/*--------------------------------------------------------------*/
+
+short
+clock_common_edge(int common, int idx, short edge)
+{
+    if ((clocknodes[common].invert < 0) || (clocknodes[idx].invert < 0))
+	return EITHER;
+    else if (clocknodes[common].invert == clocknodes[idx].invert)
+	return edge;
+    else
+	return (edge == RISING) ? FALLING : RISING;
+}
+
+/*--------------------------------------------------------------*/
+/* Return the late (minmax = MAXIMUM_TIME) or early arrival at	*/
+/* clock tree net "node" for clock edge "edge", and set "trans"	*/
+/* (if not NULL) to its transition time.  For EITHER, return	*/
+/* the latest or the earliest arrival of the two edges.		*/
+/*--------------------------------------------------------------*/
+
+double
+clock_arrival(clocknode *node, short edge, char minmax, double *trans)
+{
+    double *arr, *tr;
+    int e;
+
+    arr = (minmax == MAXIMUM_TIME) ? node->late : node->early;
+    tr = (minmax == MAXIMUM_TIME) ? node->latetrans : node->earlytrans;
+    if (edge != EITHER)
+	e = edge - 1;
+    else if (minmax == MAXIMUM_TIME)
+	e = (arr[1] > arr[0]) ? 1 : 0;
+    else
+	e = (arr[1] < arr[0]) ? 1 : 0;
+    if (trans) *trans = tr[e];
+    return arr[e];
+}
+
+/*--------------------------------------------------------------*/
+/* Return the clock reconvergence pessimism of clock tree net	*/
+/* "common" for the clocks at edge "aedge" of net "a" and edge	*/
+/* "bedge" of net "b":  the difference between the late and the	*/
+/* early arrival at the common net, which cannot both happen on	*/
+/* the same clock edge.  If the two clocks do not come from the	*/
+/* same edge at the common net, the smaller difference of the	*/
+/* two edges is used.  If both edges are EITHER, the clocks are	*/
+/* taken at their worst edges (see clock_arrival()), and so is	*/
+/* the common net.						*/
+/*--------------------------------------------------------------*/
+
+double
+clock_crpr(int common, int a, short aedge, int b, short bedge)
+{
+    clocknode *cnode = &clocknodes[common];
+    double rdiff, fdiff;
+    short edge;
+
+    if ((aedge == EITHER) && (bedge == EITHER)) {
+	rdiff = clock_arrival(cnode, EITHER, MAXIMUM_TIME, NULL) -
+		clock_arrival(cnode, EITHER, MINIMUM_TIME, NULL);
+	return (rdiff > 0.0) ? rdiff : 0.0;
+    }
+
+    rdiff = cnode->late[0] - cnode->early[0];
+    fdiff = cnode->late[1] - cnode->early[1];
+
+    edge = clock_common_edge(common, a, aedge);
+    if ((edge != EITHER) && (edge == clock_common_edge(common, b, bedge)))
+	rdiff = (edge == RISING) ? rdiff : fdiff;
+    else
+	rdiff = (rdiff < fdiff) ? rdiff : fdiff;
+    return (rdiff > 0.0) ? rdiff : 0.0;
+}
+
+/*--------------------------------------------------------------*/
+/* Given a list of paths, find the clock at the source and the	*/
+/* destination (if neither is a pin), and compute the clock	*/
+/* skew between them.  Also compute the setup or hold at the	*/
+/* destination.	 Save these values in the path record.		*/
+/*								*/
+/* For setup (maximum time), the skew is the late arrival of	*/
+/* the launching clock less the early arrival of the capturing	*/
+/* clock, and for hold (minimum time), the reverse.  The part	*/
+/* of the clock tree common to both clocks cannot be both late	*/
+/* and early, so its pessimism (see clock_crpr()) is removed.	*/
+/*								*/
+/* The arrivals are those of the clock edge of each register	*/
+/* only when the delays are derated (option -r).  Otherwise,	*/
+/* each clock is taken at its worst edge, as vesta has always	*/
+/* done, so that results without derating do not change.	*/
+/*--------------------------------------------------------------*/
+
+void
+find_clock_skews(ddataptr pathlist, char minmax)
+{
+    connptr testconn, thisconn;
+    instptr  testinst;
+
+    ddataptr testddata;
+    btptr    backtrace, pathbt;
+    clocknode *srcnode, *destnode;
+
+    short srcedge, destedge;		// Clock edges at source and destination
+    char anyedge;			// Clocks are taken at their worst edge
+    int common;
+    double setupdelay = 0.0, holddelay = 0.0, desttrans, crpr;
+    char	clk_invert, clk_sense_inv;
+
+    anyedge = ((derate[MAXIMUM_TIME] == 1.0) && (derate[MINIMUM_TIME] == 1.0));
+
+    for (testddata = pathlist; testddata; testddata = testddata->next) {
+
+        // Find the end of the linked list, which is the path start.
+        for (pathbt = testddata->backtrace; pathbt->next; pathbt = pathbt->next);
+	thisconn = pathbt->receiver;
+
+	srcnode = NULL;
+	srcedge = RISING;
+        if (thisconn && thisconn->refpin && (thisconn->refnet->clocknode >= 0)) {
+	    srcnode = &clocknodes[thisconn->refnet->clocknode];
+	    srcedge = (anyedge) ? EITHER : clock_edge(thisconn->refpin->refcell);
+	}
+
+        // Copy last backtrace delay to testddata.
+        testddata->delay = testddata->backtrace->delay;
+        testddata->trans = testddata->backtrace->trans;
+        testinst = testddata->backtrace->receiver->refinst;
+
+        if (testinst != NULL) {
+            // Find the clock at the path end
+            destedge = (anyedge) ? EITHER : clock_edge(testinst->refcell);
+            testconn = find_register_clock(testinst);
+            // If testconn is NULL, this is not a register (latch, maybe?)
+            if (testconn == NULL) continue;
+
+	    destnode = (testconn->refnet->clocknode >= 0) ?
+			&clocknodes[testconn->refnet->clocknode] : NULL;
+	    desttrans = 0.0;
+	    if (destnode != NULL)
+		clock_arrival(destnode, destedge, (minmax == MAXIMUM_TIME) ?
+			MINIMUM_TIME : MAXIMUM_TIME, &desttrans);
+
+	    // If the path starts on an input, there is no common clock,
+	    // and the skew is zero.
+
+	    clk_invert = 0;
+	    crpr = 0.0;
+	    testddata->skew = 0.0;
+	    if ((srcnode != NULL) && (destnode != NULL)) {
+		common = clock_common(thisconn->refnet->clocknode,
+			testconn->refnet->clocknode);
+		if (common >= 0)
+		    crpr = clock_crpr(common, thisconn->refnet->clocknode, srcedge,
+				testconn->refnet->clocknode, destedge);
+		else {
+		    // Warn about asynchronous clock sources
+		    if (verbose > 1) {
+			fflush(stdout);
+			fprintf(stderr, "Independent clock nets \"%s\" and \"%s\""
+					" drive related gates!\n",
+					testconn->refnet->name,
+					thisconn->refnet->name);
+		    }
+		    clk_invert = -1;
+		}
+
+                // Add or subtract difference in arrival times between source and
+                // destination clocks
+
+		if (minmax == MAXIMUM_TIME)
+		    testddata->skew = clock_arrival(srcnode, srcedge, MAXIMUM_TIME, NULL)
+			- clock_arrival(destnode, destedge, MINIMUM_TIME, NULL) - crpr;
+		else
+		    testddata->skew = clock_arrival(srcnode, srcedge, MINIMUM_TIME, NULL)
+			- clock_arrival(destnode, destedge, MAXIMUM_TIME, NULL) + crpr;
+                testddata->delay += testddata->skew;
 	    }
 
             if (minmax == MAXIMUM_TIME) {
                 // Add setup time for destination clocks
                 setupdelay = calc_setup_time(testddata->trans,
                                         testddata->backtrace->receiver->refpin,
-                                        selecteddest->trans,
+                                        desttrans,
                                         testddata->backtrace->dir, minmax);
                 testddata->setup = setupdelay;
             }
@@ -3628,12 +5687,17 @@ find_clock_skews(ddataptr pathlist, char minmax)
 		// are defined as typically negative values in the liberty format)
                 holddelay = calc_hold_time(testddata->trans,
                                         testddata->backtrace->receiver->refpin,
-                                        selecteddest->trans,
+                                        desttrans,
                                         testddata->backtrace->dir, minmax);
                 testddata->setup = holddelay;
             }
             testddata->delay += testddata->setup;
 
+	    // Find the time allowed by the launch and capture clocks
+	    if ((numdomains > 1) && thisconn && thisconn->refpin && thisconn->refinst)
+		testddata->required = clock_relation(thisconn->refinst, testinst,
+				minmax);
+
             if (verbose > 1)
                 fprintf(stdout, "Path terminated on flop \"%s\" input with max delay %g ps\n",
                                 testconn->refinst->name, testddata->delay);
@@ -3657,15 +5721,17 @@ find_clock_skews(ddataptr pathlist, char minmax)
                                 backtrace->receiver->refinst->name,
                                 backtrace->receiver->refinst->out_connects->refpin->name);
 
-            if (selecteddest != NULL && selectedsource != NULL) {
+            if ((srcnode != NULL) && (destnode != NULL)) {
                 if (verbose > 1) {
-                    if (selectedsource->receiver->refnet != selecteddest->receiver->refnet) {
+                    if (srcnode->net != destnode->net) {
                         fprintf(stdout, "   %g %s to %s clock skew\n",
-                                selecteddest->delay - selectedsource->delay
-				+ ((btcommon) ? btcommon->delay : 0.0),
-                                selectedsource->receiver->refnet->name,
-                                selecteddest->receiver->refnet->name);
+                                -testddata->skew,
+                                srcnode->net->name,
+                                destnode->net->name);
                     }
+		    if (crpr > 0.0)
+			fprintf(stdout, "   %g clock reconvergence pessimism "
+				"removed\n", crpr);
                 }
 
                 /* Check if the flops have the same clock sense */
@@ -3673,9 +5739,8 @@ find_clock_skews(ddataptr pathlist, char minmax)
 
 		if (backtrace->receiver->refinst == NULL)
 		    clk_sense_inv = 1;
-                else if ((testinst->refcell->type & CLK_SENSE_MASK) !=
-                                        (backtrace->receiver->refinst->refcell->type
-                                        & CLK_SENSE_MASK))
+                else if (clock_edge(testinst->refcell) !=
+                                        clock_edge(backtrace->receiver->refinst->refcell))
                     clk_sense_inv = 1;
                 else
                     clk_sense_inv = 0;
@@ -3726,368 +5791,595 @@ find_clock_skews(ddataptr pathlist, char minmax)
                         backtrace->receiver->refinst->name,
                         backtrace->receiver->refinst->out_connects->refpin->name);
         }
+    }
+}
 
-        // Clean up clock2list backtraces
-	for (freeddata = clock2list; freeddata; freeddata = freeddata->next) {
-	    while (freeddata->backtrace != NULL) {
-		freebt = freeddata->backtrace;
-		testconn = freebt->receiver;
-		freeddata->backtrace = freeddata->backtrace->next;
-                freebt->refcnt--;
-		if (freebt->refcnt == 0) free(freebt);
-		else break;
-		if (testconn->visited != (unsigned char)2)
-		    break;
-		testconn->visited = (unsigned char)0;
+/*--------------------------------------------------------------*/
+/* Return the time that latch "testinst" is transparent in each	*/
+/* cycle of its enable, from the waveform of its clock domain,	*/
+/* or half of "period" if it is not in a constrained domain.	*/
+/*--------------------------------------------------------------*/
+
+double
+latch_window(instptr testinst, double period)
+{
+    clockdef *lclock;
+    double high;
+
+    if (testinst->domain == 0)
+	return (period > 0.0) ? period / 2.0 : 0.0;
+
+    lclock = &clockdefs[testinst->domain];
+    high = lclock->fall - lclock->rise;
+    if (high < 0.0) high += lclock->period;
+    return (testinst->edge == FALLING) ? lclock->period - high : high;
+}
+
+/*--------------------------------------------------------------*/
+/* Apply latch time borrowing to the paths of "pathlist" after	*/
+/* find_clock_skews() has found their delays and required	*/
+/* times.  A path ending on a latch is required at the edge	*/
+/* that opens the latch, like a path ending on a flop, but data	*/
+/* arriving later, while the latch is transparent, borrows time	*/
+/* from the paths starting at the latch.  The time borrowed is	*/
+/* measured from the data arrival, without the setup time, and	*/
+/* the setup time is checked only against the edge that closes	*/
+/* the latch, so at most the window less the setup time can be	*/
+/* borrowed.  The time borrowed is added to the delay		*/
+/* of the paths starting at the latch, which may make latches	*/
+/* further on borrow more time, so the arrival times already	*/
+/* found are propagated from latch to latch until the times	*/
+/* borrowed no longer change.  No path is traced again.	*/
+/*								*/
+/* A loop of latches that gains time on every pass can never	*/
+/* settle, so after as many passes as there are latches, any	*/
+/* latch still borrowing more is set to borrow its whole	*/
+/* window, and its paths fail.					*/
+/*								*/
+/* For minimum time, the hold check of a path ending on a latch	*/
+/* in a constrained clock domain is made at the edge that	*/
+/* closes the latch.  Without a clock domain, the phase of the	*/
+/* latch enable is not known, so latches are taken to open on	*/
+/* the clock edge after the launching edge and to stay open for	*/
+/* half of the period, and the hold check stays at the opening	*/
+/* edge as for a flop.						*/
+/*								*/
+/* Return the number of latches borrowing time.			*/
+/*--------------------------------------------------------------*/
+
+#define BORROW_TOLERANCE	0.001	/* ps */
+
+int
+latch_borrow(ddataptr pathlist, double period, char minmax)
+{
+    ddataptr testddata;
+    btptr pathbt;
+    connptr srcconn, destconn;
+    latchpath *lpaths, *lp;
+    instptr *latches;
+    double borrow;
+    int numlpaths, maxlpaths, numlatches, maxlatches, numborrow;
+    int pass, lastpass, changed, i;
+
+    lpaths = NULL;
+    latches = NULL;
+    numlpaths = maxlpaths = 0;
+    numlatches = maxlatches = 0;
+
+    /* Collect the paths starting or ending on a latch, and the	*/
+    /* latches at their ends.					*/
+
+    for (testddata = pathlist; testddata; testddata = testddata->next) {
+	if ((numdomains == 1) && (period > 0.0) && (testddata->required == 0.0)
+		&& (minmax == MAXIMUM_TIME))
+	    testddata->required = period;
+
+	for (pathbt = testddata->backtrace; pathbt->next; pathbt = pathbt->next);
+	srcconn = pathbt->receiver;
+	destconn = testddata->backtrace->receiver;
+
+	if (numlpaths == maxlpaths) {
+	    maxlpaths = (maxlpaths == 0) ? 64 : 2 * maxlpaths;
+	    lpaths = (latchpath *)realloc(lpaths, maxlpaths * sizeof(latchpath));
+	}
+	lp = &lpaths[numlpaths];
+	lp->path = testddata;
+	lp->srcinst = (srcconn->refpin && (srcconn->refpin->type & LATCHEN)) ?
+			srcconn->refinst : NULL;
+	lp->destinst = (destconn->refpin && (destconn->refpin->type & LATCHIN)) ?
+			destconn->refinst : NULL;
+	if ((lp->srcinst == NULL) && (lp->destinst == NULL)) continue;
+	numlpaths++;
+	if (lp->destinst == NULL) continue;
+
+	lp->window = latch_window(lp->destinst, period);
+	lp->open = (testddata->required > 0.0) ? testddata->required : period;
+	lp->changed = 0;
+	if (minmax != MAXIMUM_TIME) {
+	    if (lp->destinst->domain != 0)
+		testddata->required += lp->window;
+	    continue;
+	}
+	if (lp->destinst->borrow >= 0.0) {
+	    if (numlatches == maxlatches) {
+		maxlatches = (maxlatches == 0) ? 64 : 2 * maxlatches;
+		latches = (instptr *)realloc(latches, maxlatches * sizeof(instptr));
 	    }
+	    latches[numlatches++] = lp->destinst;
+	    lp->destinst->borrow = -1.0;	/* Mark as counted */
 	}
+    }
+    for (i = 0; i < numlpaths; i++)
+	if (lpaths[i].srcinst) lpaths[i].srcinst->borrow = 0.0;
+    for (i = 0; i < numlatches; i++) latches[i]->borrow = 0.0;
 
-        // Clean up clock2list
-        while (clock2list != NULL) {
-            freeddata = clock2list;
-            clock2list = clock2list->next;
-            free(freeddata);
-        }
+    if (minmax != MAXIMUM_TIME) {
+	free(lpaths);
+	return 0;
+    }
 
-        // Free up clocklist backtraces
-	for (freeddata = clocklist; freeddata; freeddata = freeddata->next) {
-            while (freeddata->backtrace != NULL) {
-		freebt = freeddata->backtrace;
-		testconn = freebt->receiver;
-		freeddata->backtrace = freeddata->backtrace->next;
-                freebt->refcnt--;
-		if (freebt->refcnt == 0) free(freebt);
-		else break;
-		if (testconn->visited != (unsigned char)1)
-		    break;
-		testconn->visited = (unsigned char)0;
+    /* Propagate the time borrowed until no latch changes */
+
+    lastpass = numlatches + 1;
+    for (pass = 0; ; pass++) {
+	changed = 0;
+	for (i = 0; i < numlpaths; i++) {
+	    lp = &lpaths[i];
+	    lp->changed = 0;
+	    if ((lp->destinst == NULL) || (lp->open <= 0.0)) continue;
+	    borrow = lp->path->delay - lp->path->setup - lp->open;
+	    if (lp->srcinst) borrow += lp->srcinst->borrow;
+	    if (borrow > lp->window - lp->path->setup)
+		borrow = lp->window - lp->path->setup;
+	    if (borrow > lp->destinst->borrow + BORROW_TOLERANCE) {
+		lp->destinst->borrow = borrow;
+		lp->changed = 1;
+		changed++;
 	    }
 	}
+	if (changed == 0) break;
+	if (pass == lastpass) {
+	    for (i = 0; i < numlpaths; i++)
+		if (lpaths[i].changed)
+		    lpaths[i].destinst->borrow = lpaths[i].window
+				- lpaths[i].path->setup;
+	    lastpass += numlatches + 1;
+	    if (verbose > 0)
+		fprintf(stdout, "Latch loop gains time on every pass;  "
+			"borrowing the whole window.\n");
+	}
+    }
+    if (verbose > 0)
+	fprintf(stdout, "Latch time borrowing settled after %d passes.\n", pass + 1);
+
+    /* Shift the paths by the time borrowed at each end.  The	*/
+    /* delay of a path includes its setup time, which is only	*/
+    /* required before the edge closing the latch, so a path	*/
+    /* that sets the time borrowed by its latch has no slack.	*/
+
+    for (i = 0; i < numlpaths; i++) {
+	lp = &lpaths[i];
+	if (lp->srcinst) lp->path->delay += lp->srcinst->borrow;
+	if (lp->destinst && (lp->open > 0.0)) {
+	    borrow = lp->path->delay - lp->path->setup - lp->open;
+	    if (borrow > lp->window - lp->path->setup)
+		lp->path->required = lp->open + lp->window;
+	    else if (borrow >= lp->destinst->borrow - BORROW_TOLERANCE)
+		lp->path->required = lp->path->delay;
+	    else
+		lp->path->required = lp->open + lp->destinst->borrow
+			+ lp->path->setup;
+	}
+    }
 
-        // Free up clocklist
-        while (clocklist != NULL) {
-            freeddata = clocklist;
-            clocklist = clocklist->next;
-            free(freeddata);
-        }
+    numborrow = 0;
+    for (i = 0; i < numlatches; i++)
+	if (latches[i]->borrow > 0.0) numborrow++;
+
+    free(latches);
+    free(lpaths);
+    return numborrow;
+}
+
+/*--------------------------------------------------------------*/
+/* Find the clock domains of the endpoints reachable from	*/
+/* connection "testconn", as a mask of domain bits.  Output	*/
+/* pins and flops outside of any clock domain are domain 0.	*/
+/* The mask is saved in the connection, so that each is found	*/
+/* only once.							*/
+/*--------------------------------------------------------------*/
+
+unsigned int
+find_capture_domains(connptr testconn)
+{
+    instptr testinst;
+    netptr loadnet;
+    unsigned int domains;
+    int i;
+
+    if (testconn->domains & DOMAIN_DONE) return testconn->domains;
+    if (testconn->domains & DOMAIN_PENDING) return DOMAIN_ALL;	/* Logic loop */
+
+    testinst = testconn->refinst;
+    if ((testinst == NULL) || (testconn->refpin == NULL))
+	domains = 1;
+    else if (testconn->refpin->type & REGISTER_IN)
+	domains = 1 << testinst->domain;
+    else if (testinst->out_connects == NULL)
+	domains = 0;
+    else {
+	testconn->domains = DOMAIN_PENDING;
+	domains = 0;
+	loadnet = testinst->out_connects->refnet;
+	for (i = 0; i < loadnet->fanout; i++)
+	    domains |= find_capture_domains(loadnet->receivers[i]);
+	domains &= DOMAIN_ALL;
     }
+    testconn->domains = domains | DOMAIN_DONE;
+    return testconn->domains;
 }
 
 /*--------------------------------------------------------------*/
-/* Main program                                                 */
+/* Tag each flop with the clock domain of its clock, by tracing	*/
+/* the clock back with find_clock_source() to the constrained	*/
+/* clock source net nearest the flop, and record the edge of	*/
+/* the clock source that clocks the flop.  Then mark every	*/
+/* connection with the domains of the endpoints downstream, so	*/
+/* that paths that can only end in unrelated domains are not	*/
+/* traced (see find_path_delay()).				*/
+/*								*/
+/* Return the number of flops in a constrained clock domain.	*/
 /*--------------------------------------------------------------*/
 
 int
-main(int objc, char *argv[])
+assign_clock_domains(connlistptr clockedlist, netptr netlist)
 {
-    FILE *flib;
-    FILE *fsrc;
-    FILE *fdly;
-    FILE *fsum;
-    double period = 0.0;
-    double outLoad = 0.0;
-    double inTrans = 0.0;
-    char *delayfile = NULL;
-    char *summaryfile = NULL;
-    char *summarydir = NULL;
-    int ival, firstarg = 1;
-    int longFormat = 0;    // Is the long format option present
-    int numReportPaths = 20;
+    connlistptr testlink;
+    connptr thisconn;
+    instptr testinst;
+    ddataptr clocklist, testclock;
+    btptr backtrace;
+    netptr testnet;
+    short srcdir;
+    int d, i, numclocked;
 
-    // Liberty database
+    numclocked = 0;
+    for (testlink = clockedlist; testlink; testlink = testlink->next) {
+	thisconn = testlink->connection;
+	testinst = thisconn->refinst;
+	if ((testinst == NULL) || (thisconn->refpin == NULL)) continue;
+	srcdir = clock_edge(testinst->refcell);
+
+	clocklist = NULL;
+	find_clock_source(thisconn, &clocklist, NULL, srcdir, (unsigned char)1);
+
+	/* Each backtrace runs from a clock source down to the flop	*/
+	for (testclock = clocklist; testclock; testclock = testclock->next) {
+	    for (backtrace = testclock->backtrace; backtrace;
+			backtrace = backtrace->next) {
+		testnet = backtrace->receiver->refnet;
+		for (d = 1; d < numdomains; d++) {
+		    if (clockdefs[d].source == testnet) {
+			testinst->domain = d;
+			testinst->edge = (backtrace->dir == FALLING) ? FALLING : RISING;
+			break;
+		    }
+		}
+	    }
+	    if (testinst->domain != 0) break;
+	}
+	if (testinst->domain != 0)
+	    numclocked++;
+	else if (verbose > 1)
+	    fprintf(stdout, "Flop \"%s\" is not in any clock domain.\n",
+			testinst->name);
+	free_clock_list(&clocklist, (unsigned char)1);
+    }
 
-    lutable *tables = NULL;
-    cell *cells = NULL;
-    lutable *scalar;
+    for (testnet = netlist; testnet; testnet = testnet->next)
+	for (i = 0; i < testnet->fanout; i++)
+	    find_capture_domains(testnet->receivers[i]);
 
-    // Verilog netlist database
+    return numclocked;
+}
 
-    instptr     instlist = NULL;
-    netptr      netlist = NULL;
-    connlistptr clockconnlist = NULL;
-    connlistptr newinputconn, inputconnlist = NULL;
-    connptr     testconn, inputlist = NULL;
-    connptr     outputlist = NULL;
+/*--------------------------------------------------------------*/
+/* Find the exceptions whose "-to" pattern matches every	*/
+/* endpoint reachable from connection "testconn" (exceptions	*/
+/* without "-to" match all endpoints), as a mask of exception	*/
+/* bits.  The mask is saved in the connection.  While masks	*/
+/* are found, "visited" marks connections in progress (3) and	*/
+/* done (4).							*/
+/*--------------------------------------------------------------*/
 
-    // Timing path database
-    ddataptr    pathlist = NULL;
-    ddataptr    freeddata, testddata, *orderedpaths;
-    btptr       freebt, testbt;
-    int         numpaths, numterms, i;
-    char        badtiming;
-    double      slack;
+unsigned int
+find_exception_ends(connptr testconn)
+{
+    instptr testinst;
+    netptr loadnet;
+    unsigned int exto;
+    int i;
 
-    // Net name hash table
-    struct hashtable Nethash;
+    if (testconn->visited == (unsigned char)4) return testconn->exto;
+    if (testconn->visited == (unsigned char)3) return 0;	/* Logic loop */
 
-    verbose = 0;
-    exhaustive = 0;
-    cleanup = 0;
+    testinst = testconn->refinst;
+    if ((testinst == NULL) || (testconn->refpin == NULL) ||
+		(testconn->refpin->type & REGISTER_IN)) {
+	exto = 0;
+	for (i = 0; i < numexceptions; i++)
+	    if ((exceptions[i].to == NULL) || exceptionMatch(exceptions[i].to,
+			testconn, (unsigned char)0))
+		exto |= (1U << i);
+    }
+    else if (testinst->out_connects == NULL)
+	exto = ~0U;		/* No endpoints */
+    else {
+	testconn->visited = (unsigned char)3;
+	exto = ~0U;
+	loadnet = testinst->out_connects->refnet;
+	for (i = 0; i < loadnet->fanout; i++)
+	    exto &= find_exception_ends(loadnet->receivers[i]);
+    }
+    testconn->exto = exto;
+    testconn->visited = (unsigned char)4;
+    return exto;
+}
 
-    while ((firstarg < objc) && (*argv[firstarg] == '-')) {
-       if (!strcmp(argv[firstarg], "-d") || !strcmp(argv[firstarg], "--delay")) {
-          delayfile = strdup(argv[firstarg + 1]);
-          firstarg += 2;
-       }
-       else if (!strcmp(argv[firstarg], "-p") || !strcmp(argv[firstarg], "--period")) {
-          period = strtod(argv[firstarg + 1], NULL);
-          firstarg += 2;
-       }
-       else if (!strcmp(argv[firstarg], "-l") || !strcmp(argv[firstarg], "--load")) {
-          outLoad = strtod(argv[firstarg + 1], NULL);
-          firstarg += 2;
-       }
-       else if (!strcmp(argv[firstarg], "-t") || !strcmp(argv[firstarg], "--trans")) {
-          inTrans = strtod(argv[firstarg + 1], NULL);
-          firstarg += 2;
-       }
-       else if (!strcmp(argv[firstarg], "-L") || !strcmp(argv[firstarg], "--long")) {
-          longFormat = 1;
-          firstarg++;
-       }
-       else if (!strcmp(argv[firstarg], "-n") || !strcmp(argv[firstarg], "--num-paths")) {
-	  numReportPaths = strtod(argv[firstarg + 1], NULL);
-	  firstarg += 2;
-       }
-       else if (!strcmp(argv[firstarg], "-s") || !strcmp(argv[firstarg], "--summary")) {
-          summaryfile = strdup(argv[firstarg + 1]);
-          /* Rule:  If argument has a file extension, then treat it as a single	*/
-	  /* file and dump all output to it.  If not, then treat it as a	*/
-	  /* directory and create individual files for each timing check.	*/
-          if (strrchr(summaryfile, '.') == NULL) {
-	     summarydir = summaryfile;
-	     summaryfile = NULL;
-	     /* Make directory if it doesn't exist */
-	     mkdir(summarydir, S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
-	  }
-          firstarg += 2;
-       }
-       else if (!strcmp(argv[firstarg], "-v") || !strcmp(argv[firstarg], "--verbose")) {
-          sscanf(argv[firstarg + 1], "%d", &ival);
-          verbose = (unsigned char)ival;
-          firstarg += 2;
-       }
-       else if (!strcmp(argv[firstarg], "-D") || !strcmp(argv[firstarg], "--debug")) {
-          sscanf(argv[firstarg + 1], "%d", &ival);
-          debug = (unsigned char)ival;
-          firstarg += 2;
-       }
-       else if (!strcmp(argv[firstarg], "-e") || !strcmp(argv[firstarg], "--exhaustive")) {
-          exhaustive = 1;
-          firstarg++;
-       }
-       else if (!strcmp(argv[firstarg], "-c") || !strcmp(argv[firstarg], "--cleanup")) {
-          cleanup = 1;
-          firstarg++;
-       }
-       else if (!strcmp(argv[firstarg], "-V") || !strcmp(argv[firstarg], "--version")) {
-          fprintf(stderr, "Vesta Static Timing Analyzer version 0.3\n");
-          exit(0);
-       }
-       else {
-          fprintf(stderr, "Unknown option \"%s\"\n", argv[firstarg]);
-          firstarg++;
-       }
-    }
-
-    if (objc - firstarg < 2) {
-        fprintf(stderr, "Usage:  vesta [options] <name.v> <name.lib> [...]\n");
-        fprintf(stderr, "Options:\n");
-        fprintf(stderr, "--delay <delay_file>   or      -d <delay_file>\n");
-        fprintf(stderr, "--period <period>      or      -p <period>\n");
-        fprintf(stderr, "--load <load>          or      -l <load>\n");
-	fprintf(stderr, "--num-paths <numPaths>	or	-n <numPaths>\n");
-        fprintf(stderr, "--long                 or      -L\n");
-        fprintf(stderr, "--verbose <level>      or      -v <level>\n");
-        fprintf(stderr, "--exhaustive           or      -e\n");
-        fprintf(stderr, "--cleanup              or      -c\n");
-        fprintf(stderr, "--version              or      -V\n");
-        exit (1);
-    }
-    else {
-        fflush(stdout);
-        fprintf(stdout, "----------------------------------------------\n");
-        fprintf(stdout, "Vesta static timing analysis tool\n");
-	fprintf(stdout, "for qflow " QFLOW_VERSION "." QFLOW_REVISION "\n");
-        fprintf(stdout, "(c) 2013-2018 Tim Edwards, Open Circuit Design\n");
-        fprintf(stdout, "----------------------------------------------\n\n");
-        fflush(stdout);
-    }
-
-    fsrc = fopen(argv[firstarg], "r");
-    if (fsrc == NULL) {
-        fprintf(stderr, "Cannot open %s for reading\n", argv[firstarg]);
-        exit (1);
-    }
-    fclose(fsrc);
-
-    /*------------------------------------------------------------------*/
-    /* Generate one table template for the "scalar" case                */
-    /*------------------------------------------------------------------*/
+/*--------------------------------------------------------------*/
+/* Compile the path exceptions into flags on each connection:	*/
+/* the exceptions having a "-through" point at the connection,	*/
+/* and the exceptions matching all of the endpoints downstream	*/
+/* of the connection.  From these, find_path_delay() stops on	*/
+/* the first connection past which all paths are false.		*/
+/*--------------------------------------------------------------*/
 
-    scalar = (lutable *)malloc(sizeof(lutable));
-    scalar->name = strdup("scalar");
-    scalar->invert = 0;
-    scalar->var1 = CONSTRAINED_TIME;
-    scalar->var2 = OUTPUT_CAP;
-    scalar->size1 = 1;
-    scalar->size2 = 1;
-    scalar->idx1.times = (double *)malloc(sizeof(double));
-    scalar->idx2.caps = (double *)malloc(sizeof(double));
-    scalar->values = (double *)malloc(sizeof(double));
+void
+compile_exceptions(netptr netlist)
+{
+    netptr testnet;
+    connptr testconn;
+    int i, j, drvmatch;
 
-    scalar->idx1.times[0] = 0.0;
-    scalar->idx2.caps[0] = 0.0;
-    scalar->values[0] = 0.0;
+    thrumask = 0;
+    for (j = 0; j < numexceptions; j++)
+	if (exceptions[j].through != NULL)
+	    thrumask |= (1U << j);
 
-    scalar->next = NULL;
-    tables = scalar;
+    /* A "-through" pin on the driver of a net counts for its receivers */
 
-    /*------------------------------------------------------------------*/
-    /* Read all liberty format files (everything on the command line	*/
-    /* after the verilog source file).					*/
-    /*------------------------------------------------------------------*/
+    for (testnet = netlist; testnet; testnet = testnet->next) {
+	for (j = 0; j < numexceptions; j++) {
+	    if (exceptions[j].through == NULL) continue;
+	    drvmatch = ((testnet->driver != NULL) && exceptionMatch(
+			exceptions[j].through, testnet->driver, (unsigned char)1));
+	    for (i = 0; i < testnet->fanout; i++) {
+		testconn = testnet->receivers[i];
+		if (drvmatch || exceptionMatch(exceptions[j].through, testconn,
+			(unsigned char)1))
+		    testconn->exthru |= (1U << j);
+	    }
+	}
+    }
 
-    for (i = 1; firstarg + i < objc; i++) {
+    for (testnet = netlist; testnet; testnet = testnet->next)
+	for (i = 0; i < testnet->fanout; i++)
+	    find_exception_ends(testnet->receivers[i]);
 
-	flib = fopen(argv[firstarg + i], "r");
-	if (flib == NULL) {
-	    fprintf(stderr, "Cannot open %s for reading\n", argv[firstarg + i]);
-	    exit (1);
-	}
+    for (testnet = netlist; testnet; testnet = testnet->next)
+	for (i = 0; i < testnet->fanout; i++)
+	    testnet->receivers[i]->visited = (unsigned char)0;
+}
 
-	/*------------------------------------------------------------------*/
-	/* Read the liberty format file.  This is not a rigorous parser!    */
-	/*------------------------------------------------------------------*/
+/*--------------------------------------------------------------*/
+/* Path group of a path:  the clock domain of the flop at its	*/
+/* end, or of the flop at its start for a path to an output	*/
+/* pin, or 0 for paths timed by the period given to vesta.	*/
+/*--------------------------------------------------------------*/
 
-	fileCurrentLine = 0;
-	libertyRead(flib, &tables, &cells);
-	fflush(stdout);
-	fprintf(stdout, "Lib read %s:  Processed %d lines.\n", argv[firstarg + i],
-			fileCurrentLine);
-	if (flib != NULL) fclose(flib);
-    }
+static int
+path_group(ddataptr testddata)
+{
+    btptr testbt;
+    instptr testinst;
 
-    /*--------------------------------------------------*/
-    /* Debug:  Print summary of liberty database        */
-    /*--------------------------------------------------*/
+    testinst = testddata->backtrace->receiver->refinst;
+    if ((testinst != NULL) && (testinst->domain != 0)) return testinst->domain;
+    for (testbt = testddata->backtrace; testbt->next; testbt = testbt->next);
+    testinst = testbt->receiver->refinst;
+    return (testinst != NULL) ? testinst->domain : 0;
+}
 
-    if (verbose > 3) {
+/*--------------------------------------------------------------*/
+/* Record on each net of the paths in "pathlist" the worst	*/
+/* slack and the highest criticality of any path through it,	*/
+/* for the net slack file (see write_net_slack()).  The net of	*/
+/* the clock at the path start is not part of the path.		*/
+/* "period" is the time allowed for paths without a required	*/
+/* time of their own.						*/
+/*								*/
+/* The criticality of a path is relative to its own path group	*/
+/* (see path_group()):  1 for the worst negative slack of the	*/
+/* group, falling linearly to 0 for a slack of the clock period	*/
+/* of the group.  A multicycle path is then not critical for	*/
+/* being long, and the nets of one clock domain are ranked	*/
+/* whether or not another domain fails by far more.		*/
+/*--------------------------------------------------------------*/
 
-        lutable *newtable;
-        cell *newcell;
-        pin *newpin;
+void
+net_slack(ddataptr pathlist, double period)
+{
+    ddataptr testddata;
+    btptr testbt;
+    netptr testnet;
+    double reqtime, slack, ref, crit;
+    double worst[MAX_DOMAINS];
+    int group;
 
-        for (newtable = tables; newtable; newtable = newtable->next) {
-            fprintf(stdout, "Table: %s\n", newtable->name);
-        }
+    /* Worst negative slack of each path group */
 
-        for (newcell = cells; newcell; newcell = newcell->next) {
-            fprintf(stdout, "Cell: %s\n", newcell->name);
-            fprintf(stdout, "   Function: %s\n", newcell->function);
-            for (newpin = newcell->pins; newpin; newpin = newpin->next) {
-                if (newpin->type == INPUT)
-                    fprintf(stdout, "   Pin: %s  cap=%g\n", newpin->name, newpin->capr);
-            }
-            fprintf(stdout, "\n");
-        }
+    for (group = 0; group < numdomains; group++) worst[group] = 0.0;
+    for (testddata = pathlist; testddata; testddata = testddata->next) {
+	reqtime = (testddata->required > 0.0) ? testddata->required : period;
+	if (reqtime <= 0.0) continue;
+	slack = reqtime - testddata->delay;
+	group = path_group(testddata);
+	if (slack < worst[group]) worst[group] = slack;
     }
 
-    /*------------------------------------------------------------------*/
-    /* Read verilog netlist.  This is also not a rigorous parser!       */
-    /*------------------------------------------------------------------*/
-
-    /* See hash.c for these routines and variables */
-    hashfunc = hash;
-    matchfunc = match;
+    for (testddata = pathlist; testddata; testddata = testddata->next) {
+	reqtime = (testddata->required > 0.0) ? testddata->required : period;
+	if (reqtime <= 0.0) continue;
+	slack = reqtime - testddata->delay;
+	group = path_group(testddata);
+	ref = (group != 0) ? clockdefs[group].period : period;
+	if (ref <= 0.0) ref = reqtime;
+	crit = (ref - slack) / (ref - worst[group]);
+	if (crit > 1.0) crit = 1.0;
+	if (crit < 0.0) crit = 0.0;
+	for (testbt = testddata->backtrace; testbt->next; testbt = testbt->next) {
+	    testnet = testbt->receiver->refnet;
+	    if (slack < testnet->slack) testnet->slack = slack;
+	    if (crit > testnet->crit) testnet->crit = crit;
+	}
+    }
+}
 
-    /* Initialize net hash table */
-    InitializeHashTable(&Nethash, LARGEHASHSIZE);
+/*--------------------------------------------------------------*/
+/* Write the worst slack and the criticality of each net found	*/
+/* by net_slack() to file "filename", one net per line, in one	*/
+/* pass over the nets.  Nets not on any path checked are not	*/
+/* written.							*/
+/* Return the number of nets written, or -1 on error.		*/
+/*--------------------------------------------------------------*/
 
-    fileCurrentLine = 0;
+int
+write_net_slack(char *filename, netptr netlist)
+{
+    FILE *fslack;
+    netptr testnet;
+    int numnets = 0;
 
-    verilogRead(argv[firstarg], cells, &netlist, &instlist, &inputlist, &outputlist,
-		&Nethash);
+    fslack = fopen(filename, "w");
+    if (fslack == NULL) {
+	fprintf(stderr, "Cannot open %s for writing\n", filename);
+	return -1;
+    }
 
-    if (delayfile != NULL) {
-        fdly = fopen(delayfile, "r");
+    fprintf(fslack, "# Net worst slack (ps) and criticality from vesta\n");
+    fprintf(fslack, "# criticality = (period - slack) / (period - worst), "
+		"with the clock period\n# and worst negative slack of the "
+		"path group\n");
 
-        if (fdly == NULL) {
-            fprintf(stderr, "Cannot open %s for reading\n", delayfile);
-            exit (1);
-        }
+    for (testnet = netlist; testnet; testnet = testnet->next) {
+	if (testnet->slack >= NOSLACK) continue;
+	fprintf(fslack, "%s %g %.3f\n", testnet->name, testnet->slack,
+		testnet->crit);
+	numnets++;
     }
-    else
-	fdly = NULL;
-
-    fflush(stdout);
-    fprintf(stdout, "Verilog netlist read:  Processed %d lines.\n", vlinenum);
+    fclose(fslack);
+    return numnets;
+}
 
-    /*--------------------------------------------------*/
-    /* Debug:  Print summary of verilog source          */
-    /*--------------------------------------------------*/
+/*--------------------------------------------------------------*/
+/* In low-memory mode, report the peak memory used by the end	*/
+/* of phase "phase" of the analysis.				*/
+/*--------------------------------------------------------------*/
 
-    if (verbose > 2) {
-        connect *testoutput;
-        connect *testinput;
-        net *testnet;
-        instance *testinst;
+void
+memory_report(char *phase)
+{
+    if (!lowmem) return;
+    fprintf(stdout, "Peak memory after %s:  %ld MB\n", phase,
+		ProfilePeakMemory() / 1024);
+    fflush(stdout);
+}
 
-        for (testinput = inputlist; testinput; testinput = testinput->next) {
-            if (testinput->refnet)
-                fprintf(stdout, "   Input: %s\n", testinput->refnet->name);
-        }
-        for (testoutput = outputlist; testoutput; testoutput = testoutput->next) {
-            if (testoutput->refnet)
-                fprintf(stdout, "   Output: %s\n", testoutput->refnet->name);
-        }
-        for (testnet = netlist; testnet; testnet = testnet->next) {
-            fprintf(stdout, "   Net: %s\n", testnet->name);
-        }
-        for (testinst = instlist; testinst; testinst = testinst->next) {
-            fprintf(stdout, "   Gate: %s\n", testinst->name);
-        }
-    }
+/*--------------------------------------------------------------*/
+/* Open the summary file of one timing check in directory	*/
+/* "summarydir".  With more than one corner, the corner name	*/
+/* is added to the file name.					*/
+/*--------------------------------------------------------------*/
 
-    /*--------------------------------------------------*/
-    /* Generate internal links representing the network */
-    /*--------------------------------------------------*/
+static FILE *
+summaryOpen(char *summarydir, char *check, char *cornername)
+{
+    char *summaryfile;
+    FILE *fsum;
 
-    createLinks(netlist, instlist, inputlist, outputlist);
+    summaryfile = (char *)malloc(strlen(summarydir) + strlen(check) +
+		((cornername) ? strlen(cornername) + 1 : 0) + 6);
+    if (cornername != NULL)
+	sprintf(summaryfile, "%s/%s_%s.log", summarydir, check, cornername);
+    else
+	sprintf(summaryfile, "%s/%s.log", summarydir, check);
+    fsum = fopen(summaryfile, "w");
+    if (fsum == NULL)
+	fprintf(stderr, "Cannot open %s for writing\n", summaryfile);
+    free(summaryfile);
+    return fsum;
+}
 
-    /* Generate a connection list from inputlist */
+static void
+summaryHeader(FILE *fsum, char *check, char *cornername)
+{
+    fprintf(fsum, "Vesta static timing analysis, %s", check);
+    if (cornername != NULL)
+	fprintf(fsum, ", corner %s", cornername);
+    fprintf(fsum, "\n");
+}
 
-    for (testconn = inputlist; testconn; testconn = testconn->next) {
-        newinputconn = (connlistptr)malloc(sizeof(connlist));
-        newinputconn->connection = testconn;
-        newinputconn->next = inputconnlist;
-        inputconnlist = newinputconn;
-    }
+/*--------------------------------------------------------------*/
+/* Find and report the maximum and minimum delay paths from	*/
+/* clocks and from inputs.  "fsum" is the summary file, if all	*/
+/* checks go to one file, or NULL.  The worst delays and slacks,	*/
+/* the pass/fail status, and the reported maximum delay paths	*/
+/* are returned in "result".					*/
+/*--------------------------------------------------------------*/
 
-    /*--------------------------------------------------*/
-    /* Assign net types, mainly to identify clocks      */
-    /* Return a list of clock nets                      */
-    /*--------------------------------------------------*/
+/*--------------------------------------------------------------*/
+/* Name of a path start or end point, as "instance/pin", or the	*/
+/* net name of a pin.  The string is allocated.			*/
+/*--------------------------------------------------------------*/
 
-    numterms = assign_net_types(netlist, &clockconnlist);
+static char *
+pathPointName(connptr conn)
+{
+    char *name;
 
-    if (verbose > 2)
-        fprintf(stdout, "Number of terminals to check: %d\n", numterms);
+    if (conn->refinst == NULL) return strdup(conn->refnet->name);
+    name = (char *)malloc(strlen(conn->refinst->name) +
+		strlen(conn->refpin->name) + 2);
+    sprintf(name, "%s/%s", conn->refinst->name, conn->refpin->name);
+    return name;
+}
 
-    /*--------------------------------------------------*/
-    /* Calculate total load on each net                 */
-    /* To do:  Add wire models or computed wire delays  */
-    /*--------------------------------------------------*/
+static void
+pathsFree(VestaPath *paths, int numpaths)
+{
+    int i;
 
-    if (fdly != NULL) {
-        delayRead(fdly, &Nethash);
-        fclose(fdly);
+    for (i = 0; i < numpaths; i++) {
+	free(paths[i].start);
+	free(paths[i].end);
     }
+    free(paths);
+}
 
-    /* Hash table no longer needed */
-    HashKill(&Nethash);
-
-    computeLoads(netlist, instlist, outLoad);
+static void
+analyzeTiming(netptr netlist, connptr inputlist, connlistptr clockconnlist,
+		connlistptr inputconnlist, double period, int numReportPaths,
+		int longFormat, FILE *fsum, char *summarydir, char *cornername,
+		timingresult *result)
+{
+    ddataptr    pathlist = NULL;
+    ddataptr    freeddata, testddata, *orderedpaths;
+    btptr       freebt, testbt;
+    connptr     testconn;
+    int         numpaths, i;
+    char        badtiming;
+    double      slack, reqtime;
+    int         numborrow;
 
     /*--------------------------------------------------*/
     /* Identify all clock-to-terminal paths             */
@@ -4097,6 +6389,14 @@ main(int objc, char *argv[])
 	fprintf(stdout, "Starting timing analysis.\n");
 	fflush(stdout);
     }
+
+    /* Clock arrival times at this corner, for the clock skews */
+
+    ProfileBegin("clock tree");
+    clock_tree_build(clockconnlist);
+    ProfileEnd();
+
+    ProfileBegin("maximum delay paths");
     numpaths = find_clock_to_term_paths(clockconnlist, &pathlist, netlist, MAXIMUM_TIME);
     fprintf(stdout, "Number of paths analyzed:  %d\n", numpaths);
     fflush(stdout);
@@ -4107,6 +6407,41 @@ main(int objc, char *argv[])
 
     find_clock_skews(pathlist, MAXIMUM_TIME);
 
+    /* Paths with only one end in a constrained clock domain (such as	*/
+    /* register-to-output paths) get the period of that domain,	*/
+    /* preferring the launching clock.  Paths with neither end in a	*/
+    /* constrained domain get the period, and multicycle paths get	*/
+    /* more cycles of the capture clock.				*/
+
+    for (testddata = pathlist; testddata; testddata = testddata->next) {
+	if ((numdomains > 1) && (testddata->required == 0.0)) {
+	    instptr srcinst, destinst;
+
+	    for (testbt = testddata->backtrace; testbt->next; testbt = testbt->next);
+	    srcinst = testbt->receiver->refinst;
+	    destinst = testddata->backtrace->receiver->refinst;
+	    if ((srcinst != NULL) && (srcinst->domain != 0))
+		testddata->required = clockdefs[srcinst->domain].period;
+	    else if ((destinst != NULL) && (destinst->domain != 0))
+		testddata->required = clockdefs[destinst->domain].period;
+	    else
+		testddata->required = period;
+	}
+	if (testddata->cycles > 1) {
+	    instptr testinst = testddata->backtrace->receiver->refinst;
+	    double cperiod = ((testinst != NULL) && (testinst->domain != 0)) ?
+			clockdefs[testinst->domain].period : period;
+	    reqtime = (testddata->required > 0.0) ? testddata->required : period;
+	    if (reqtime > 0.0)
+		testddata->required = reqtime + (testddata->cycles - 1) * cperiod;
+	}
+    }
+
+    if (latchmode) {
+	numborrow = latch_borrow(pathlist, period, MAXIMUM_TIME);
+	fprintf(stdout, "Latches borrowing time:  %d\n", numborrow);
+    }
+
     /*--------------------------------------------------*/
     /* Collect paths into a non-linked array so that    */
     /* they can be sorted by delay time                 */
@@ -4122,40 +6457,74 @@ main(int objc, char *argv[])
 
     qsort(orderedpaths, numpaths, sizeof(ddataptr), (__compar_fn_t)compdelay);
 
+    /* With clock domains but no period, paths with neither end in a	*/
+    /* constrained domain have no required time and are not checked.	*/
+    /* List them after all of the paths that are checked.		*/
+
+    if ((numdomains > 1) && (period == 0.0)) {
+	ddataptr *checkedpaths;
+	int j = 0;
+
+	checkedpaths = (ddataptr *)malloc(numpaths * sizeof(ddataptr));
+	for (i = 0; i < numpaths; i++)
+	    if (orderedpaths[i]->required != 0.0)
+		checkedpaths[j++] = orderedpaths[i];
+	for (i = 0; i < numpaths; i++)
+	    if (orderedpaths[i]->required == 0.0)
+		checkedpaths[j++] = orderedpaths[i];
+	free(orderedpaths);
+	orderedpaths = checkedpaths;
+    }
+
+    /* The verdict is over all paths, not only those reported */
+
+    badtiming = 0;
+    result->constrained = 0;
+    result->setupslack = 0.0;
+    for (i = 0; i < numpaths; i++) {
+	testddata = orderedpaths[i];
+	reqtime = (testddata->required > 0.0) ? testddata->required : period;
+	if (reqtime > 0.0) {
+	    slack = reqtime - testddata->delay;
+	    if (!result->constrained || (slack < result->setupslack))
+		result->setupslack = slack;
+	    result->constrained = 1;
+	    if (testddata->delay > reqtime) badtiming = 1;
+	}
+    }
+
+    /* Without a clock period, net slack is relative to the longest path */
+    if (netslack)
+	net_slack(pathlist, ((period > 0.0) || (numdomains > 1) || (numpaths == 0))
+		? period : orderedpaths[0]->delay);
+
     /*----------------------------------------------------*/
     /* Report on top <numReportPaths> maximum delay paths */
     /*----------------------------------------------------*/
 
-    if (summarydir != NULL) {
-        summaryfile = (char *)malloc(256);
-	sprintf(summaryfile, "%s/reg_to_reg_max.log", summarydir);
-    }
-    if (summaryfile != NULL) {
-        fsum = fopen(summaryfile, "w");
-        if (fsum == NULL) {
-            fprintf(stderr, "Cannot open %s for writing\n", summaryfile);
-	    if (summarydir == NULL) {
- 		free(summaryfile);
-		summaryfile = NULL;
-	    }
-        }
-    }
-    else
-	fsum = NULL;
+    if (summarydir != NULL)
+	fsum = summaryOpen(summarydir, "reg_to_reg_max", cornername);
     if (fsum)
-	fprintf(fsum, "Vesta static timing analysis, "
-			"register-to-register maximum timing\n");
+	summaryHeader(fsum, "register-to-register maximum timing", cornername);
 
     fprintf(stdout, "\nTop %d maximum delay paths:\n", (numpaths >= numReportPaths)
 		? numReportPaths : numpaths);
     if (fsum)
 	fprintf(fsum, "\nTop %d maximum delay paths:\n", (numpaths >= numReportPaths)
 		? numReportPaths : numpaths);
-    badtiming = 0;
+    result->numpaths = (numpaths >= numReportPaths) ? numReportPaths : numpaths;
+    result->paths = (VestaPath *)malloc(result->numpaths * sizeof(VestaPath));
     for (i = 0; ((i < numReportPaths) && (i < numpaths)); i++) {
         testddata = orderedpaths[i];
         for (testbt = testddata->backtrace; testbt->next; testbt = testbt->next);
 
+        reqtime = (testddata->required > 0.0) ? testddata->required : period;
+	result->paths[i].start = pathPointName(testbt->receiver);
+	result->paths[i].end = pathPointName(testddata->backtrace->receiver);
+	result->paths[i].delay = testddata->delay;
+	result->paths[i].slack = (reqtime > 0.0) ? reqtime - testddata->delay : 0.0;
+	result->paths[i].checked = (reqtime > 0.0);
+
         if (testddata->backtrace->receiver->refinst != NULL) {
             fprintf(stdout, "Path %s/%s to %s/%s delay %g ps",
                         testbt->receiver->refinst->name,
@@ -4183,11 +6552,11 @@ main(int objc, char *argv[])
                         testddata->delay);
         }
 
-        if (period > 0.0) {
-            slack = period - testddata->delay;
+        reqtime = (testddata->required > 0.0) ? testddata->required : period;
+        if (reqtime > 0.0) {
+            slack = reqtime - testddata->delay;
             fprintf(stdout, "   Slack = %g ps", slack);
             if (fsum) fprintf(fsum, "   Slack = %g ps", slack);
-            if (slack < 0.0) badtiming = 1;
         }
         fprintf(stdout, "\n");
         if (fsum) fprintf(fsum, "\n");
@@ -4198,17 +6567,28 @@ main(int objc, char *argv[])
 	    if (longFormat) {
 		fprintf(stdout, "   clock skew at destination = %g\n", testddata->skew);
 		fprintf(stdout, "   setup at destination = %g\n", testddata->setup);
+		if (latchmode && (testddata->backtrace->receiver->refpin->type
+			& LATCHIN))
+		    fprintf(stdout, "   time borrowed at destination = %g\n",
+			testddata->backtrace->receiver->refinst->borrow);
 		fprintf(stdout, "\n");
 	    }
 	    if (fsum) {
 		fprintf(fsum, "   clock skew at destination = %g\n", testddata->skew);
 		fprintf(fsum, "   setup at destination = %g\n", testddata->setup);
+		if (latchmode && (testddata->backtrace->receiver->refpin->type
+			& LATCHIN))
+		    fprintf(fsum, "   time borrowed at destination = %g\n",
+			testddata->backtrace->receiver->refinst->borrow);
 		fprintf(fsum, "\n");
 	    }
 	}
     }
 
-    if (period > 0.0) {
+    result->maxdelay = (numpaths > 0) ? orderedpaths[0]->delay : 0.0;
+    result->setupfail = badtiming;
+
+    if ((period > 0.0) || (numdomains > 1)) {
         if (badtiming) {
             fprintf(stdout, "ERROR:  Design fails timing requirements.\n");
             if (fsum) fprintf(fsum, "ERROR:  Design fails timing requirements.\n");
@@ -4247,17 +6627,21 @@ main(int objc, char *argv[])
     }
 
     free(orderedpaths);
+    ProfileEnd();
+    memory_report("maximum delay paths");
 
     /*--------------------------------------------------*/
     /* Now calculate minimum delay paths                */
     /*--------------------------------------------------*/
 
+    ProfileBegin("minimum delay paths");
     reset_all(netlist, MINIMUM_TIME);
     numpaths = find_clock_to_term_paths(clockconnlist, &pathlist, netlist, MINIMUM_TIME);
     fprintf(stdout, "Number of paths analyzed:  %d\n", numpaths);
     fflush(stdout);
 
     find_clock_skews(pathlist, MINIMUM_TIME);
+    if (latchmode) latch_borrow(pathlist, period, MINIMUM_TIME);
 
     /*--------------------------------------------------*/
     /* Collect paths into a non-linked array so that    */
@@ -4274,27 +6658,31 @@ main(int objc, char *argv[])
 
     qsort(orderedpaths, numpaths, sizeof(ddataptr), (__compar_fn_t)compdelay);
 
+    /* The verdict is over all paths, not only those reported */
+
+    badtiming = 0;
+    result->holdslack = 0.0;
+    for (i = 0; i < numpaths; i++) {
+	slack = orderedpaths[i]->delay - orderedpaths[i]->required;
+	if ((i == 0) || (slack < result->holdslack)) result->holdslack = slack;
+	if (orderedpaths[i]->delay < orderedpaths[i]->required) badtiming = 1;
+    }
+
     /*----------------------------------------------------*/
     /* Report on top <numReportPaths> minimum delay paths */
     /*----------------------------------------------------*/
 
     if (summarydir != NULL) {
         if (fsum != NULL) fclose(fsum);
-	sprintf(summaryfile, "%s/reg_to_reg_min.log", summarydir);
-        fsum = fopen(summaryfile, "w");
-        if (fsum == NULL) {
-	    fprintf(stderr, "Cannot open %s for writing\n", summaryfile);
-	}
+	fsum = summaryOpen(summarydir, "reg_to_reg_min", cornername);
     }
     if (fsum)
-	fprintf(fsum, "Vesta static timing analysis, "
-			"register-to-register minimum timing\n");
+	summaryHeader(fsum, "register-to-register minimum timing", cornername);
 
     fprintf(stdout, "\nTop %d minimum delay paths:\n", (numpaths >= numReportPaths) ?
 		numReportPaths : numpaths);
     if (fsum) fprintf(fsum, "\nTop %d minimum delay paths:\n",
 		(numpaths >= numReportPaths) ?  numReportPaths : numpaths);
-    badtiming = 0;
     for (i = numpaths; (i > (numpaths - numReportPaths)) && (i > 0); i--) {
         testddata = orderedpaths[i - 1];
         for (testbt = testddata->backtrace; testbt->next; testbt = testbt->next);
@@ -4341,9 +6729,10 @@ main(int objc, char *argv[])
 		fprintf(fsum, "\n");
 	    }
 	}
-
-        if (testddata->delay < 0.0) badtiming = 1;
     }
+    result->mindelay = (numpaths > 0) ? orderedpaths[numpaths - 1]->delay : 0.0;
+    result->holdfail = badtiming;
+
     if (badtiming) {
         fprintf(stdout, "ERROR:  Design fails minimum hold timing.\n");
         if (fsum) fprintf(fsum, "ERROR:  Design fails minimum hold timing.\n");
@@ -4375,6 +6764,8 @@ main(int objc, char *argv[])
     }
 
     free(orderedpaths);
+    ProfileEnd();
+    memory_report("minimum delay paths");
 
     for (testconn = inputlist; testconn; testconn = testconn->next) {
         testconn->tag = NULL;
@@ -4385,6 +6776,7 @@ main(int objc, char *argv[])
     /* Identify all input-to-terminal paths             */
     /*--------------------------------------------------*/
 
+    ProfileBegin("input paths");
     reset_all(netlist, MAXIMUM_TIME);
     numpaths = find_clock_to_term_paths(inputconnlist, &pathlist, netlist, MAXIMUM_TIME);
     fprintf(stdout, "Number of paths analyzed:  %d\n", numpaths);
@@ -4413,15 +6805,10 @@ main(int objc, char *argv[])
 
     if (summarydir != NULL) {
         if (fsum != NULL) fclose(fsum);
-	sprintf(summaryfile, "%s/pin_to_reg_max.log", summarydir);
-        fsum = fopen(summaryfile, "w");
-        if (fsum == NULL) {
-	    fprintf(stderr, "Cannot open %s for writing\n", summaryfile);
-	}
+	fsum = summaryOpen(summarydir, "pin_to_reg_max", cornername);
     }
     if (fsum)
-	fprintf(fsum, "Vesta static timing analysis, "
-			"pin-to-register and register-to-pin maximum timing\n");
+	summaryHeader(fsum, "pin-to-register and register-to-pin maximum timing", cornername);
 
     fprintf(stdout, "\nTop %d maximum delay paths:\n", (numpaths >= numReportPaths) ?
 			numReportPaths : numpaths);
@@ -4529,15 +6916,10 @@ main(int objc, char *argv[])
 
     if (summarydir != NULL) {
         if (fsum != NULL) fclose(fsum);
-	sprintf(summaryfile, "%s/pin_to_reg_min.log", summarydir);
-        fsum = fopen(summaryfile, "w");
-        if (fsum == NULL) {
-	    fprintf(stderr, "Cannot open %s for writing\n", summaryfile);
-	}
+	fsum = summaryOpen(summarydir, "pin_to_reg_min", cornername);
     }
     if (fsum)
-	fprintf(fsum, "Vesta static timing analysis, "
-			"pin-to-register and register-to-pin minimum timing\n");
+	summaryHeader(fsum, "pin-to-register and register-to-pin minimum timing", cornername);
 
     fprintf(stdout, "\nTop %d minimum delay paths:\n", (numpaths >= numReportPaths) ?
 			numReportPaths : numpaths);
@@ -4589,9 +6971,7 @@ main(int objc, char *argv[])
     if (fsum) fprintf(fsum, "-----------------------------------------\n\n");
     fflush(stdout);
 
-    if (fsum != NULL) fclose(fsum);
-    if (summaryfile != NULL) free(summaryfile);
-    if (summarydir != NULL) free(summarydir);
+    if ((summarydir != NULL) && (fsum != NULL)) fclose(fsum);
 
     /*--------------------------------------------------*/
     /* Clean up the path list                           */
@@ -4611,6 +6991,707 @@ main(int objc, char *argv[])
     }
 
     free(orderedpaths);
+    clock_tree_free();
+    ProfileEnd();
+    memory_report("input paths");
+}
+
+/*--------------------------------------------------------------*/
+/* Read the liberty file "libfile" into the corner "cornerptr".	*/
+/* Returns 0 on success, 1 if the file cannot be opened or read.	*/
+/*--------------------------------------------------------------*/
+
+static int
+libraryRead(corner *cornerptr, char *libfile)
+{
+    FILE *flib;
+    int status;
+
+    flib = fopen(libfile, "r");
+    if (flib == NULL) {
+	fprintf(stderr, "Cannot open %s for reading\n", libfile);
+	return 1;
+    }
+
+    /*--------------------------------------------------------------*/
+    /* Read the liberty format file.  This is not a rigorous parser! */
+    /*--------------------------------------------------------------*/
+
+    fileCurrentLine = 0;
+    status = libertyRead(flib, &cornerptr->tables, &cornerptr->cells);
+    fflush(stdout);
+    fprintf(stdout, "Lib read %s:  Processed %d lines.\n", libfile,
+		fileCurrentLine);
+    fclose(flib);
+    return status;
+}
+
+/*--------------------------------------------------------------*/
+/* Liberty database kept by the caller between runs of		*/
+/* VestaRun(), so that the liberty files are parsed only once	*/
+/* (see vesta.h).  VestaReadLiberty() creates the database if	*/
+/* "*lib" is NULL, and otherwise adds the cells of "libfile"	*/
+/* to it.  Returns 0 on success, 1 on error.			*/
+/*--------------------------------------------------------------*/
 
+int
+VestaReadLiberty(VestaLibrary *lib, char *libfile)
+{
+    corner *newlib;
+
+    if (*lib != NULL) return libraryRead(*lib, libfile);
+
+    newlib = (cornerptr)calloc(1, sizeof(corner));
+    newlib->name = strdup("default");
+    newlib->tables = scalar_table();
+    if (libraryRead(newlib, libfile) != 0) {
+	cornerFree(newlib);
+	return 1;
+    }
+    *lib = newlib;
     return 0;
 }
+
+void
+VestaFreeLiberty(VestaLibrary lib)
+{
+    if (lib != NULL) cornerFree(lib);
+}
+
+void
+VestaFreeResults(VestaResults *results)
+{
+    pathsFree(results->paths, results->numpaths);
+    results->paths = NULL;
+    results->numpaths = 0;
+}
+
+/*--------------------------------------------------------------*/
+/* Main program                                                 */
+/*--------------------------------------------------------------*/
+
+/*--------------------------------------------------------------*/
+/* Run static timing analysis.  "objc" and "argv" are the	*/
+/* vesta command line.  If "topcell" is non-NULL, it is a	*/
+/* netlist already read by ReadVerilog() and the command line	*/
+/* has only Liberty files after the options;  "topcell" is not	*/
+/* modified.  If "lib" is non-NULL, it is the liberty database	*/
+/* of the first corner (see VestaReadLiberty()), and is not	*/
+/* modified;  the command line then lists no Liberty files.	*/
+/* If "runresults" is non-NULL, it receives the results of the	*/
+/* worst corner.  Returns 0 on success, 1 on error.  This is	*/
+/* the whole of the vesta program, and is also called by	*/
+/* libqflow.							*/
+/*--------------------------------------------------------------*/
+
+int
+VestaRun(int objc, char *argv[], struct cellrec *topcell, VestaLibrary lib,
+		VestaResults *runresults)
+{
+    FILE *fsrc;
+    FILE *fdly;
+    FILE *fsum;
+    double period = 0.0;
+    double outLoad = 0.0;
+    double inTrans = 0.0;
+    char *delayfile = NULL;
+    char *clockfile = NULL;
+    char *summaryfile = NULL;
+    char *summarydir = NULL;
+    char *slackfile = NULL;
+    int ival, firstarg = 1;
+    int longFormat = 0;    // Is the long format option present
+    int numReportPaths = 20;
+
+    // Liberty database, one per corner
+
+    corner *corners = NULL, *lastcorner = NULL;
+    cornerptr newcorner, testcorner;
+    int numcorners = 0;
+    char *libfile, *libnext;
+
+    // Verilog netlist database
+
+    instptr     instlist = NULL;
+    netptr      netlist = NULL;
+    connlistptr clockconnlist = NULL;
+    connlistptr newinputconn, inputconnlist = NULL;
+    connptr     testconn, inputlist = NULL;
+    connptr     outputlist = NULL;
+
+    // Timing analysis results, one per corner
+    timingresult *results;
+    int         numterms, i;
+
+    // Net name hash table
+    struct hashtable Nethash;
+
+    int libarg, result = 1;
+
+    if (runresults != NULL) memset(runresults, 0, sizeof(VestaResults));
+    Nethash.hashtab = NULL;
+    verbose = 0;
+    debug = 0;
+    exhaustive = 0;
+    cleanup = 0;
+    latchmode = 0;
+    netslack = 0;
+    lowmem = 0;
+    derate[MINIMUM_TIME] = derate[MAXIMUM_TIME] = 1.0;
+
+    numdomains = 1;
+    clockdefs[0].name = NULL;
+    clockdefs[0].source = NULL;
+    clockdefs[0].related = DOMAIN_ALL;
+    pathmask = 0;
+    numexceptions = 0;
+    thrumask = pathfalse = pathmulti = 0;
+
+    while ((firstarg < objc) && (*argv[firstarg] == '-')) {
+       if (!strcmp(argv[firstarg], "-d") || !strcmp(argv[firstarg], "--delay")) {
+          delayfile = strdup(argv[firstarg + 1]);
+          firstarg += 2;
+       }
+       else if (!strcmp(argv[firstarg], "-k") || !strcmp(argv[firstarg], "--clocks")) {
+          clockfile = strdup(argv[firstarg + 1]);
+          firstarg += 2;
+       }
+       else if (!strcmp(argv[firstarg], "-p") || !strcmp(argv[firstarg], "--period")) {
+          period = strtod(argv[firstarg + 1], NULL);
+          firstarg += 2;
+       }
+       else if (!strcmp(argv[firstarg], "-l") || !strcmp(argv[firstarg], "--load")) {
+          outLoad = strtod(argv[firstarg + 1], NULL);
+          firstarg += 2;
+       }
+       else if (!strcmp(argv[firstarg], "-t") || !strcmp(argv[firstarg], "--trans")) {
+          inTrans = strtod(argv[firstarg + 1], NULL);
+          firstarg += 2;
+       }
+       else if (!strcmp(argv[firstarg], "-C") || !strcmp(argv[firstarg], "--corner")) {
+	  newcorner = (cornerptr)calloc(1, sizeof(corner));
+	  newcorner->name = strdup(argv[firstarg + 1]);
+	  newcorner->libfiles = strchr(newcorner->name, '=');
+	  if (newcorner->libfiles == NULL) {
+	     fprintf(stderr, "Corner \"%s\" has no liberty files\n",
+			newcorner->name);
+	     free(newcorner->name);
+	     free(newcorner);
+	  }
+	  else {
+	     *newcorner->libfiles++ = '\0';
+	     if (lastcorner == NULL)
+		corners = newcorner;
+	     else
+		lastcorner->next = newcorner;
+	     lastcorner = newcorner;
+	  }
+	  firstarg += 2;
+       }
+       else if (!strcmp(argv[firstarg], "-L") || !strcmp(argv[firstarg], "--long")) {
+          longFormat = 1;
+          firstarg++;
+       }
+       else if (!strcmp(argv[firstarg], "-n") || !strcmp(argv[firstarg], "--num-paths")) {
+	  numReportPaths = strtod(argv[firstarg + 1], NULL);
+	  firstarg += 2;
+       }
+       else if (!strcmp(argv[firstarg], "-s") || !strcmp(argv[firstarg], "--summary")) {
+          summaryfile = strdup(argv[firstarg + 1]);
+          /* Rule:  If argument has a file extension, then treat it as a single	*/
+	  /* file and dump all output to it.  If not, then treat it as a	*/
+	  /* directory and create individual files for each timing check.	*/
+          if (strrchr(summaryfile, '.') == NULL) {
+	     summarydir = summaryfile;
+	     summaryfile = NULL;
+	     /* Make directory if it doesn't exist */
+	     mkdir(summarydir, S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+	  }
+          firstarg += 2;
+       }
+       else if (!strcmp(argv[firstarg], "-v") || !strcmp(argv[firstarg], "--verbose")) {
+          sscanf(argv[firstarg + 1], "%d", &ival);
+          verbose = (unsigned char)ival;
+          firstarg += 2;
+       }
+       else if (!strcmp(argv[firstarg], "-D") || !strcmp(argv[firstarg], "--debug")) {
+          sscanf(argv[firstarg + 1], "%d", &ival);
+          debug = (unsigned char)ival;
+          firstarg += 2;
+       }
+       else if (!strcmp(argv[firstarg], "-e") || !strcmp(argv[firstarg], "--exhaustive")) {
+          exhaustive = 1;
+          firstarg++;
+       }
+       else if (!strcmp(argv[firstarg], "-c") || !strcmp(argv[firstarg], "--cleanup")) {
+          cleanup = 1;
+          firstarg++;
+       }
+       else if (!strcmp(argv[firstarg], "-b") || !strcmp(argv[firstarg], "--borrow")) {
+          latchmode = 1;
+          firstarg++;
+       }
+       else if (!strcmp(argv[firstarg], "-N") || !strcmp(argv[firstarg], "--net-slack")) {
+          slackfile = strdup(argv[firstarg + 1]);
+          netslack = 1;
+          firstarg += 2;
+       }
+       else if (!strcmp(argv[firstarg], "-M") || !strcmp(argv[firstarg], "--low-memory")) {
+          lowmem = 1;
+          firstarg++;
+       }
+       else if (!strcmp(argv[firstarg], "-r") || !strcmp(argv[firstarg], "--derate")) {
+          char *endptr;
+          derate[MAXIMUM_TIME] = strtod(argv[firstarg + 1], &endptr);
+          if (*endptr == ',')
+             derate[MINIMUM_TIME] = strtod(endptr + 1, &endptr);
+          if ((*endptr != '\0') || (derate[MAXIMUM_TIME] <= 0.0) ||
+			(derate[MINIMUM_TIME] <= 0.0)) {
+             fprintf(stderr, "Bad derating factors \"%s\"\n", argv[firstarg + 1]);
+             derate[MINIMUM_TIME] = derate[MAXIMUM_TIME] = 1.0;
+          }
+          firstarg += 2;
+       }
+       else if (!strcmp(argv[firstarg], "-V") || !strcmp(argv[firstarg], "--version")) {
+          fprintf(stderr, "Vesta Static Timing Analyzer version 0.3\n");
+          result = 0;
+          goto cleanup;
+       }
+       else {
+          fprintf(stderr, "Unknown option \"%s\"\n", argv[firstarg]);
+          firstarg++;
+       }
+    }
+
+    /* The Liberty files follow the verilog file, if there is one */
+    libarg = (topcell == NULL) ? firstarg + 1 : firstarg;
+
+    if ((libarg > objc) || ((libarg == objc) && (corners == NULL) &&
+		(lib == NULL))) {
+        fprintf(stderr, "Usage:  vesta [options] <name.v> <name.lib> [...]\n");
+        fprintf(stderr, "Options:\n");
+        fprintf(stderr, "--delay <delay_file>   or      -d <delay_file>\n");
+        fprintf(stderr, "--corner <name>=<lib>[,<lib>...]  or  -C <name>=<lib>[,...]\n");
+        fprintf(stderr, "--period <period>      or      -p <period>\n");
+        fprintf(stderr, "--clocks <clock_file>  or      -k <clock_file>\n");
+        fprintf(stderr, "--load <load>          or      -l <load>\n");
+	fprintf(stderr, "--num-paths <numPaths>	or	-n <numPaths>\n");
+        fprintf(stderr, "--long                 or      -L\n");
+        fprintf(stderr, "--verbose <level>      or      -v <level>\n");
+        fprintf(stderr, "--exhaustive           or      -e\n");
+        fprintf(stderr, "--cleanup              or      -c\n");
+        fprintf(stderr, "--borrow               or      -b\n");
+        fprintf(stderr, "--derate <late>[,<early>]  or  -r <late>[,<early>]\n");
+        fprintf(stderr, "--net-slack <file>     or      -N <file>\n");
+        fprintf(stderr, "--low-memory           or      -M\n");
+        fprintf(stderr, "--version              or      -V\n");
+        goto cleanup;
+    }
+    else {
+        fflush(stdout);
+        fprintf(stdout, "----------------------------------------------\n");
+        fprintf(stdout, "Vesta static timing analysis tool\n");
+	fprintf(stdout, "for qflow " QFLOW_VERSION "." QFLOW_REVISION "\n");
+        fprintf(stdout, "(c) 2013-2018 Tim Edwards, Open Circuit Design\n");
+        fprintf(stdout, "----------------------------------------------\n\n");
+        fflush(stdout);
+    }
+
+    if (topcell == NULL) {
+	fsrc = fopen(argv[firstarg], "r");
+	if (fsrc == NULL) {
+	    fprintf(stderr, "Cannot open %s for reading\n", argv[firstarg]);
+	    goto cleanup;
+	}
+	fclose(fsrc);
+    }
+
+    /*------------------------------------------------------------------*/
+    /* The liberty files on the command line after the verilog source	*/
+    /* file (or the database "lib", already read) are the first corner,	*/
+    /* ahead of any corners given by option -C.  The first corner is	*/
+    /* the one the netlist is bound to.  Each corner's table templates	*/
+    /* end with one for the "scalar" case.				*/
+    /*------------------------------------------------------------------*/
+
+    if (lib != NULL) {
+	lib->next = corners;
+	corners = lib;
+    }
+    else if (libarg < objc) {
+	newcorner = (cornerptr)calloc(1, sizeof(corner));
+	newcorner->name = strdup("default");
+	newcorner->next = corners;
+	corners = newcorner;
+    }
+    for (testcorner = corners; testcorner; testcorner = testcorner->next) {
+	if (testcorner->tables == NULL) testcorner->tables = scalar_table();
+	numcorners++;
+    }
+
+    /*------------------------------------------------------------------*/
+    /* Read all liberty format files of each corner			*/
+    /*------------------------------------------------------------------*/
+
+    ProfileBegin("parse Liberty");
+    for (testcorner = corners; testcorner; testcorner = testcorner->next) {
+	if (testcorner == lib) continue;	/* Already read */
+	i = libarg;
+	libnext = testcorner->libfiles;
+	while (1) {
+	    if (testcorner->libfiles == NULL) {
+		if (i >= objc) break;
+		libfile = argv[i++];
+	    }
+	    else {
+		if (libnext == NULL) break;
+		libfile = libnext;
+		libnext = strchr(libnext, ',');
+		if (libnext != NULL) *libnext++ = '\0';
+	    }
+	    if (libraryRead(testcorner, libfile) != 0) {
+		ProfileEnd();
+		goto cleanup;
+	    }
+	}
+    }
+    ProfileEnd();
+
+    /*--------------------------------------------------*/
+    /* Debug:  Print summary of liberty database        */
+    /*--------------------------------------------------*/
+
+    if (verbose > 3) {
+
+        lutable *newtable;
+        cell *newcell;
+        pin *newpin;
+
+        for (newtable = corners->tables; newtable; newtable = newtable->next) {
+            fprintf(stdout, "Table: %s\n", newtable->name);
+        }
+
+        for (newcell = corners->cells; newcell; newcell = newcell->next) {
+            fprintf(stdout, "Cell: %s\n", newcell->name);
+            fprintf(stdout, "   Function: %s\n", newcell->function);
+            for (newpin = newcell->pins; newpin; newpin = newpin->next) {
+                if (newpin->type == INPUT)
+                    fprintf(stdout, "   Pin: %s  cap=%g\n", newpin->name, newpin->capr);
+            }
+            fprintf(stdout, "\n");
+        }
+    }
+
+    /*------------------------------------------------------------------*/
+    /* Read verilog netlist.  This is also not a rigorous parser!       */
+    /*------------------------------------------------------------------*/
+
+    /* See hash.c for these routines and variables */
+    hashfunc = hash;
+    matchfunc = match;
+
+    /* Initialize net hash table */
+    InitializeHashTable(&Nethash, LARGEHASHSIZE);
+
+    /* Index the liberty cells and their pins */
+    for (testcorner = corners; testcorner; testcorner = testcorner->next)
+	cellIndexBuild(testcorner->cells, &testcorner->Cellhash);
+
+    fileCurrentLine = 0;
+
+    ProfileBegin("parse Verilog");
+    if (topcell != NULL)
+	verilogBuild(topcell, &corners->Cellhash, &netlist, &instlist, &inputlist,
+		&outputlist, &Nethash, 0);
+    else
+	verilogRead(argv[firstarg], &corners->Cellhash, &netlist, &instlist, &inputlist,
+		&outputlist, &Nethash);
+    ProfileEnd();
+    memory_report("parse Verilog");
+
+    if (delayfile != NULL) {
+        fdly = fopen(delayfile, "r");
+
+        if (fdly == NULL) {
+            fprintf(stderr, "Cannot open %s for reading\n", delayfile);
+            goto cleanup;
+        }
+    }
+    else
+	fdly = NULL;
+
+    fflush(stdout);
+    fprintf(stdout, "Verilog netlist read:  Processed %d lines.\n", vlinenum);
+
+    /*--------------------------------------------------*/
+    /* Debug:  Print summary of verilog source          */
+    /*--------------------------------------------------*/
+
+    if (verbose > 2) {
+        connect *testoutput;
+        connect *testinput;
+        net *testnet;
+        instance *testinst;
+
+        for (testinput = inputlist; testinput; testinput = testinput->next) {
+            if (testinput->refnet)
+                fprintf(stdout, "   Input: %s\n", testinput->refnet->name);
+        }
+        for (testoutput = outputlist; testoutput; testoutput = testoutput->next) {
+            if (testoutput->refnet)
+                fprintf(stdout, "   Output: %s\n", testoutput->refnet->name);
+        }
+        for (testnet = netlist; testnet; testnet = testnet->next) {
+            fprintf(stdout, "   Net: %s\n", testnet->name);
+        }
+        for (testinst = instlist; testinst; testinst = testinst->next) {
+            fprintf(stdout, "   Gate: %s\n", testinst->name);
+        }
+    }
+
+    /*--------------------------------------------------*/
+    /* Generate internal links representing the network */
+    /*--------------------------------------------------*/
+
+    ProfileBegin("build links");
+    createLinks(netlist, instlist, inputlist, outputlist);
+
+    /* Generate a connection list from inputlist */
+
+    for (testconn = inputlist; testconn; testconn = testconn->next) {
+        newinputconn = (connlistptr)malloc(sizeof(connlist));
+        newinputconn->connection = testconn;
+        newinputconn->next = inputconnlist;
+        inputconnlist = newinputconn;
+    }
+
+    /*--------------------------------------------------*/
+    /* Assign net types, mainly to identify clocks      */
+    /* Return a list of clock nets                      */
+    /*--------------------------------------------------*/
+
+    numterms = assign_net_types(netlist, &clockconnlist);
+    ProfileEnd();
+    memory_report("build links");
+
+    if (verbose > 2)
+        fprintf(stdout, "Number of terminals to check: %d\n", numterms);
+
+    /*--------------------------------------------------*/
+    /* Calculate total load on each net                 */
+    /* To do:  Add wire models or computed wire delays  */
+    /*--------------------------------------------------*/
+
+    if (fdly != NULL) {
+	char *dotptr = strrchr(delayfile, '.');
+
+	ProfileBegin("parse delays");
+	if ((dotptr != NULL) && !strcasecmp(dotptr, ".spef"))
+	    spefRead(fdly, &Nethash);
+	else if (delayRead(fdly, &Nethash) != 0) {
+	    fclose(fdly);
+	    ProfileEnd();
+	    goto cleanup;
+	}
+        fclose(fdly);
+	ProfileEnd();
+    }
+
+    /*--------------------------------------------------*/
+    /* Read clock constraints and tag the clock domain	*/
+    /* of each flop					*/
+    /*--------------------------------------------------*/
+
+    if (clockfile != NULL) {
+	FILE *fclk;
+	int numclocks, numclocked;
+
+	fclk = fopen(clockfile, "r");
+	if (fclk == NULL) {
+	    fprintf(stderr, "Cannot open %s for reading\n", clockfile);
+	    goto cleanup;
+	}
+	ProfileBegin("clock domains");
+	numclocks = clockRead(fclk, &Nethash);
+	fclose(fclk);
+	numclocked = assign_clock_domains(clockconnlist, netlist);
+	if (numexceptions > 0)
+	    compile_exceptions(netlist);
+	ProfileEnd();
+	fprintf(stdout, "Clock file read:  %d clocks, %d of %d flops clocked, "
+		"%d exceptions.\n", numclocks, numclocked, numterms,
+		numexceptions);
+    }
+
+    if ((derate[MAXIMUM_TIME] != 1.0) || (derate[MINIMUM_TIME] != 1.0))
+	fprintf(stdout, "Delay derating factors:  late %g, early %g.\n",
+		derate[MAXIMUM_TIME], derate[MINIMUM_TIME]);
+
+    /* Hash table no longer needed */
+    HashKill(&Nethash);
+    Nethash.hashtab = NULL;
+
+    ProfileBegin("compute loads");
+    if (numcorners > 1)
+	cornerBind(instlist, corners, numcorners);
+    computeLoads(netlist, instlist, outLoad, numcorners);
+    ProfileEnd();
+    memory_report("compute loads");
+
+    /*--------------------------------------------------*/
+    /* Analyze each corner on the same timing graph	*/
+    /*--------------------------------------------------*/
+
+    if (summaryfile != NULL) {
+        fsum = fopen(summaryfile, "w");
+        if (fsum == NULL)
+            fprintf(stderr, "Cannot open %s for writing\n", summaryfile);
+    }
+    else
+	fsum = NULL;
+
+    results = (timingresult *)malloc(numcorners * sizeof(timingresult));
+    for (i = 0, testcorner = corners; testcorner; i++, testcorner = testcorner->next) {
+	if (numcorners > 1) {
+	    if (i > 0) {
+		cornerSelect(instlist, i);
+		reset_all(netlist, MAXIMUM_TIME);
+		for (testconn = inputlist; testconn; testconn = testconn->next) {
+		    testconn->tag = NULL;
+		    testconn->metric = -1.0;
+		}
+	    }
+	    fprintf(stdout, "=========================================\n");
+	    fprintf(stdout, "Corner %s\n", testcorner->name);
+	    fprintf(stdout, "=========================================\n\n");
+	}
+	analyzeTiming(netlist, inputlist, clockconnlist, inputconnlist, period,
+		numReportPaths, longFormat, fsum, summarydir,
+		(numcorners > 1) ? testcorner->name : NULL, &results[i]);
+    }
+
+    /*--------------------------------------------------*/
+    /* Summarize the worst paths of each corner		*/
+    /*--------------------------------------------------*/
+
+    if (numcorners > 1) {
+	fprintf(stdout, "Corner summary:\n");
+	if (fsum) fprintf(fsum, "Corner summary:\n");
+	for (i = 0, testcorner = corners; testcorner; i++, testcorner = testcorner->next) {
+	    fprintf(stdout, "   %-12s max delay %g ps", testcorner->name,
+			results[i].maxdelay);
+	    if (fsum) fprintf(fsum, "   %-12s max delay %g ps", testcorner->name,
+			results[i].maxdelay);
+	    if (period > 0.0) {
+		fprintf(stdout, " (%s)", results[i].setupfail ? "FAIL" : "met");
+		if (fsum) fprintf(fsum, " (%s)", results[i].setupfail ? "FAIL" : "met");
+	    }
+	    else if (results[i].maxdelay > 0.0) {
+		fprintf(stdout, " (%g MHz)", 1.0E6 / results[i].maxdelay);
+		if (fsum) fprintf(fsum, " (%g MHz)", 1.0E6 / results[i].maxdelay);
+	    }
+	    fprintf(stdout, "   min delay %g ps (hold %s)\n", results[i].mindelay,
+			results[i].holdfail ? "FAIL" : "met");
+	    if (fsum) fprintf(fsum, "   min delay %g ps (hold %s)\n",
+			results[i].mindelay, results[i].holdfail ? "FAIL" : "met");
+	}
+	fprintf(stdout, "\n");
+	if (fsum) fprintf(fsum, "\n");
+    }
+
+    /* Hand the caller the worst corner, with its paths */
+    if (runresults != NULL) {
+	int worst = 0;
+
+	for (i = 1; i < numcorners; i++) {
+	    if (results[0].constrained ?
+			(results[i].setupslack < results[worst].setupslack) :
+			(results[i].maxdelay > results[worst].maxdelay))
+		worst = i;
+	}
+	runresults->maxdelay = results[0].maxdelay;
+	runresults->mindelay = results[0].mindelay;
+	runresults->holdslack = results[0].holdslack;
+	for (i = 0; i < numcorners; i++) {
+	    if (results[i].maxdelay > runresults->maxdelay)
+		runresults->maxdelay = results[i].maxdelay;
+	    if (results[i].mindelay < runresults->mindelay)
+		runresults->mindelay = results[i].mindelay;
+	    if (results[i].holdslack < runresults->holdslack)
+		runresults->holdslack = results[i].holdslack;
+	    runresults->setupfail |= results[i].setupfail;
+	    runresults->holdfail |= results[i].holdfail;
+	}
+	runresults->setupslack = results[worst].setupslack;
+	runresults->constrained = results[worst].constrained;
+	runresults->numpaths = results[worst].numpaths;
+	runresults->paths = results[worst].paths;
+	results[worst].paths = NULL;
+	results[worst].numpaths = 0;
+    }
+    for (i = 0; i < numcorners; i++)
+	pathsFree(results[i].paths, results[i].numpaths);
+    free(results);
+
+    /* Net slack of the worst corner, for timing-driven placement */
+    if (slackfile != NULL) {
+	i = write_net_slack(slackfile, netlist);
+	if (i >= 0)
+	    fprintf(stdout, "Net slack file %s written:  %d nets.\n", slackfile, i);
+    }
+
+    if (fsum != NULL) fclose(fsum);
+    result = 0;
+
+cleanup:
+    /*--------------------------------------------------*/
+    /* Free the netlist and the liberty database of	*/
+    /* each corner, except the caller's database "lib"	*/
+    /*--------------------------------------------------*/
+
+    if (Nethash.hashtab != NULL) HashKill(&Nethash);
+    netlistFree(netlist, instlist, inputlist, outputlist, numcorners);
+    connlistFree(clockconnlist);
+    connlistFree(inputconnlist);
+
+    for (testcorner = corners; testcorner; testcorner = newcorner) {
+	newcorner = testcorner->next;
+	if (testcorner->Cellhash.hashtab != NULL) HashKill(&testcorner->Cellhash);
+	if (testcorner == lib)
+	    lib->next = NULL;
+	else
+	    cornerFree(testcorner);
+    }
+
+    if (delayfile != NULL) free(delayfile);
+    if (clockfile != NULL) free(clockfile);
+    if (slackfile != NULL) free(slackfile);
+    if (summaryfile != NULL) free(summaryfile);
+    if (summarydir != NULL) free(summarydir);
+
+    for (i = 1; i < numdomains; i++) free(clockdefs[i].name);
+    numdomains = 1;
+    for (i = 0; i < numexceptions; i++) {
+	if (exceptions[i].from) free(exceptions[i].from);
+	if (exceptions[i].through) free(exceptions[i].through);
+	if (exceptions[i].to) free(exceptions[i].to);
+    }
+    numexceptions = 0;
+
+    return result;
+}
+
+#ifndef VESTA_LIBRARY
+
+/*--------------------------------------------------------------*/
+/* Main program (the library form calls VestaRun() directly)	*/
+/*--------------------------------------------------------------*/
+
+int
+main(int objc, char *argv[])
+{
+    ProfileInit(argv[0]);
+    return VestaRun(objc, argv, NULL, NULL, NULL);
+}
+
+#endif /* VESTA_LIBRARY */
@@ -0,0 +1,56 @@
+/*----------------------------------------------------------------------*/
+/* vesta.h -- Static timing analysis entry point			*/
+/*----------------------------------------------------------------------*/
+
+#ifndef _VESTA_H
+#define _VESTA_H
+
+struct cellrec;			/* See readverilog.h */
+
+/* Liberty database kept between runs, so that the Liberty files are	*/
+/* parsed once.  VestaReadLiberty() creates the database if "*lib" is	*/
+/* NULL, and adds the cells of "libfile" to it.  Returns 0 on success.	*/
+
+typedef struct _corner *VestaLibrary;
+
+extern int VestaReadLiberty(VestaLibrary *lib, char *libfile);
+extern void VestaFreeLiberty(VestaLibrary lib);
+
+/* Results of a run.  Slacks are valid only if "constrained" is set	*/
+/* (a clock period or clock file was given).  The paths are the	*/
+/* reported maximum delay paths of the corner with the worst setup	*/
+/* slack, or the longest delay if unconstrained, in report order.	*/
+
+typedef struct _VestaPath {
+    char *start;		/* Path start, "instance/pin"		*/
+    char *end;			/* Path end, "instance/pin" or output	*/
+    double delay;		/* Path delay, in ps			*/
+    double slack;		/* Setup slack in ps, if "checked"	*/
+    int checked;		/* Set if the path has a required time	*/
+} VestaPath;
+
+typedef struct _VestaResults {
+    double maxdelay;		/* Longest maximum delay path, in ps	*/
+    double mindelay;		/* Shortest minimum delay path, in ps	*/
+    double setupslack;		/* Worst setup slack, in ps		*/
+    double holdslack;		/* Worst hold slack, in ps		*/
+    int constrained;		/* Set if paths have required times	*/
+    int setupfail;		/* Set if a path fails setup		*/
+    int holdfail;		/* Set if a path fails hold		*/
+    int numpaths;
+    VestaPath *paths;
+} VestaResults;
+
+/* Run vesta with the command line "objc", "argv".  If "topcell" is	*/
+/* non-NULL, it is used as the netlist and the command line lists only	*/
+/* the Liberty files.  If "lib" is non-NULL, it is used as the Liberty	*/
+/* database and the command line lists no Liberty files.  Neither is	*/
+/* modified.  If "results" is non-NULL, it receives the results of a	*/
+/* successful run, to be freed by VestaFreeResults().  Returns 0 on	*/
+/* success.								*/
+
+extern int VestaRun(int objc, char *argv[], struct cellrec *topcell,
+		VestaLibrary lib, VestaResults *results);
+extern void VestaFreeResults(VestaResults *results);
+
+#endif /* _VESTA_H */
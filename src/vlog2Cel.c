@@ -21,8 +21,12 @@
 #include "hash.h"
 #include "readverilog.h"
 #include "readlef.h"
+#include "outbuf.h"
+#include "netweight.h"
+#include "profile.h"
 
 int write_output(struct cellrec *, int, char *);
+int write_net_weights(struct cellrec *, struct hashtable *, char *);
 void helpmessage(FILE *outf);
 
 char *VddNet = NULL;
@@ -38,7 +42,9 @@ int main (int argc, char *argv[])
 
     char *outfile = NULL;
     char *vlogname = NULL;
+    char *weightfile = NULL;
     struct cellrec *topcell;
+    struct hashtable Weighthash;
 
     VddNet = strdup("VDD");
     GndNet = strdup("VSS");
@@ -46,7 +52,9 @@ int main (int argc, char *argv[])
     InitializeHashTable(&LEFhash, SMALLHASHSIZE);
     units = 100;	/* Default value is centimicrons */
 
-    while ((i = getopt(argc, argv, "hHu:l:o:")) != EOF) {
+    ProfileInit(argv[0]);
+
+    while ((i = getopt(argc, argv, "hHu:l:o:w:")) != EOF) {
 	switch (i) {
 	    case 'h':
 	    case 'H':
@@ -58,11 +66,16 @@ int main (int argc, char *argv[])
 		}
 		break;
 	    case 'l':
+		ProfileBegin("parse LEF");
 		LefRead(optarg);		/* Can be called multiple times */
+		ProfileEnd();
 		break;
 	    case 'o':
 		outfile = strdup(optarg);
 		break;
+	    case 'w':
+		weightfile = strdup(optarg);
+		break;
 	    default:
 		fprintf(stderr, "Bad switch \"%c\"\n", (char)i);
 		helpmessage(stderr);
@@ -89,11 +102,139 @@ int main (int argc, char *argv[])
 	}
     }
 
+    ProfileBegin("parse Verilog");
     topcell = ReadVerilog(vlogname);
+    ProfileEnd();
+
+    ProfileBegin("write output");
     result = write_output(topcell, units, outfile);
+    ProfileEnd();
+
+    /* Net weights go in the GrayWolf .net file next to the .cel file */
+    if ((result == 0) && (weightfile != NULL)) {
+	if (outfile == NULL) {
+	    fprintf(stderr, "Net weights need an output file name (-o)\n");
+	    return 1;
+	}
+	InitializeHashTable(&Weighthash, LARGEHASHSIZE);
+	if (NetWeightRead(weightfile, &Weighthash) < 0) return 1;
+	result = write_net_weights(topcell, &Weighthash, outfile);
+    }
     return result;
 }
 
+/* Output file and weights table passed to output_weight() */
+
+struct weightrec {
+    FILE *outfptr;
+    struct hashtable *weights;
+};
+
+/*--------------------------------------------------------------*/
+/* output_weight:						*/
+/* Recursion callback function for each net of the top cell.	*/
+/* Each bit of a bus is looked up separately in the weights	*/
+/* table.  Nets of the default weight 1 are not written.	*/
+/*--------------------------------------------------------------*/
+
+struct nlist *output_weight(struct hashlist *p, void *cptr)
+{
+    struct weightrec *wrec = (struct weightrec *)cptr;
+    struct netrec *net = (struct netrec *)p->ptr;
+    char *bitname;
+    double weight;
+    int i, lo, hi;
+
+    if (net->start == -1) {
+	weight = NetWeight(p->name, wrec->weights);
+	if (weight >= 1.001)
+	    fprintf(wrec->outfptr, "net %s HVweights %.3f %.3f\n", p->name,
+			weight, weight);
+	return NULL;
+    }
+
+    lo = (net->start < net->end) ? net->start : net->end;
+    hi = (net->start < net->end) ? net->end : net->start;
+    bitname = (char *)malloc(strlen(p->name) + 15);
+    for (i = lo; i <= hi; i++) {
+	sprintf(bitname, "%s[%d]", p->name, i);
+	weight = NetWeight(bitname, wrec->weights);
+	if (weight >= 1.001)
+	    fprintf(wrec->outfptr, "net %s HVweights %.3f %.3f\n", bitname,
+			weight, weight);
+    }
+    free(bitname);
+    return NULL;
+}
+
+/*--------------------------------------------------------------*/
+/* write_net_weights: Write the weight in "weights" of each net	*/
+/* of "topcell" that is above the default of 1 to the GrayWolf	*/
+/* .net file with the root name of .cel file "celname".  Nets	*/
+/* in "weights" that are not in the netlist (e.g., from a slack	*/
+/* file written before buffering changed the netlist) have no	*/
+/* pins in the .cel file and are not written.			*/
+/*								*/
+/*      RETURNS: 0 on success, 1 on error			*/
+/*--------------------------------------------------------------*/
+
+int write_net_weights(struct cellrec *topcell, struct hashtable *weights,
+		char *celname)
+{
+    FILE *outfptr;
+    char *netname, *dotptr;
+    struct weightrec wrec;
+
+    netname = (char *)malloc(strlen(celname) + 5);
+    strcpy(netname, celname);
+    dotptr = strrchr(netname, '.');
+    if ((dotptr != NULL) && !strcmp(dotptr, ".cel")) *dotptr = '\0';
+    strcat(netname, ".net");
+
+    outfptr = fopen(netname, "w");
+    if (outfptr == NULL) {
+	fprintf(stderr, "Error:  Failed to open file %s for output\n", netname);
+	free(netname);
+	return 1;
+    }
+
+    wrec.outfptr = outfptr;
+    wrec.weights = weights;
+    RecurseHashTablePointer(&topcell->nets, output_weight, &wrec);
+    fclose(outfptr);
+    free(netname);
+    return 0;
+}
+
+/*--------------------------------------------------------------*/
+/* Write " layer <layer> <x> <y>" and end the line.		*/
+/*--------------------------------------------------------------*/
+
+void output_layer(FILE *outfptr, int layer, int x, int y)
+{
+    fputs(" layer ", outfptr);
+    OutputInt(outfptr, layer);
+    putc(' ', outfptr);
+    OutputInt(outfptr, x);
+    putc(' ', outfptr);
+    OutputInt(outfptr, y);
+    putc('\n', outfptr);
+}
+
+/*--------------------------------------------------------------*/
+/* Write a pin record "pin name <pin> signal <net> layer ..."	*/
+/*--------------------------------------------------------------*/
+
+void output_pin(FILE *outfptr, char *pinname, char *netname, int layer,
+		int x, int y)
+{
+    fputs("pin name ", outfptr);
+    fputs(pinname, outfptr);
+    fputs(" signal ", outfptr);
+    fputs(netname, outfptr);
+    output_layer(outfptr, layer, x, y);
+}
+
 /*--------------------------------------------------------------*/
 /* write_output: Generate the .cel file output.			*/
 /*								*/
@@ -122,7 +263,7 @@ int write_output(struct cellrec *topcell, int units, char *outfile)
     char *netsptr;
 
     if (outfile != NULL) {
-	outfptr = fopen(outfile, "w");
+	outfptr = OutputOpen(outfile);
 	if (outfptr == NULL) {
 	    fprintf(stderr, "Error:  Failed to open file %s for output\n",
 			outfile);
@@ -207,15 +348,27 @@ int write_output(struct cellrec *topcell, int units, char *outfile)
 		    if (inameptr != NULL) *inameptr = '\\';
 		}
 
-	        fprintf(outfptr, "cell %d %s:%s\n", cellidx, inst->cellname,
-			inst->instname);
+	        fputs("cell ", outfptr);
+		OutputInt(outfptr, cellidx);
+		putc(' ', outfptr);
+		fputs(inst->cellname, outfptr);
+		putc(':', outfptr);
+		fputs(inst->instname, outfptr);
+		putc('\n', outfptr);
 	    }
 	    if (gateginfo->nomirror == TRUE) {
 		// LEF "SYMMETRY X" translates to .cel formate "nomirror"
 		fprintf(outfptr, "nomirror\n");
 	    }
-	    fprintf(outfptr, "left %d right %d bottom %d top %d\n",
-			cllx, curx, clly, cury);
+	    fputs("left ", outfptr);
+	    OutputInt(outfptr, cllx);
+	    fputs(" right ", outfptr);
+	    OutputInt(outfptr, curx);
+	    fputs(" bottom ", outfptr);
+	    OutputInt(outfptr, clly);
+	    fputs(" top ", outfptr);
+	    OutputInt(outfptr, cury);
+	    putc('\n', outfptr);
 	    cellidx++;
 
 	    /* Generate implicit feedthroughs to satisfy global routing, as */
@@ -224,10 +377,13 @@ int write_output(struct cellrec *topcell, int units, char *outfile)
 	    feedx = cllx + pitchx[lvert] / 2 + pitchx[lvert];
 	    kidx = 1;
 	    while (feedx < curx) {
-		fprintf(outfptr, "pin name twfeed%d signal TW_PASS_THRU layer %d %d %d\n",
-				kidx, lvert, feedx, clly);
-		fprintf(outfptr, "   equiv name twfeed%d layer %d %d %d\n",
-				kidx, lvert, feedx, cury);
+		fputs("pin name twfeed", outfptr);
+		OutputInt(outfptr, kidx);
+		fputs(" signal TW_PASS_THRU", outfptr);
+		output_layer(outfptr, lvert, feedx, clly);
+		fputs("   equiv name twfeed", outfptr);
+		OutputInt(outfptr, kidx);
+		output_layer(outfptr, lvert, feedx, cury);
 		feedx += pitchx[lvert];
 		kidx++;
 	    }
@@ -349,8 +505,7 @@ int write_output(struct cellrec *topcell, int units, char *outfile)
 			fprintf(outfptr, "end_pin_group\n");
 		    }
 		    else {
-			fprintf(outfptr, "pin name %s signal %s layer %d %d %d\n",
-				port->name, port->net, lvert, px, py);
+			output_pin(outfptr, port->name, port->net, lvert, px, py);
 		    }
 		}
 		else {	/* Handle arrays */
@@ -482,8 +637,7 @@ int write_output(struct cellrec *topcell, int units, char *outfile)
 				    fprintf(outfptr, "end_pin_group\n");
 				}
 				else {
-				    fprintf(outfptr, "pin name %s signal %s layer %d %d %d\n",
-					    apin, anet, lvert, px, py);
+				    output_pin(outfptr, apin, anet, lvert, px, py);
 				}
 				break;
 			    }
@@ -558,7 +712,12 @@ int write_output(struct cellrec *topcell, int units, char *outfile)
 	fprintf(outfptr, "\n");
 
     }
-    if (outfile != NULL) fclose(outfptr);
+    if (outfile != NULL) {
+	if (OutputClose(outfptr) != 0) {
+	    fprintf(stderr, "Error:  Failed writing file %s\n", outfile);
+	    result = 1;
+	}
+    }
 
     fflush(stdout);
     return result;
@@ -589,6 +748,8 @@ void helpmessage(FILE *outf)
 			"100 = centimicrons)\n");
     fprintf(outf, "  -l <path>  Read LEF file from <path> (may be called multiple"
 			" times)\n");
+    fprintf(outf, "  -w <path>  Write the GrayWolf .net file with weights for the\n");
+    fprintf(outf, "             critical nets in vesta net slack file <path>\n");
 
 } /* helpmessage() */
 
@@ -13,6 +13,9 @@
 #include "hash.h"
 #include "readverilog.h"
 #include "readlef.h"
+#include "outbuf.h"
+#include "netweight.h"
+#include "profile.h"
 
 int write_output(struct cellrec *, int hasmacros, float aspect, float density,
 		int units, GATE coresite, char *outname);
@@ -26,11 +29,16 @@ typedef struct _linkedNet {
     char *instname;
     char *pinname;
     linkedNetPtr next;
+    linkedNetPtr last;	/* End of list (valid in first record only) */
 } linkedNet;
 
 /* Hash table of LEF macros */
 struct hashtable LEFhash;
 
+/* Hash table of net weights (see netweight.c), if any were read */
+struct hashtable Weighthash;
+int hasweights = FALSE;
+
 /*--------------------------------------------------------------*/
 
 int main (int argc, char *argv[])
@@ -45,14 +53,18 @@ int main (int argc, char *argv[])
 
     InitializeHashTable(&LEFhash, SMALLHASHSIZE);
 
-    while ((i = getopt(argc, argv, "hHl:a:d:u:o:")) != EOF) {
+    ProfileInit(argv[0]);
+
+    while ((i = getopt(argc, argv, "hHl:a:d:u:o:w:")) != EOF) {
         switch (i) {
 	    case 'h':
 	    case 'H':
 		helpmessage(stdout);
 		return 0;
 	    case 'l':
+		ProfileBegin("parse LEF");
 		result = LefRead(optarg);	/* Can be called multiple times */
+		ProfileEnd();
 		if (result == 0) {
 		    helpmessage(stderr);
 		    return 1;
@@ -61,6 +73,15 @@ int main (int argc, char *argv[])
 	    case 'o':
 		defoutname = strdup(optarg);
 		break;
+	    case 'w':
+		if (hasweights == FALSE)
+		    InitializeHashTable(&Weighthash, LARGEHASHSIZE);
+		if (NetWeightRead(optarg, &Weighthash) < 0) {
+		    helpmessage(stderr);
+		    return 1;
+		}
+		hasweights = TRUE;
+		break;
 	    case 'a':
 		if (sscanf(optarg, "%f", &aspect) != 1) {
 		    fprintf(stderr, "Could not read aspect value from \"-a %s\"\n",
@@ -115,9 +136,14 @@ int main (int argc, char *argv[])
 	hasmacros = TRUE;
     }
 
+    ProfileBegin("parse Verilog");
     topcell = ReadVerilog(argv[optind]);
+    ProfileEnd();
+
+    ProfileBegin("write output");
     result = write_output(topcell, hasmacros, aspect, density,
 		units, coresite, defoutname);
+    ProfileEnd();
     return result;
 }
 
@@ -132,8 +158,10 @@ struct nlist *output_nets(struct hashlist *p, void *cptr)
     char *sptr = NULL;
     FILE *outf = (FILE *)cptr;
     linkedNetPtr nlink, nsrch;
+    double weight;
 
     nlink = (linkedNetPtr)(p->ptr);
+    weight = (hasweights) ? NetWeight(p->name, &Weighthash) : 0.0;
 
     // Verilog backslash-escaped names are decidedly not SPICE
     // compatible, so replace the mandatory trailing space character
@@ -144,19 +172,55 @@ struct nlist *output_nets(struct hashlist *p, void *cptr)
 	if (sptr != NULL) *sptr = '\\';
     }
 
-    fprintf(outf, "- %s\n", p->name);
+    fputs("- ", outf);
+    fputs(p->name, outf);
+    putc('\n', outf);
 
     for (nsrch = nlink; nsrch; nsrch = nsrch->next) {
-	fprintf(outf, "  ( %s %s )", nsrch->instname, nsrch->pinname);
-	if (nsrch->next == NULL)
-	    fprintf(outf, " ;");
-	fprintf(outf, "\n");
+	fputs("  ( ", outf);
+	fputs(nsrch->instname, outf);
+	putc(' ', outf);
+	fputs(nsrch->pinname, outf);
+	fputs(" )", outf);
+	if ((nsrch->next == NULL) && (weight < 1.5))
+	    fputs(" ;", outf);
+	putc('\n', outf);
+    }
+
+    /* DEF net weights are integers;  1 is the default */
+    if (weight >= 1.5) {
+	fputs("  + WEIGHT ", outf);
+	OutputInt(outf, (int)(weight + 0.5));
+	fputs(" ;\n", outf);
     }
 
     if (sptr != NULL) *sptr = ' ';
     return NULL;
 }
 
+/*--------------------------------------------------------------*/
+/* append_net:							*/
+/* Add connection "nlink" to the end of the list for net	*/
+/* "netname".  Returns 1 if this is the first connection to the	*/
+/* net, 0 otherwise.						*/
+/*--------------------------------------------------------------*/
+
+int append_net(char *netname, linkedNetPtr nlink, struct hashtable *Nodehash)
+{
+    linkedNetPtr nsrch;
+
+    nlink->next = NULL;
+    nlink->last = nlink;
+
+    if ((nsrch = HashLookup(netname, Nodehash)) != NULL) {
+	nsrch->last->next = nlink;
+	nsrch->last = nlink;
+	return 0;
+    }
+    HashPtrInstall(netname, nlink, Nodehash);
+    return 1;
+}
+
 /*--------------------------------------------------------------*/
 /* port_output_specs						*/
 /*								*/
@@ -217,7 +281,7 @@ int write_output(struct cellrec *topcell, int hasmacros, float aspect,
     /* Static string "PIN" for ports */
     static char pinname[] = "PIN";
 
-    linkedNetPtr nlink, nsrch;
+    linkedNetPtr nlink;
     LefList slef;
     LefList routelayer[3];
 
@@ -228,7 +292,7 @@ int write_output(struct cellrec *topcell, int hasmacros, float aspect,
 
     /* Open the output file (unless name is NULL, in which case use stdout) */
     if (outname != NULL) {
-	outfptr = fopen(outname, "w");
+	outfptr = OutputOpen(outname);
 	if (outfptr == NULL) {
 	    fprintf(stderr, "Error:  Cannot open file %s for writing.\n", outname);
 	    return 1;
@@ -262,15 +326,7 @@ int write_output(struct cellrec *topcell, int hasmacros, float aspect,
 		sprintf(portnet, "%s[%d]", port->name, i);
 		nlink->pinname = strdup(portnet);
 	    }
-	    nlink->next = NULL;
-	    if ((nsrch = HashLookup(nlink->pinname, &Nodehash)) != NULL) {
-		while (nsrch->next) nsrch = nsrch->next;
-		nsrch->next = nlink;
-	    }
-	    else {
-		HashPtrInstall(nlink->pinname, nlink, &Nodehash);
-		nnet++;
-	    }
+	    nnet += append_net(nlink->pinname, nlink, &Nodehash);
 	}
     }
     totalwidth = 0;
@@ -360,16 +416,7 @@ int write_output(struct cellrec *topcell, int hasmacros, float aspect,
 		nlink = (linkedNetPtr)malloc(sizeof(linkedNet));
 		nlink->instname = inst->instname;
 		nlink->pinname = port->name;
-		nlink->next = NULL;
-
-		if ((nsrch = HashLookup(port->net, &Nodehash)) != NULL) {
-		    while (nsrch->next) nsrch = nsrch->next;
-		    nsrch->next = nlink;
-		}
-		else {
-		    HashPtrInstall(port->net, nlink, &Nodehash);
-		    nnet++;
-		}
+		nnet += append_net(port->net, nlink, &Nodehash);
 	    }
             else {  // is_net_bus == TRUE
 
@@ -460,16 +507,7 @@ int write_output(struct cellrec *topcell, int hasmacros, float aspect,
 			    nlink = (linkedNetPtr)malloc(sizeof(linkedNet));
 			    nlink->instname = inst->instname;
 			    nlink->pinname = gate->node[j];
-			    nlink->next = NULL;
-
-			    if ((nsrch = HashLookup(anet, &Nodehash)) != NULL) {
-				while (nsrch->next) nsrch = nsrch->next;
-				nsrch->next = nlink;
-			    }
-			    else {
-				HashPtrInstall(anet, nlink, &Nodehash);
-				nnet++;
-			    }
+			    nnet += append_net(anet, nlink, &Nodehash);
 			    break;
 			}
 		    }
@@ -582,11 +620,22 @@ int write_output(struct cellrec *topcell, int hasmacros, float aspect,
 		alow = inst->arraystart;
 	    }
 	    for (j = ahigh; j >= alow; j--) {
-		fprintf(outfptr, "- %s[%d] %s ;\n", inst->instname, j, inst->cellname);
+		fputs("- ", outfptr);
+		fputs(inst->instname, outfptr);
+		putc('[', outfptr);
+		OutputInt(outfptr, j);
+		fputs("] ", outfptr);
+		fputs(inst->cellname, outfptr);
+		fputs(" ;\n", outfptr);
 	    }
 	}
-	else
-	    fprintf(outfptr, "- %s %s ;\n", inst->instname, inst->cellname);
+	else {
+	    fputs("- ", outfptr);
+	    fputs(inst->instname, outfptr);
+	    putc(' ', outfptr);
+	    fputs(inst->cellname, outfptr);
+	    fputs(" ;\n", outfptr);
+	}
     }
     fprintf(outfptr, "END COMPONENTS\n\n");
 
@@ -638,7 +687,12 @@ int write_output(struct cellrec *topcell, int hasmacros, float aspect,
     /* End the design */
     fprintf(outfptr, "END DESIGN\n");
 
-    if (outname != NULL) fclose(outfptr);
+    if (outname != NULL) {
+	if (OutputClose(outfptr) != 0) {
+	    fprintf(stderr, "Error:  Failed writing file %s.\n", outname);
+	    result = 1;
+	}
+    }
 
     fflush(stdout);
     return result;
@@ -668,6 +722,7 @@ void helpmessage(FILE *outf)
     fprintf(outf,"   -a <value>	 Set aspect ratio to <value> (default 1.0)\n");
     fprintf(outf,"   -d <value>	 Set density to <value> (default 1.0)\n");
     fprintf(outf,"   -u <value>  Set units-per-micron to <value) (default 100)\n");
+    fprintf(outf,"   -w <path>   Weight critical nets from vesta net slack file <path>\n");
 
 } /* helpmessage() */
 
@@ -24,6 +24,8 @@
 
 #include "hash.h"
 #include "readverilog.h"
+#include "outbuf.h"
+#include "profile.h"
 
 #define LengthOfLine    	16384
 
@@ -38,8 +40,28 @@ typedef struct _linkedstring {
     LinkedStringPtr next;
 } LinkedString;
 
+/* Linked list of output files, each with its own option flags */
+typedef struct _outputspec *OutputSpecPtr;
+
+typedef struct _outputspec {
+    char *name;
+    int flags;
+    OutputSpecPtr next;
+} OutputSpec;
+
+/* Record of an instance port net name changed during output */
+typedef struct _netsave *NetSavePtr;
+
+typedef struct _netsave {
+    struct portrec *port;
+    char *net;
+    NetSavePtr next;
+} NetSave;
+
 /* Function prototypes */
-int write_output(struct cellrec *, LinkedStringPtr, char *, int);
+void read_spicelibs(LinkedStringPtr, struct hashtable *);
+int write_output(struct cellrec *, LinkedStringPtr, struct hashtable *,
+		char *, int);
 int loc_getline(char s[], int lim, FILE *fp);
 void helpmessage(FILE *);
 
@@ -48,18 +70,24 @@ void helpmessage(FILE *);
 int main (int argc, char *argv[])
 {
     int i, result = 0;
-    int flags = 0;
+    int flags = 0, *fptr;
     char *eptr;
 
     char *vloginname = NULL;
     char *spclibname = NULL;
-    char *spcoutname = NULL;
 
     LinkedStringPtr spicelibs = NULL, newspicelib;
+    OutputSpecPtr outputs = NULL, lastoutput = NULL, newoutput;
+    struct hashtable Libhash;
 
+    /* Option switches apply to all outputs until the first "-o",	*/
+    /* after which they apply only to the most recent output file.	*/
+    fptr = &flags;
 
     struct cellrec *topcell = NULL;
 
+    ProfileInit(argv[0]);
+
     while ((i = getopt(argc, argv, "hHidD:l:s:o:")) != EOF) {
 	switch (i) {
 	    case 'l':
@@ -69,13 +97,22 @@ int main (int argc, char *argv[])
 		spicelibs = newspicelib;
 		break;
 	    case 'o':
-		spcoutname = strdup(optarg);
+		newoutput = (OutputSpecPtr)malloc(sizeof(OutputSpec));
+		newoutput->name = strdup(optarg);
+		newoutput->flags = flags;
+		newoutput->next = NULL;
+		if (lastoutput == NULL)
+		    outputs = newoutput;
+		else
+		    lastoutput->next = newoutput;
+		lastoutput = newoutput;
+		fptr = &newoutput->flags;
 		break;
 	    case 'i':
-		flags |= DO_INCLUDE;
+		*fptr |= DO_INCLUDE;
 		break;
 	    case 'd':
-		flags |= DO_DELIMITER;
+		*fptr |= DO_DELIMITER;
 		break;
 	    case 'h':
 	    case 'H':
@@ -111,11 +148,25 @@ int main (int argc, char *argv[])
     }
     optind++;
 
+    ProfileBegin("parse Verilog");
     topcell = ReadVerilog(vloginname);
-    if (topcell != NULL)
-	result = write_output(topcell, spicelibs, spcoutname, flags);
+    ProfileEnd();
+    if (topcell == NULL) return 1;	/* Return error code */
+
+    /* Read the SPICE libraries once for all outputs */
+    ProfileBegin("parse SPICE");
+    InitializeHashTable(&Libhash, SMALLHASHSIZE);
+    read_spicelibs(spicelibs, &Libhash);
+    ProfileEnd();
+
+    ProfileBegin("write output");
+    if (outputs == NULL)
+	result = write_output(topcell, spicelibs, &Libhash, NULL, flags);
     else
-	result = 1;	/* Return error code */
+	for (newoutput = outputs; newoutput; newoutput = newoutput->next)
+	    result |= write_output(topcell, spicelibs, &Libhash,
+			newoutput->name, newoutput->flags);
+    ProfileEnd();
 
     return result;
 }
@@ -139,49 +190,25 @@ void backslash_fix(char *netname)
 }
 
 /*--------------------------------------------------------------*/
-/* write_output ---  Write the SPICE netlist output		*/
+/* read_spicelibs ---  Read the port order of each subcircuit	*/
+/* in the SPICE libraries into hash table Libhash.		*/
 /*								*/
 /* ARGS: 							*/
-/* RETURNS: 0 on success, 1 on error.				*/
-/* SIDE EFFECTS: 						*/
+/* RETURNS: 							*/
+/* SIDE EFFECTS: Libhash is filled with port lists.		*/
 /*--------------------------------------------------------------*/
 
-int write_output(struct cellrec *topcell, LinkedStringPtr spicelibs,
-		char *outname, int flags)
+void read_spicelibs(LinkedStringPtr spicelibs, struct hashtable *Libhash)
 {
     FILE *libfile;
-    FILE *outfile;
     char *libname;
     LinkedStringPtr curspicelib;
-
-    struct netrec *net;
-    struct instance *inst;
-    struct portrec *port;
     struct portrec *newport, *portlist, *lastport;
 
-    int i, j, k, start, end, pcount = 1;
-    int result = 0;
-    int instidx, insti;
-
-    char *lptr;
+    int j;
     char *sp, *sp2;
     char line[LengthOfLine];
 
-    struct hashtable Libhash;
-
-    if (outname != NULL) {
-	outfile = fopen(outname, "w");
-	if (outfile == NULL) {
-	    fprintf(stderr, "Error:  Couldn't open file %s for writing\n", outname);
-	    return 1;
-	}
-    }
-    else
-	outfile = stdout;
-
-    /* Initialize SPICE library hash table */
-    InitializeHashTable(&Libhash, SMALLHASHSIZE);
-
     // Read one or more SPICE libraries of subcircuits and use them to define
     // the order of pins that were read from LEF (which is not necessarily in
     // SPICE pin order).
@@ -263,12 +290,52 @@ int write_output(struct cellrec *topcell, LinkedStringPtr spicelibs,
 		}
 
 		/* Hash the new port record by cellname */
-		HashPtrInstall(cellname, portlist, &Libhash);
+		HashPtrInstall(cellname, portlist, Libhash);
 		free(cellname);
 	    }
 	}
 	fclose(libfile);
     }
+}
+
+/*--------------------------------------------------------------*/
+/* write_output ---  Write the SPICE netlist output		*/
+/*								*/
+/* ARGS: 							*/
+/* RETURNS: 0 on success, 1 on error.				*/
+/* SIDE EFFECTS: 						*/
+/*--------------------------------------------------------------*/
+
+int write_output(struct cellrec *topcell, LinkedStringPtr spicelibs,
+		struct hashtable *Libhash, char *outname, int flags)
+{
+    FILE *libfile;
+    FILE *outfile;
+    char *libname;
+    LinkedStringPtr curspicelib;
+
+    struct netrec *net;
+    struct instance *inst;
+    struct portrec *port;
+    struct portrec *newport, *portlist, *lastport;
+
+    int i, start, end, pcount = 1;
+    int result = 0;
+    int instidx, insti;
+
+    char line[LengthOfLine];
+
+    NetSavePtr netsaves = NULL, netsave;
+
+    if (outname != NULL) {
+	outfile = OutputOpen(outname);
+	if (outfile == NULL) {
+	    fprintf(stderr, "Error:  Couldn't open file %s for writing\n", outname);
+	    return 1;
+	}
+    }
+    else
+	outfile = stdout;
 
     /* Write output header */
     fprintf(outfile, "*SPICE netlist created from verilog structural netlist module "
@@ -367,15 +434,19 @@ int write_output(struct cellrec *topcell, LinkedStringPtr spicelibs,
 	    }
 	}
 
-	if (inst->arraystart == -1)
-	    fprintf(outfile, "X%s ", inst->instname);
-	else
-	    fprintf(outfile, "X%s[%d] ", inst->instname, instidx);
+	putc('X', outfile);
+	fputs(inst->instname, outfile);
+	if (inst->arraystart != -1) {
+	    putc('[', outfile);
+	    OutputInt(outfile, instidx);
+	    putc(']', outfile);
+	}
+	putc(' ', outfile);
         pcount = 1;
 
 	/* Search library records for subcircuit */
 
-	portlist = (struct portrec *)HashLookup(inst->cellname, &Libhash);
+	portlist = (struct portrec *)HashLookup(inst->cellname, Libhash);
 
 	/* If no library entry exists, complain about arbitrary port	*/
 	/* order, then use the instance's port names to create a port	*/
@@ -397,7 +468,7 @@ int write_output(struct cellrec *topcell, LinkedStringPtr spicelibs,
 		newport->direction = libport->direction;
 		newport->next = NULL;
 	    }
-	    HashPtrInstall(inst->cellname, portlist, &Libhash);
+	    HashPtrInstall(inst->cellname, portlist, Libhash);
 	}
 
 	/* Output pin connections in the order of the LEF record, which	*/
@@ -416,7 +487,7 @@ int write_output(struct cellrec *topcell, LinkedStringPtr spicelibs,
 	    argcnt++;
 	    argcnt %= 8;
 	    if (argcnt == 7)
-		fprintf(outfile, "\n+ ");
+		fputs("\n+ ", outfile);
 
 	    dptr = NULL;
 	    if (libport) {
@@ -489,6 +560,12 @@ int write_output(struct cellrec *topcell, LinkedStringPtr spicelibs,
 		    char *d1ptr, *d2ptr;
 		    if ((d1ptr = strchr(port->net, '[')) != NULL) {
 			if ((d2ptr = strchr(d1ptr + 1, ']')) != NULL) {
+			    /* Save the original for any output that follows */
+			    netsave = (NetSavePtr)malloc(sizeof(NetSave));
+			    netsave->port = port;
+			    netsave->net = strdup(port->net);
+			    netsave->next = netsaves;
+			    netsaves = netsave;
 			    *d1ptr = '<';
 			    *d2ptr = '>';
 			}
@@ -520,7 +597,7 @@ int write_output(struct cellrec *topcell, LinkedStringPtr spicelibs,
 			ssave = *epos;
 			*epos = '\0';
 			backslash_fix(portname);
-			fprintf(outfile, "%s", portname);
+			fputs(portname, outfile);
 			*epos = ssave;
 		    }
 		    else {
@@ -531,7 +608,7 @@ int write_output(struct cellrec *topcell, LinkedStringPtr spicelibs,
 			if (wb.start < 0) {
 			    /* portname is not a bus */
 			    backslash_fix(portname);
-			    fprintf(outfile, "%s", portname);
+			    fputs(portname, outfile);
 			}
 			else {
 			    int lidx;
@@ -553,14 +630,14 @@ int write_output(struct cellrec *topcell, LinkedStringPtr spicelibs,
 		}
 		else {
 		    backslash_fix(port->net);
-		    fprintf(outfile, "%s", port->net);
+		    fputs(port->net, outfile);
 		}
 
 		if (pcount++ % 8 == 7) {
 		    pcount = 0;
-		    fprintf(outfile, "\n+");
+		    fputs("\n+", outfile);
 		}
-		fprintf(outfile, " ");
+		putc(' ', outfile);
 	    }
 
 	    if (portlist == NULL) {
@@ -571,7 +648,8 @@ int write_output(struct cellrec *topcell, LinkedStringPtr spicelibs,
 	    }
 	    if (dptr != NULL) *dptr = '[';
 	}
-	fprintf(outfile, "%s\n", inst->cellname);
+	fputs(inst->cellname, outfile);
+	putc('\n', outfile);
 
 	if ((inst->arraystart != -1) && (instidx != inst->arrayend)) continue;
 	instidx = -1;
@@ -580,7 +658,21 @@ int write_output(struct cellrec *topcell, LinkedStringPtr spicelibs,
     fprintf(outfile, "\n.ends\n");
     fprintf(outfile, ".end\n");
 
-    if (outname != NULL) fclose(outfile);
+    if (outname != NULL) {
+	if (OutputClose(outfile) != 0) {
+	    fprintf(stderr, "Error:  Failed writing file %s\n", outname);
+	    result = 1;
+	}
+    }
+
+    /* Put back the original net names (in reverse order) */
+    while (netsaves != NULL) {
+	netsave = netsaves->next;
+	free(netsaves->port->net);
+	netsaves->port->net = netsaves->net;
+	free(netsaves);
+	netsaves = netsave;
+    }
 
     return result;
 }
@@ -629,7 +721,9 @@ void helpmessage(FILE *fout)
     fprintf(fout, "   -d          Convert array delimiter brackets to angle brackets.\n");
     fprintf(fout, "   -D <key>=<value>  Preregister a verilog definition.\n");
     fprintf(fout, "   -l <path>   Specify path to SPICE library of standard cells.\n");
-    fprintf(fout, "   -o <path>   Specify path to output SPICE file.\n");
+    fprintf(fout, "   -o <path>   Specify path to output SPICE file.  May be given more\n");
+    fprintf(fout, "               than once;  options -i and -d following -o apply\n");
+    fprintf(fout, "               only to that output file.\n");
     fprintf(fout, "\n");
 
 } /* helpmessage() */
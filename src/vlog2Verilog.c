@@ -20,6 +20,8 @@
 #include "hash.h"
 #include "readverilog.h"
 #include "readlef.h"
+#include "outbuf.h"
+#include "profile.h"
 
 int write_output(struct cellrec *, unsigned char, char *);
 void helpmessage(FILE *outf);
@@ -42,43 +44,67 @@ struct hashtable Lefhash;
 #define	NONAME_POWER	(unsigned char)0x08
 #define ADD_ANTENNA	(unsigned char)0x10
 
+/* Linked list of output files, each with its own option flags */
+typedef struct _outputspec *OutputSpecPtr;
+
+typedef struct _outputspec {
+    char *name;
+    unsigned char flags;
+    OutputSpecPtr next;
+} OutputSpec;
+
+/* Record of an instance port net name replaced during output */
+typedef struct _netsave *NetSavePtr;
+
+typedef struct _netsave {
+    struct portrec *port;
+    char *net;
+    NetSavePtr next;
+} NetSave;
+
 /*--------------------------------------------------------------*/
 
 int main (int argc, char *argv[])
 {
     int i, result;
-    unsigned char Flags;
+    unsigned char Flags, *fptr;
 
     char *vloginname = NULL;
-    char *vlogoutname = NULL;
     char *cptr;
     struct cellrec *topcell;
+    OutputSpecPtr outputs = NULL, lastoutput = NULL, newoutput;
 
     Flags = (unsigned char)IMPLICIT_POWER;
 
+    /* Option switches apply to all outputs until the first "-o",	*/
+    /* after which they apply only to the most recent output file.	*/
+    fptr = &Flags;
+
     VddNet = strdup("VDD");
     GndNet = strdup("VSS");
 
     InitializeHashTable(&Lefhash, SMALLHASHSIZE);
 
+    ProfileInit(argv[0]);
+
     while ((i = getopt(argc, argv, "pbchnHv:g:l:o:a:")) != EOF) {
 	switch( i ) {
 	    case 'p':
-		Flags &= ~IMPLICIT_POWER;
+		*fptr &= ~IMPLICIT_POWER;
 		break;
 	    case 'b':
-		Flags |= BIT_BLAST;
+		*fptr |= BIT_BLAST;
 		break;
 	    case 'c':
-		Flags |= MAINTAIN_CASE;
+		*fptr |= MAINTAIN_CASE;
 		break;
 	    case 'a':
-		Flags |= ADD_ANTENNA;
+		*fptr |= ADD_ANTENNA;
 		if (AntennaCell != NULL) free(AntennaCell);
 		AntennaCell = strdup(optarg);
 		break;
 	    case 'n':
-		Flags |= NONAME_POWER;
+		*fptr |= NONAME_POWER;
 		break;
 	    case 'h':
 	    case 'H':
@@ -86,7 +112,9 @@ int main (int argc, char *argv[])
 		exit(0);
 		break;
 	    case 'l':
+		ProfileBegin("parse LEF");
 		LefRead(optarg);		/* Can be called multiple times */
+		ProfileEnd();
 		break;
 	    case 'v':
 		free(VddNet);
@@ -99,7 +127,16 @@ int main (int argc, char *argv[])
 		cleanup_string(VddNet);
 		break;
 	    case 'o':
-		vlogoutname = strdup(optarg);
+		newoutput = (OutputSpecPtr)malloc(sizeof(OutputSpec));
+		newoutput->name = strdup(optarg);
+		newoutput->flags = Flags;
+		newoutput->next = NULL;
+		if (lastoutput == NULL)
+		    outputs = newoutput;
+		else
+		    lastoutput->next = newoutput;
+		lastoutput = newoutput;
+		fptr = &newoutput->flags;
 		break;
 	    case 'g':
 		free(GndNet);
@@ -137,8 +174,20 @@ int main (int argc, char *argv[])
 	}
     }
 
+    ProfileBegin("parse Verilog");
     topcell = ReadVerilog(vloginname);
-    result = write_output(topcell, Flags, vlogoutname);
+    ProfileEnd();
+
+    /* Write each requested variant from the same cell record */
+    ProfileBegin("write output");
+    if (outputs == NULL)
+	result = write_output(topcell, Flags, NULL);
+    else {
+	result = 0;
+	for (newoutput = outputs; newoutput; newoutput = newoutput->next)
+	    result |= write_output(topcell, newoutput->flags, newoutput->name);
+    }
+    ProfileEnd();
     return result;
 }
 
@@ -218,11 +267,16 @@ struct nlist *output_wires(struct hashlist *p, void *cptr)
     }
     else if (is_pwr_name(p->name)) return NULL;
 
-    fprintf(outf, "wire ");
+    fputs("wire ", outf);
     if (net->start >= 0 && net->end >= 0) {
-	fprintf(outf, "[%d:%d] ", net->start, net->end);
+	putc('[', outf);
+	OutputInt(outf, net->start);
+	putc(':', outf);
+	OutputInt(outf, net->end);
+	fputs("] ", outf);
     }
-    fprintf(outf, "%s ;\n", p->name);
+    fputs(p->name, outf);
+    fputs(" ;\n", outf);
     return NULL;
 }
 
@@ -564,6 +618,19 @@ char *GetIndexedNet(char *netname, int ridx, struct cellrec *topcell)
     return subname;
 }
 
+/*--------------------------------------------------------------*/
+/* Write one instance pin connection "    .<pin>(<net>)"	*/
+/*--------------------------------------------------------------*/
+
+void output_pin(FILE *outfptr, char *pinname, char *netname)
+{
+    fputs("    .", outfptr);
+    fputs(pinname, outfptr);
+    putc('(', outfptr);
+    fputs(netname, outfptr);
+    putc(')', outfptr);
+}
+
 /*--------------------------------------------------------------*/
 /* write_output							*/
 /*								*/
@@ -585,8 +652,10 @@ int write_output(struct cellrec *topcell, unsigned char Flags, char *outname)
     struct portrec *port;
     struct instance *inst;
 
+    NetSavePtr netsaves = NULL, netsave;
+
     if (outname != NULL) {
-	outfptr = fopen(outname, "w");
+	outfptr = OutputOpen(outname);
 	if (outfptr == NULL) {
 	    fprintf(stderr, "Error:  Cannot open file %s for writing.\n", outname);
 	    return 1;
@@ -652,7 +721,8 @@ int write_output(struct cellrec *topcell, unsigned char Flags, char *outname)
 
     for (inst = topcell->instlist; inst; ) {
 	int nprops = RecurseHashTable(&inst->propdict, CountHashTableEntries);
-	fprintf(outfptr, "%s ", inst->cellname);
+	fputs(inst->cellname, outfptr);
+	putc(' ', outfptr);
 	if (nprops > 0) {
 	    fprintf(outfptr, "#(\n");
 	    RecurseHashTablePointer(&inst->propdict, output_props, outfptr);
@@ -663,7 +733,7 @@ int write_output(struct cellrec *topcell, unsigned char Flags, char *outname)
 	    result = 1;		// Set error result but continue output.
 	}
 	if (inst->arraystart == -1)
-	    fprintf(outfptr, "%s", inst->instname);
+	    fputs(inst->instname, outfptr);
 	else {
 	    if (Flags & BIT_BLAST) {
 		if (arrayidx == -1) arrayidx = inst->arraystart;
@@ -679,7 +749,7 @@ int write_output(struct cellrec *topcell, unsigned char Flags, char *outname)
 			    inst->arraystart, inst->arrayend);
 	    }
 	}
-	fprintf(outfptr, " (\n");
+	fputs(" (\n", outfptr);
 
 	// If there is a gate record read from LEF, keep a pointer to it.
 	if (GateInfo != NULL)
@@ -697,13 +767,13 @@ int write_output(struct cellrec *topcell, unsigned char Flags, char *outname)
 		if (GndTap != NULL) need++;
 		for (n = 0; n < gate->nodes; n++) {
 		    if (gate->use[n] == PORT_USE_POWER) {
-			if (found > 0) fprintf(outfptr, ",\n");
-			fprintf(outfptr, "    .%s(%s)", gate->node[n], VddNet);
+			if (found > 0) fputs(",\n", outfptr);
+			output_pin(outfptr, gate->node[n], VddNet);
 			found++;
 		    }
 		    else if (gate->use[n] == PORT_USE_GROUND) {
-			if (found > 0) fprintf(outfptr, ",\n");
-			fprintf(outfptr, "    .%s(%s)", gate->node[n], GndNet);
+			if (found > 0) fputs(",\n", outfptr);
+			output_pin(outfptr, gate->node[n], GndNet);
 			found++;
 		    }
 		    if (found == need) break;
@@ -726,15 +796,20 @@ int write_output(struct cellrec *topcell, unsigned char Flags, char *outname)
 	    }
 	    else {
 		/* Fall back on VddNet and GndNet names */
-		fprintf(outfptr, "    .%s(%s),\n", GndNet, GndNet);
-		if (GndTap != NULL)
-		    fprintf(outfptr, "    .%s(%s),\n", GndTap, GndNet);
-		fprintf(outfptr, "    .%s(%s)", VddNet, VddNet);
-		if (VddTap != NULL)
-		    fprintf(outfptr, ",\n    .%s(%s)", VddTap, VddNet);
+		output_pin(outfptr, GndNet, GndNet);
+		fputs(",\n", outfptr);
+		if (GndTap != NULL) {
+		    output_pin(outfptr, GndTap, GndNet);
+		    fputs(",\n", outfptr);
+		}
+		output_pin(outfptr, VddNet, VddNet);
+		if (VddTap != NULL) {
+		    fputs(",\n", outfptr);
+		    output_pin(outfptr, VddTap, VddNet);
+		}
 	    }
-	    if (inst->portlist) fprintf(outfptr, ",");
-	    fprintf(outfptr, "\n");
+	    if (inst->portlist) putc(',', outfptr);
+	    putc('\n', outfptr);
 	}
 
 	/* Write each port and net connection */
@@ -747,7 +822,8 @@ int write_output(struct cellrec *topcell, unsigned char Flags, char *outname)
 	    if ((Flags & IMPLICIT_POWER) || (!(Flags & NONAME_POWER))) {
 		int brepeat = 0;
 		char is_array = FALSE, saveptr;
-		char *sptr = port->net, *nptr;
+		char *netcopy = strdup(port->net);
+		char *sptr = netcopy, *nptr;
 		char *expand = (char *)malloc(1);
 
 		*expand = '\0';
@@ -924,26 +1000,30 @@ int write_output(struct cellrec *topcell, unsigned char Flags, char *outname)
 		    strcat(expand, "}");
 		}
 
-		/* Replace port->net */
-		
-		free(port->net);
+		/* Replace port->net, saving the original so that it	*/
+		/* can be restored after output.			*/
+
+		netsave = (NetSavePtr)malloc(sizeof(NetSave));
+		netsave->port = port;
+		netsave->net = port->net;
+		netsave->next = netsaves;
+		netsaves = netsave;
 		port->net = expand;
+		free(netcopy);
 	    }
-	    fprintf(outfptr, "    .%s(", port->name);
 	    if ((Flags & BIT_BLAST) && (arrayidx != -1)) {
 		/* Find the index from the start and pull that item from port->net */
 		int ridx;
 		ridx = arrayidx - inst->arraystart;
 		if (ridx < 0) ridx = -ridx;
-		fprintf(outfptr, "%s", GetIndexedNet(port->net, ridx, topcell));
+		output_pin(outfptr, port->name, GetIndexedNet(port->net, ridx, topcell));
 	    }
 	    else
-		fprintf(outfptr, "%s", port->net);
-	    fprintf(outfptr, ")");
-	    if (port->next) fprintf(outfptr, ",");
-	    fprintf(outfptr, "\n");
+		output_pin(outfptr, port->name, port->net);
+	    if (port->next) putc(',', outfptr);
+	    putc('\n', outfptr);
 	}
-	fprintf(outfptr, ");\n\n");
+	fputs(");\n\n", outfptr);
 
 	/* For bit-blasted output, output each element of an array separately. */
 	if (Flags & BIT_BLAST) {
@@ -1028,7 +1108,23 @@ int write_output(struct cellrec *topcell, unsigned char Flags, char *outname)
     /* End the module */
     fprintf(outfptr, "endmodule\n");
 
-    if (outname != NULL) fclose(outfptr);
+    if (outname != NULL) {
+	if (OutputClose(outfptr) != 0) {
+	    fprintf(stderr, "Error:  Failed writing file %s.\n", outname);
+	    result = 1;
+	}
+    }
+
+    /* Put back the original instance net names (in reverse order)	*/
+    /* so that the cell record can be written again with other flags.	*/
+
+    while (netsaves != NULL) {
+	netsave = netsaves->next;
+	free(netsaves->port->net);
+	netsaves->port->net = netsaves->net;
+	free(netsaves);
+	netsaves = netsave;
+    }
 
     fflush(stdout);
     return result;
@@ -1054,6 +1150,8 @@ void helpmessage(FILE *outf)
     fprintf(outf, "\n");
     fprintf(outf, "  -h         Print this message\n");    
     fprintf(outf, "  -o <path>  Set output filename (otherwise output is on stdout).\n");    
+    fprintf(outf, "             May be given more than once.  Options -p, -b, -c, -n,\n");
+    fprintf(outf, "             and -a following -o apply only to that output file.\n");
     fprintf(outf, "  -p         Don't add power nodes to instances\n");
     fprintf(outf, "             (only nodes present in the instance used)\n");
     fprintf(outf, "  -b         Remove vectors (bit-blasted)\n");
@@ -85,6 +85,9 @@
 #include "hash.h"		/* for hash table functions */
 #include "readliberty.h"	/* liberty file database */
 #include "readverilog.h"	/* verilog parser */
+#include "readlef.h"		/* LEF macros, needed to read DEF */
+#include "readdef.h"		/* DEF placement for buffer trees */
+#include "profile.h"		/* run time profiling */
 
 #define  FALSE	     0
 #define  TRUE        1
@@ -99,6 +102,7 @@ char *clkbuf_in_pin = NULL;
 char *buf_out_pin = NULL;
 char *clkbuf_out_pin = NULL;
 char *Ignorepath = NULL;
+char *Deffname = NULL;
 char SuffixIsNumeric;
 int  GatePrintFlag = 0;
 int  NodePrintFlag = 0;
@@ -126,6 +130,9 @@ double MaxOutputCap = 30.0;	// Maximum capacitance for an output node (fF).
 				// capacitance within MaxLatency time (ps).
 double WireCap = 10.0;		// Base capacitance for an output node, estimate
 				// of average wire capacitance (fF).
+double TargetPeriod = 0.0;	// Clock period (ps) to meet by timing-driven
+				// sizing.  Zero means no timing-driven sizing.
+int    MaxSizeIter = 20;	// Maximum number of timing-driven sizing passes
 
 struct Gatelist {
     char   *gatename;
@@ -153,11 +160,35 @@ struct Nodelist {
     // For net buffer trees
     int	   num_buf;		// Number of buffers to split the net
     int	   curcount;		// Active count for fanout buffering trees
+    int	   tidx;		// Index into Timingnets, or -1
+    struct Buftree *tree;	// Sinks grouped by placement, or NULL
 } Nodelist_;
 
 struct hashtable Nodehash;
 struct hashtable Bushash;
 
+/* Placement-aware buffer trees.  Sinks of a net being buffered are	*/
+/* grouped by location, one group per buffer.				*/
+
+struct Sinkpos {
+    double x, y;		// Location of the sink instance
+    double cap;			// Input capacitance of the sink pin
+    int	   order;		// Index of the sink in netlist order
+    int	   group;		// Buffer assigned, or -1 if not placed
+} Sinkpos_;
+
+struct Buftree {
+    int	   nsinks;
+    struct Sinkpos *sinks;	// Sinks (reordered by grouping)
+    int	   *group;		// Buffer assigned to each sink, netlist order
+    int	   next;		// Next sink in netlist order
+    int	   ngroups;
+    double *bufx, *bufy;	// Location of each buffer (center of sinks)
+} Buftree_;
+
+int HavePlacement = FALSE;	// TRUE if a DEF file was read
+struct hashtable Posthash;	// Locations of buffers added (by inst name)
+
 struct Bus {
     int imax;
     int imin;
@@ -180,6 +211,47 @@ struct Baselist {
 
 struct hashtable Basehash;
 
+/* Timing graph used for timing-driven sizing.  Nets and gates are	*/
+/* kept in arrays and refer to each other by index.			*/
+
+struct Timinggate {
+    struct instance *inst;
+    struct Gatelist *gl;	// Current cell of the instance
+    struct Gatelist *orig;	// Cell of the instance before sizing
+    struct Gatelist *best;	// Cell in the best solution found
+    int	   out;			// Index of output net, or -1
+    int	   ninputs;		// Number of data (non-clock) inputs
+    int	   *in;			// Indexes of data input nets
+    char   **inpin;		// Names of the data input pins
+    char   seq;			// TRUE if the cell is clocked
+    char   clk;			// TRUE if the gate drives a clock tree
+    char   dirty;		// TRUE if delay needs to be recomputed
+    double trans;		// Transition time at the latest input (ps)
+    double delay;		// Delay through the gate (ps)
+} Timinggate_;
+
+struct Timingnet {
+    struct Nodelist *nl;
+    int	   driver;		// Index of driving gate, or -1
+    int	   nsinks;
+    int	   *sinks;		// Indexes of gates with an input on the net
+    char   **sinkpin;		// Names of the input pins
+    char   *sinkclk;		// TRUE for each sink that is a clock pin
+    double load;		// Total load capacitance (fF)
+    double arrival;		// Latest arrival time (ps)
+    double trans;		// Transition time estimate (ps)
+    double required;		// Earliest required time (ps)
+} Timingnet_;
+
+struct Timinggate *Timinggates = NULL;
+struct Timingnet *Timingnets = NULL;
+int *Timingorder = NULL;	// Gate indexes in topological order
+int NumTgates = 0;
+int NumTnets = 0;
+int NumTorder = 0;
+
+#define UNCONSTRAINED 1.0E20
+
 enum states_ {NONE, INPUTS, OUTPUTS, GATENAME, PINNAME, INPUTNODE, CLOCKNODE,
 	OUTPUTNODE, ENDMODEL, ERROR};
 enum nodetype_ {UNKNOWN, INPUT, CLOCK, OUTPUT, INPUTPIN, OUTPUTPIN, INOUTPIN};
@@ -199,7 +271,23 @@ void resize_gates(struct cellrec *topcell, int doLoadBalance, int doFanout);
 void write_output(struct cellrec *topcell, FILE *outfptr, int doLoadBalance,
 		int doFanout);
 struct Gatelist *best_size(struct Gatelist *gl, double amount, char *overload);
+struct Gatelist *next_size(struct Gatelist *gl, int larger);
+double gate_delay(struct Gatelist *gl, double trans, double load);
+int table_index(double *vals, int n, double x, double *frac);
+void timing_load(int n);
+int timing_net(struct Nodelist *nl, int *maxnets);
+void timing_build(struct cellrec *topcell);
+double timing_update(void);
+double timing_gain(int g, struct Gatelist *glnew);
+void timing_swap(int g, struct Gatelist *glnew);
+int timing_overload(int g);
+int timing_size(struct cellrec *topcell);
 void count_gatetype(struct Gatelist *gl, int num_in, int num_out);
+int inst_position(struct instance *inst, double *x, double *y);
+void bisect_sinks(struct Sinkpos *sp, int num, int k, double maxcap,
+		int *ngroups);
+int group_sinks(struct cellrec *topcell, struct Gatelist *glbuf,
+		struct Gatelist *clkbuf);
 
 /*
  *---------------------------------------------------------------------------
@@ -290,7 +378,7 @@ typedef struct _gaterec {
 
 int insert_buffers(struct cellrec *topcell, int cidx)
 {
-    int i;
+    int i, bufidx;
     int hier;
     int slen;
     struct Nodelist *nl = NULL;
@@ -354,6 +442,12 @@ int insert_buffers(struct cellrec *topcell, int cidx)
 	    }
 	    nl = (struct Nodelist *)HashNext(&Nodehash);
 	}
+
+	/* If the placement is known, then assign sinks to buffers by	*/
+	/* location instead of in rotation.				*/
+
+	if (HavePlacement && (Buffer_count > 0))
+	    Buffer_count += group_sinks(topcell, glbuf, clkbuf);
     }
 
     /* Parse all instances and adjust net names to account for buffer trees.	*/
@@ -372,6 +466,10 @@ int insert_buffers(struct cellrec *topcell, int cidx)
 		    continue;
 		}
 		if (nl->num_buf > 0) {
+		    if (nl->tree != NULL)
+			bufidx = nl->tree->group[nl->tree->next++];
+		    else
+			bufidx = nl->curcount;
 		    hier = 0;
 		    nltest = nl;
 		    sprintf(nodename, "%s", nl->nodename);
@@ -399,7 +497,7 @@ int insert_buffers(struct cellrec *topcell, int cidx)
 			else {
 			    spos++;
 			}
-			sprintf(spos, "_bF$buf%d%s", nl->curcount,
+			sprintf(spos, "_bF$buf%d%s", bufidx,
 				((is_escaped == TRUE) ? " " : ""));
 
 			/* For buffer trees of depth > 1, there will be	 */
@@ -502,8 +600,23 @@ int insert_buffers(struct cellrec *topcell, int cidx)
 		Net(topcell, nodename);
 		registernode(nodename, OUTPUT, glbuf, buf_out_pin);
 	    }
+
+	    /* Record the buffer location for later passes */
+	    if (nl->tree != NULL) {
+		double *pos = (double *)malloc(2 * sizeof(double));
+		pos[0] = nl->tree->bufx[i];
+		pos[1] = nl->tree->bufy[i];
+		HashPtrInstall(newinst->instname, pos, &Posthash);
+	    }
 	    cidx++;
 	}
+	if (nl->tree != NULL) {
+	    free(nl->tree->group);
+	    free(nl->tree->bufx);
+	    free(nl->tree->bufy);
+	    free(nl->tree);
+	    nl->tree = NULL;
+	}
 	nl->num_inputs = nl->num_buf;
 	nl->num_buf = 0;
 	nl = (struct Nodelist *)HashNext(&Nodehash);
@@ -511,6 +624,228 @@ int insert_buffers(struct cellrec *topcell, int cidx)
     return cidx;
 }
 
+/*
+ *---------------------------------------------------------------------------
+ * Find the location of an instance from the DEF placement, or for a buffer
+ * added by a previous pass, the location assigned to it.  Return TRUE if
+ * the location is known.
+ *---------------------------------------------------------------------------
+ */
+
+int inst_position(struct instance *inst, double *x, double *y)
+{
+    GATE gate;
+    double *pos;
+
+    gate = DefFindGate(inst->instname);
+    if (gate != NULL) {
+	*x = gate->placedX;
+	*y = gate->placedY;
+	return TRUE;
+    }
+    pos = (double *)HashLookup(inst->instname, &Posthash);
+    if (pos != NULL) {
+	*x = pos[0];
+	*y = pos[1];
+	return TRUE;
+    }
+    return FALSE;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ * Sort callbacks for bisect_sinks()
+ *---------------------------------------------------------------------------
+ */
+
+int sinkx_compare(const void *a, const void *b)
+{
+    struct Sinkpos *sa = (struct Sinkpos *)a;
+    struct Sinkpos *sb = (struct Sinkpos *)b;
+
+    if (sa->x != sb->x) return (sa->x < sb->x) ? -1 : 1;
+    return sa->order - sb->order;
+}
+
+int sinky_compare(const void *a, const void *b)
+{
+    struct Sinkpos *sa = (struct Sinkpos *)a;
+    struct Sinkpos *sb = (struct Sinkpos *)b;
+
+    if (sa->y != sb->y) return (sa->y < sb->y) ? -1 : 1;
+    return sa->order - sb->order;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ * Divide "num" sinks into "k" groups of nearby sinks by recursive
+ * bisection, cutting across the longer side of the bounding box each
+ * time.  Groups with more than MaxFanout sinks, or with more load than
+ * "maxcap" (the strongest buffer), are divided further.  Groups are
+ * numbered from the value of "ngroups", which is incremented for each.
+ *---------------------------------------------------------------------------
+ */
+
+void bisect_sinks(struct Sinkpos *sp, int num, int k, double maxcap,
+		int *ngroups)
+{
+    double llx, lly, urx, ury, cap;
+    int i, k1, n1;
+
+    if (k > num) k = num;
+    if (k <= 1) {
+	cap = WireCap;
+	for (i = 0; i < num; i++) cap += sp[i].cap;
+	if ((num > 1) && ((num > MaxFanout) || (cap > maxcap)))
+	    k = 2;
+	else {
+	    for (i = 0; i < num; i++) sp[i].group = *ngroups;
+	    (*ngroups)++;
+	    return;
+	}
+    }
+
+    llx = urx = sp[0].x;
+    lly = ury = sp[0].y;
+    for (i = 1; i < num; i++) {
+	if (sp[i].x < llx) llx = sp[i].x;
+	if (sp[i].x > urx) urx = sp[i].x;
+	if (sp[i].y < lly) lly = sp[i].y;
+	if (sp[i].y > ury) ury = sp[i].y;
+    }
+    if ((urx - llx) >= (ury - lly))
+	qsort(sp, num, sizeof(struct Sinkpos), sinkx_compare);
+    else
+	qsort(sp, num, sizeof(struct Sinkpos), sinky_compare);
+
+    /* Split the sinks in proportion to the number of groups on each side */
+
+    k1 = k / 2;
+    n1 = (int)(0.5 + (double)num * (double)k1 / (double)k);
+    if (n1 < 1) n1 = 1;
+    if (n1 > num - 1) n1 = num - 1;
+
+    bisect_sinks(sp, n1, k1, maxcap, ngroups);
+    bisect_sinks(sp + n1, num - n1, k - k1, maxcap, ngroups);
+}
+
+/*
+ *---------------------------------------------------------------------------
+ * For each net marked for buffering by insert_buffers(), find the location
+ * of every sink and group the sinks by location, one group for each
+ * buffer.  The number of buffers may be increased to keep each group
+ * within the fanout and load limits.  Nets with any sink of unknown
+ * location are left for round-robin assignment.  Return the number of
+ * buffers added to the count made by insert_buffers().
+ *
+ * Sinks are visited in the same order as the renaming pass of
+ * insert_buffers(), which consumes the group assignments in sequence.
+ *---------------------------------------------------------------------------
+ */
+
+int group_sinks(struct cellrec *topcell, struct Gatelist *glbuf,
+		struct Gatelist *clkbuf)
+{
+    struct instance *inst;
+    struct portrec *port;
+    struct Gatelist *gl, *glnext;
+    struct Nodelist *nl;
+    struct Buftree *tree;
+    struct Sinkpos *sp;
+    double maxcap, clkmaxcap, *cnt;
+    int i, added = 0;
+
+    /* Maximum load for a group is the strength of the strongest buffer */
+
+    for (gl = glbuf; (glnext = next_size(gl, TRUE)) != NULL; gl = glnext);
+    maxcap = gl->strength;
+    for (gl = clkbuf; (glnext = next_size(gl, TRUE)) != NULL; gl = glnext);
+    clkmaxcap = gl->strength;
+
+    /* Pass 1:  Count the sinks of each net to be buffered */
+
+    for (inst = topcell->instlist; inst; inst = inst->next) {
+	if (HashLookup(inst->cellname, &Gatehash) == NULL) continue;
+	for (port = inst->portlist; port; port = port->next) {
+	    if (port->direction == PORT_OUTPUT) continue;
+	    nl = (struct Nodelist *)HashLookup(port->net, &Nodehash);
+	    if ((nl == NULL) || (nl->num_buf == 0)) continue;
+	    if (nl->tree == NULL) {
+		nl->tree = (struct Buftree *)calloc(1, sizeof(struct Buftree));
+	    }
+	    nl->tree->nsinks++;
+	}
+    }
+
+    /* Pass 2:  Record the location and load of each sink */
+
+    for (inst = topcell->instlist; inst; inst = inst->next) {
+	gl = (struct Gatelist *)HashLookup(inst->cellname, &Gatehash);
+	if (gl == NULL) continue;
+	for (port = inst->portlist; port; port = port->next) {
+	    if (port->direction == PORT_OUTPUT) continue;
+	    nl = (struct Nodelist *)HashLookup(port->net, &Nodehash);
+	    if ((nl == NULL) || (nl->tree == NULL)) continue;
+	    tree = nl->tree;
+	    if (tree->sinks == NULL)
+		tree->sinks = (struct Sinkpos *)malloc(tree->nsinks *
+				sizeof(struct Sinkpos));
+	    sp = &tree->sinks[tree->next];
+	    sp->order = tree->next++;
+	    sp->group = 0;
+	    if (!inst_position(inst, &sp->x, &sp->y)) sp->group = -1;
+	    if (get_pincap(gl->gatecell, port->name, &sp->cap) != 0) sp->cap = 0.0;
+	}
+    }
+
+    /* Group the sinks of each net */
+
+    nl = (struct Nodelist *)HashFirst(&Nodehash);
+    while (nl != NULL) {
+	if ((tree = nl->tree) != NULL) {
+	    for (i = 0; i < tree->nsinks; i++)
+		if (tree->sinks[i].group < 0) break;
+
+	    if (i < tree->nsinks) {
+		/* Some sink is not placed;  use round-robin assignment */
+		free(tree->sinks);
+		free(tree);
+		nl->tree = NULL;
+	    }
+	    else {
+		bisect_sinks(tree->sinks, tree->nsinks, nl->num_buf,
+			(nl->clock == TRUE) ? clkmaxcap : maxcap, &tree->ngroups);
+
+		tree->group = (int *)malloc(tree->nsinks * sizeof(int));
+		tree->bufx = (double *)calloc(tree->ngroups, sizeof(double));
+		tree->bufy = (double *)calloc(tree->ngroups, sizeof(double));
+		cnt = (double *)calloc(tree->ngroups, sizeof(double));
+		for (i = 0; i < tree->nsinks; i++) {
+		    sp = &tree->sinks[i];
+		    tree->group[sp->order] = sp->group;
+		    tree->bufx[sp->group] += sp->x;
+		    tree->bufy[sp->group] += sp->y;
+		    cnt[sp->group] += 1.0;
+		}
+		for (i = 0; i < tree->ngroups; i++) {
+		    tree->bufx[i] /= cnt[i];
+		    tree->bufy[i] /= cnt[i];
+		}
+		free(cnt);
+		free(tree->sinks);
+		tree->sinks = NULL;
+		tree->next = 0;
+
+		added += tree->ngroups - nl->num_buf;
+		nl->num_buf = tree->ngroups;
+		nl->curcount = tree->ngroups - 1;
+	    }
+	}
+	nl = (struct Nodelist *)HashNext(&Nodehash);
+    }
+    return added;
+}
+
 /*
  *---------------------------------------------------------------------------
  * Read a file of nets for which we should ignore fanout.  Typically this
@@ -690,6 +1025,8 @@ struct Nodelist* NodelistAlloc()
     nl->num_buf = 0;		// Tree expansion of node
     nl->curcount = 0;
     nl->clock = FALSE;
+    nl->tidx = -1;
+    nl->tree = NULL;
     return nl;
 }
 
@@ -1065,6 +1402,581 @@ void resize_gates(struct cellrec *topcell, int doLoadBalance, int doFanout)
     }
 }
 
+/*
+ *---------------------------------------------------------------------------
+ * Return the gate with the next larger (if "larger" is TRUE) or the next
+ * smaller drive strength than "gl" having the same base name, or NULL if
+ * there is none.
+ *---------------------------------------------------------------------------
+ */
+
+struct Gatelist *next_size(struct Gatelist *gl, int larger)
+{
+    char ssave;
+    int ind, i;
+    struct Gatelist *newgl, *glnext = NULL;
+    struct Baselist *bl;
+
+    if (gl->suffix == NULL) return NULL;
+    ind = (int)(gl->suffix - gl->gatename);
+    ssave = gl->gatename[ind];
+    gl->gatename[ind] = '\0';
+
+    bl = (struct Baselist *)HashLookup(gl->gatename, &Basehash);
+    gl->gatename[ind] = ssave;
+
+    for (i = 0; bl && (i < bl->Ndrives); i++) {
+	newgl = bl->gates[i];
+	if (newgl->suffix == NULL) continue;
+	if (larger) {
+	    if (newgl->strength <= gl->strength) continue;
+	    if ((glnext == NULL) || (newgl->strength < glnext->strength))
+		glnext = newgl;
+	}
+	else {
+	    if (newgl->strength >= gl->strength) continue;
+	    if ((glnext == NULL) || (newgl->strength > glnext->strength))
+		glnext = newgl;
+	}
+    }
+    return glnext;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ * Find the interval of the table index "vals" (size "n") containing "x".
+ * Return the index of the lower end of the interval, and the fractional
+ * position of "x" in the interval in "frac".  Values beyond the last
+ * index are extrapolated;  values below the first index are clamped.
+ *---------------------------------------------------------------------------
+ */
+
+int table_index(double *vals, int n, double x, double *frac)
+{
+    int i = 0;
+
+    *frac = 0.0;
+    if (n < 2) return 0;
+    while ((i < n - 2) && (x > vals[i + 1])) i++;
+    if (vals[i + 1] > vals[i])
+	*frac = (x - vals[i]) / (vals[i + 1] - vals[i]);
+    if (*frac < 0.0) *frac = 0.0;
+    return i;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ * Return the delay (ps) of gate "gl" with input transition time "trans"
+ * (ps) driving load "load" (fF), interpolated from the cell's delay table.
+ * If the cell has no table, use the delay per unit load from get_values().
+ *---------------------------------------------------------------------------
+ */
+
+double gate_delay(struct Gatelist *gl, double trans, double load)
+{
+    Cell *cell = gl->gatecell;
+    double *times, *caps, *v;
+    double ft, fc, d0, d1;
+    int tsize, csize, j;
+
+    if ((cell->reftable == NULL) || (cell->values == NULL))
+	return gl->delay * load;
+
+    times = (cell->times != NULL) ? cell->times : cell->reftable->times;
+    caps = (cell->caps != NULL) ? cell->caps : cell->reftable->caps;
+    tsize = cell->reftable->tsize;
+    csize = cell->reftable->csize;
+
+    // Values are stored as a matrix of csize rows by tsize columns
+    v = cell->values + table_index(times, tsize, trans, &ft);
+    j = table_index(caps, csize, load, &fc);
+    v += j * tsize;
+
+    d0 = (tsize < 2) ? v[0] : v[0] + ft * (v[1] - v[0]);
+    if (csize < 2) return d0;
+    v += tsize;
+    d1 = (tsize < 2) ? v[0] : v[0] + ft * (v[1] - v[0]);
+    return d0 + fc * (d1 - d0);
+}
+
+/*
+ *---------------------------------------------------------------------------
+ * Compute the total load capacitance on timing net "n":  wire capacitance,
+ * input pin capacitance of all sinks, and output capacitance for pins.
+ *---------------------------------------------------------------------------
+ */
+
+void timing_load(int n)
+{
+    struct Timingnet *tn = &Timingnets[n];
+    double pincap;
+    int k;
+
+    tn->load = WireCap;
+    if (tn->nl->type == OUTPUTPIN) tn->load += MaxOutputCap;
+    for (k = 0; k < tn->nsinks; k++) {
+	if (get_pincap(Timinggates[tn->sinks[k]].gl->gatecell, tn->sinkpin[k],
+			&pincap) == 0)
+	    tn->load += pincap;
+    }
+}
+
+/*
+ *---------------------------------------------------------------------------
+ * Return the index of the timing net for node "nl", creating it if needed.
+ *---------------------------------------------------------------------------
+ */
+
+int timing_net(struct Nodelist *nl, int *maxnets)
+{
+    struct Timingnet *tn;
+
+    if (nl->tidx >= 0) return nl->tidx;
+
+    if (NumTnets == *maxnets) {
+	*maxnets = (*maxnets == 0) ? 1024 : *maxnets * 2;
+	Timingnets = (struct Timingnet *)realloc(Timingnets,
+			*maxnets * sizeof(struct Timingnet));
+    }
+    tn = &Timingnets[NumTnets];
+    tn->nl = nl;
+    tn->driver = -1;
+    tn->nsinks = 0;
+    tn->sinks = NULL;
+    tn->sinkpin = NULL;
+    tn->sinkclk = NULL;
+    tn->load = 0.0;
+    tn->arrival = 0.0;
+    tn->trans = 0.0;
+    tn->required = UNCONSTRAINED;
+    nl->tidx = NumTnets;
+    return NumTnets++;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ * Build the timing graph for the netlist.  There is one timing gate for
+ * each instance of a cell found in the liberty file, and one timing net
+ * for each node connected to one.  Gates are ordered topologically,
+ * starting with clocked gates, whose outputs begin timing paths.  Gates
+ * on combinational loops are left out of the order and are not timed.
+ *---------------------------------------------------------------------------
+ */
+
+void timing_build(struct cellrec *topcell)
+{
+    struct instance *inst;
+    struct portrec *port;
+    struct Nodelist *nl;
+    struct Timinggate *tg;
+    struct Timingnet *tn;
+    struct Gatelist *gl;
+    Pin *curpin;
+    int g, n, k, nports, pintype, maxnets = 0;
+    int *pending;
+
+    NumTgates = NumTnets = NumTorder = 0;
+    for (inst = topcell->instlist; inst; inst = inst->next) NumTgates++;
+    Timinggates = (struct Timinggate *)malloc(NumTgates * sizeof(struct Timinggate));
+
+    g = 0;
+    for (inst = topcell->instlist; inst; inst = inst->next) {
+	gl = (struct Gatelist *)HashLookup(inst->cellname, &Gatehash);
+	if (gl == NULL) continue;
+
+	tg = &Timinggates[g];
+	tg->inst = inst;
+	tg->gl = tg->orig = tg->best = gl;
+	tg->out = -1;
+	tg->ninputs = 0;
+	tg->seq = FALSE;
+	tg->clk = FALSE;
+	tg->dirty = TRUE;
+	tg->trans = 0.0;
+	tg->delay = 0.0;
+	for (curpin = gl->gatecell->pins; curpin; curpin = curpin->next)
+	    if (curpin->type == PIN_CLOCK) tg->seq = TRUE;
+
+	nports = 0;
+	for (port = inst->portlist; port; port = port->next) nports++;
+	tg->in = (int *)malloc(nports * sizeof(int));
+	tg->inpin = (char **)malloc(nports * sizeof(char *));
+
+	for (port = inst->portlist; port; port = port->next) {
+	    nl = (struct Nodelist *)HashLookup(port->net, &Nodehash);
+	    if (nl == NULL) continue;
+	    n = timing_net(nl, &maxnets);
+	    tn = &Timingnets[n];
+
+	    pintype = get_pintype(gl->gatecell, port->name);
+	    if (pintype == PIN_OUTPUT) {
+		if (tg->out < 0) tg->out = n;
+		if (tn->driver < 0) tn->driver = g;
+	    }
+	    else if ((pintype == PIN_INPUT) || (pintype == PIN_CLOCK)) {
+		/* Grow sink arrays at each power of two */
+		if ((tn->nsinks & (tn->nsinks - 1)) == 0) {
+		    k = (tn->nsinks == 0) ? 1 : tn->nsinks * 2;
+		    tn->sinks = (int *)realloc(tn->sinks, k * sizeof(int));
+		    tn->sinkpin = (char **)realloc(tn->sinkpin, k * sizeof(char *));
+		    tn->sinkclk = (char *)realloc(tn->sinkclk, k * sizeof(char));
+		}
+		tn->sinks[tn->nsinks] = g;
+		tn->sinkpin[tn->nsinks] = port->name;
+		tn->sinkclk[tn->nsinks] = (pintype == PIN_CLOCK) ? TRUE : FALSE;
+		tn->nsinks++;
+
+		if (pintype == PIN_INPUT) {
+		    tg->in[tg->ninputs] = n;
+		    tg->inpin[tg->ninputs] = port->name;
+		    tg->ninputs++;
+		}
+	    }
+	}
+	g++;
+    }
+    NumTgates = g;
+
+    for (n = 0; n < NumTnets; n++) timing_load(n);
+
+    /* Order the gates topologically.  "pending" counts the data inputs */
+    /* of each gate that are driven by combinational gates not yet	*/
+    /* placed in the order.						*/
+
+    Timingorder = (int *)malloc(NumTgates * sizeof(int));
+    pending = (int *)calloc(NumTgates, sizeof(int));
+    for (g = 0; g < NumTgates; g++) {
+	tg = &Timinggates[g];
+	for (k = 0; k < tg->ninputs; k++) {
+	    n = Timingnets[tg->in[k]].driver;
+	    if ((n >= 0) && (Timinggates[n].seq == FALSE)) pending[g]++;
+	}
+	if (tg->seq || (pending[g] == 0)) Timingorder[NumTorder++] = g;
+    }
+    for (k = 0; k < NumTorder; k++) {
+	tg = &Timinggates[Timingorder[k]];
+	if (tg->seq || (tg->out < 0)) continue;
+	tn = &Timingnets[tg->out];
+	if (tn->driver != Timingorder[k]) continue;
+	for (n = 0; n < tn->nsinks; n++) {
+	    if (tn->sinkclk[n] || Timinggates[tn->sinks[n]].seq) continue;
+	    if (--pending[tn->sinks[n]] == 0)
+		Timingorder[NumTorder++] = tn->sinks[n];
+	}
+    }
+    free(pending);
+
+    /* Mark the gates of clock trees (buffers or gates whose output	*/
+    /* reaches a clock pin through combinational gates), which are	*/
+    /* not resized.  Sinks come later in the order, so one reverse	*/
+    /* pass finds them all.						*/
+
+    for (k = NumTorder - 1; k >= 0; k--) {
+	tg = &Timinggates[Timingorder[k]];
+	if (tg->seq || (tg->out < 0)) continue;
+	tn = &Timingnets[tg->out];
+	if (tn->nl->clock == TRUE) tg->clk = TRUE;
+	for (n = 0; (n < tn->nsinks) && (tg->clk == FALSE); n++)
+	    if (tn->sinkclk[n] || Timinggates[tn->sinks[n]].clk)
+		tg->clk = TRUE;
+    }
+
+    if (NumTorder < NumTgates)
+	fprintf(stderr, "Warning:  %d gates on combinational loops will not "
+		"be timed.\n", NumTgates - NumTorder);
+}
+
+/*
+ *---------------------------------------------------------------------------
+ * Update arrival times of gates marked dirty and of everything in their
+ * fanout, in topological order, then recompute required times.  Paths
+ * start at clocked gate outputs and module inputs, and end at clocked
+ * gate data inputs and module outputs, all of which are required at
+ * TargetPeriod.  Return the delay of the critical path.
+ *---------------------------------------------------------------------------
+ */
+
+double timing_update(void)
+{
+    struct Timinggate *tg;
+    struct Timingnet *tn;
+    double arr, trans, d, r, crit = 0.0;
+    int g, k, n;
+
+    for (k = 0; k < NumTorder; k++) {
+	g = Timingorder[k];
+	tg = &Timinggates[g];
+	if (tg->dirty == FALSE) continue;
+	tg->dirty = FALSE;
+
+	/* Find the latest arriving input */
+	arr = trans = 0.0;
+	if (tg->seq == FALSE) {
+	    for (n = 0; n < tg->ninputs; n++) {
+		tn = &Timingnets[tg->in[n]];
+		if (tn->arrival > arr) {
+		    arr = tn->arrival;
+		    trans = tn->trans;
+		}
+	    }
+	}
+	tg->trans = trans;
+	if (tg->out < 0) continue;
+
+	tn = &Timingnets[tg->out];
+	d = gate_delay(tg->gl, trans, tn->load);
+	tg->delay = d;
+	if (tn->driver != g) continue;
+
+	/* Propagate to the fanout only if the output changed.  The	*/
+	/* transition time at the output is estimated by the delay.	*/
+
+	if ((arr + d != tn->arrival) || (d != tn->trans)) {
+	    tn->arrival = arr + d;
+	    tn->trans = d;
+	    for (n = 0; n < tn->nsinks; n++)
+		if (!tn->sinkclk[n] && !Timinggates[tn->sinks[n]].seq)
+		    Timinggates[tn->sinks[n]].dirty = TRUE;
+	}
+    }
+
+    /* Required times are recomputed in full, in reverse order */
+
+    for (n = 0; n < NumTnets; n++) {
+	tn = &Timingnets[n];
+	tn->required = UNCONSTRAINED;
+	if (tn->nl->type == OUTPUTPIN) {
+	    tn->required = TargetPeriod;
+	    if (tn->arrival > crit) crit = tn->arrival;
+	}
+    }
+    for (g = 0; g < NumTgates; g++) {
+	tg = &Timinggates[g];
+	if (tg->seq == FALSE) continue;
+	for (n = 0; n < tg->ninputs; n++) {
+	    tn = &Timingnets[tg->in[n]];
+	    tn->required = TargetPeriod;
+	    if (tn->arrival > crit) crit = tn->arrival;
+	}
+    }
+    for (k = NumTorder - 1; k >= 0; k--) {
+	tg = &Timinggates[Timingorder[k]];
+	if (tg->seq || (tg->out < 0)) continue;
+	r = Timingnets[tg->out].required;
+	if (r >= UNCONSTRAINED) continue;
+	for (n = 0; n < tg->ninputs; n++) {
+	    tn = &Timingnets[tg->in[n]];
+	    if (r - tg->delay < tn->required) tn->required = r - tg->delay;
+	}
+    }
+    return crit;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ * Estimate the reduction in arrival time at the output of gate "g" if its
+ * cell is replaced with "glnew".  This is the change in the gate's own
+ * delay less the largest added delay of any gate driving an input, due to
+ * the change in input pin capacitance.  Negative for a slower result.
+ *---------------------------------------------------------------------------
+ */
+
+double timing_gain(int g, struct Gatelist *glnew)
+{
+    struct Timinggate *tg = &Timinggates[g];
+    double gain, penalty, p, capold, capnew;
+    int n, drv;
+
+    gain = tg->delay - gate_delay(glnew, tg->trans, Timingnets[tg->out].load);
+
+    penalty = -UNCONSTRAINED;
+    for (n = 0; n < tg->ninputs; n++) {
+	drv = Timingnets[tg->in[n]].driver;
+	if (drv < 0) continue;
+	if (get_pincap(tg->gl->gatecell, tg->inpin[n], &capold) != 0) continue;
+	if (get_pincap(glnew->gatecell, tg->inpin[n], &capnew) != 0) continue;
+	p = (capnew - capold) * Timinggates[drv].gl->delay;
+	if (p > penalty) penalty = p;
+    }
+    if (penalty == -UNCONSTRAINED) penalty = 0.0;
+    return gain - penalty;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ * Change the cell of gate "g" to "glnew" and mark the gate and the
+ * drivers of its inputs (whose load has changed) for retiming.
+ *---------------------------------------------------------------------------
+ */
+
+void timing_swap(int g, struct Gatelist *glnew)
+{
+    struct Timinggate *tg = &Timinggates[g];
+    int n, drv;
+
+    tg->gl = glnew;
+    tg->dirty = TRUE;
+    for (n = 0; n < tg->ninputs; n++) {
+	timing_load(tg->in[n]);
+	drv = Timingnets[tg->in[n]].driver;
+	if (drv >= 0) Timinggates[drv].dirty = TRUE;
+    }
+}
+
+/*
+ *---------------------------------------------------------------------------
+ * Return TRUE if a gate driving an input of gate "g" has a load greater
+ * than its drive strength.
+ *---------------------------------------------------------------------------
+ */
+
+int timing_overload(int g)
+{
+    struct Timinggate *tg = &Timinggates[g];
+    struct Timingnet *tn;
+    int n;
+
+    for (n = 0; n < tg->ninputs; n++) {
+	tn = &Timingnets[tg->in[n]];
+	if (tn->driver < 0) continue;
+	if (Timinggates[tn->driver].gl->strength < tn->load) return TRUE;
+    }
+    return FALSE;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ * Timing-driven sizing.  Repeatedly time the netlist, upsize gates on
+ * paths with negative slack, and downsize gates with large positive slack
+ * that can still drive their load, until no more changes are found or
+ * MaxSizeIter passes have been made.  Gates are only downsized to a cell
+ * of smaller area, and gates of clock trees are not resized.  All swaps
+ * in a pass are chosen from the same timing, then applied together and
+ * retimed incrementally;  an upsize that overloads the driver of one of
+ * the gate's inputs is undone.  The best result found (least negative
+ * slack, then least area) is kept and written back to the netlist.
+ * Return the number of gates changed.
+ *---------------------------------------------------------------------------
+ */
+
+int timing_size(struct cellrec *topcell)
+{
+    struct Timinggate *tg;
+    struct Timingnet *tn;
+    struct Gatelist *glnew, *glold, **swaps;
+    struct Baselist *bl;
+    double crit, before, bestcrit, area, bestarea, slack, margin, gain;
+    int g, iter, nswaps, nup = 0, ndown = 0;
+
+    timing_build(topcell);
+    if (NumTgates == 0) return 0;
+
+    /* Gates can only be resized if some cell has more than one drive	*/
+    /* strength, which needs the drive strength separator (option -s).	*/
+
+    bl = (struct Baselist *)HashFirst(&Basehash);
+    while ((bl != NULL) && (bl->Ndrives < 2))
+	bl = (struct Baselist *)HashNext(&Basehash);
+    if (bl == NULL)
+	fprintf(stderr, "Warning:  No cells with more than one drive strength "
+		"(check the separator, option -s);\n  timing-driven sizing "
+		"cannot change any gates.\n");
+
+    /* Slack above this amount is considered available for downsizing */
+    margin = 0.1 * TargetPeriod;
+
+    swaps = (struct Gatelist **)calloc(NumTgates, sizeof(struct Gatelist *));
+    before = bestcrit = crit = timing_update();
+    bestarea = 0.0;
+    for (g = 0; g < NumTgates; g++)
+	bestarea += Timinggates[g].gl->gatecell->area;
+
+    for (iter = 0; iter < MaxSizeIter; iter++) {
+	nswaps = 0;
+	for (g = 0; g < NumTgates; g++) {
+	    tg = &Timinggates[g];
+	    swaps[g] = NULL;
+	    if ((tg->out < 0) || (tg->gl->suffix == NULL) || tg->clk) continue;
+	    tn = &Timingnets[tg->out];
+	    if ((tn->driver != g) || (tn->nl->ignore == (char)1)) continue;
+	    if (tn->required >= UNCONSTRAINED) continue;
+
+	    slack = tn->required - tn->arrival;
+	    if (slack < 0.0) {
+		glnew = next_size(tg->gl, TRUE);
+		if (glnew == NULL) continue;
+		if (timing_gain(g, glnew) <= 0.0) continue;
+	    }
+	    else if (slack > margin) {
+		for (glnew = next_size(tg->gl, FALSE); glnew != NULL;
+				glnew = next_size(glnew, FALSE))
+		    if (glnew->gatecell->area < tg->gl->gatecell->area) break;
+		if (glnew == NULL) continue;
+		if (glnew->strength < tn->load) continue;
+		gain = timing_gain(g, glnew);
+		if (-gain >= slack / 2) continue;
+	    }
+	    else
+		continue;
+	    swaps[g] = glnew;
+	    nswaps++;
+	}
+	if (nswaps == 0) break;
+
+	for (g = 0; g < NumTgates; g++) {
+	    if (swaps[g] == NULL) continue;
+	    glold = Timinggates[g].gl;
+	    timing_swap(g, swaps[g]);
+	    if ((swaps[g]->strength > glold->strength) && timing_overload(g)) {
+		timing_swap(g, glold);
+		nswaps--;
+	    }
+	}
+	if (nswaps == 0) break;
+	crit = timing_update();
+
+	area = 0.0;
+	for (g = 0; g < NumTgates; g++)
+	    area += Timinggates[g].gl->gatecell->area;
+
+	if (VerboseFlag)
+	    printf("Sizing pass %d:  %d gates changed, critical path %g ps\n",
+			iter + 1, nswaps, crit);
+
+	/* Compare negative slack, or area if both meet timing */
+	if ((fmax(crit, TargetPeriod) < fmax(bestcrit, TargetPeriod)) ||
+		((fmax(crit, TargetPeriod) == fmax(bestcrit, TargetPeriod)) &&
+		(area < bestarea))) {
+	    bestcrit = crit;
+	    bestarea = area;
+	    for (g = 0; g < NumTgates; g++)
+		Timinggates[g].best = Timinggates[g].gl;
+	}
+    }
+    free(swaps);
+
+    /* Write the best solution back to the netlist */
+
+    Changed_count = 0;
+    for (g = 0; g < NumTgates; g++) {
+	tg = &Timinggates[g];
+	if (tg->best == tg->orig) continue;
+	if (tg->best->strength > tg->orig->strength) nup++;
+	else ndown++;
+	free(tg->inst->cellname);
+	tg->inst->cellname = strdup(tg->best->gatename);
+	count_gatetype(tg->orig, 0, -1);
+	count_gatetype(tg->best, 0, 1);
+	Changed_count++;
+    }
+
+    fprintf(stderr, "Timing-driven sizing (target %g ps):  critical path "
+		"%g ps before, %g ps after.\n", TargetPeriod, before, bestcrit);
+    fprintf(stderr, "%d gates upsized, %d gates downsized in %d passes.\n",
+		nup, ndown, iter);
+    return Changed_count;
+}
+
 /*
  *---------------------------------------------------------------------------
  * Rewrite the verilog output with resized gates and clock and buffer trees
@@ -1253,6 +2165,9 @@ void helpmessage(void)
     printf("\t-s separator\tGate names have \"separator\" before drive strength\n");
     printf("\t-c value\tSet the maximum output capacitance (fF).  "
 		"(value %g, default 30.0)\n", MaxOutputCap);
+    printf("\t-D filepath\tRead placement from DEF file to build buffer trees\n");
+    printf("\t-E filepath\tRead LEF file of cell macros (needed by -D)\n");
+    printf("\t-T period\tSize gates to meet the clock period (ps) after buffering\n");
     printf("\t-p filepath\tSpecify an alternate path and filename for gate.cfg\n");
     printf("\t-I filepath\tSpecify a path and filename for list of nets to ignore\n");
     printf("\t-h\t\tprint this help message\n\n");
@@ -1305,9 +2220,11 @@ int main (int argc, char *argv[])
     InitializeHashTable(&Gatehash, SMALLHASHSIZE);
     InitializeHashTable(&Basehash, SMALLHASHSIZE);
 
+    ProfileInit(argv[0]);
+
     fprintf(stdout, "vlogFanout for qflow " QFLOW_VERSION "." QFLOW_REVISION "\n");
 
-    while ((i = getopt(argc, argv, "fLSgnhvl:c:b:i:o:p:s:I:F:")) != EOF) {
+    while ((i = getopt(argc, argv, "fLSgnhvl:c:b:i:o:p:s:I:F:T:D:E:")) != EOF) {
 	switch (i) {
 	    case 'b':
 		/* If value is a comma-separated pair, the first is a		*/
@@ -1368,6 +2285,17 @@ int main (int argc, char *argv[])
 	    case 'c':
 		MaxOutputCap = atof(optarg);
 		break;
+	    case 'T':
+		TargetPeriod = atof(optarg);
+		break;
+	    case 'D':
+		Deffname = strdup(optarg);
+		break;
+	    case 'E':
+		ProfileBegin("parse LEF");
+		LefRead(optarg);	/* Can be called multiple times */
+		ProfileEnd();
+		break;
 	    case 's':
 		if (!strcasecmp(optarg, "none")) {
 		    if (separg) free(separg);
@@ -1403,17 +2331,6 @@ int main (int argc, char *argv[])
     }
     if (separg) free(separg);
 
-    /* If there is only one set of in and out pins, then assume	*/
-    /* that the pin names apply to both regular and clock	*/
-    /* buffer types.						*/
-
-    if (clkbuf_in_pin == NULL) {
-	clkbuf_in_pin = buf_in_pin;
-    }
-    if (clkbuf_out_pin == NULL) {
-	clkbuf_out_pin = buf_out_pin;
-    }
-
     Inputfname = Outputfname = NULL;
     outfptr = stdout;
     i = optind;
@@ -1436,6 +2353,7 @@ int main (int argc, char *argv[])
 	fprintf(stderr, "vlogFanout: No liberty file(s) specified.\n");
 	return 1;
     }
+    ProfileBegin("parse Liberty");
     gatecount = 0;
     for (l = 0; l < libcount; l++) {
 	int loccount;
@@ -1447,6 +2365,7 @@ int main (int argc, char *argv[])
 				libfile);
 	gatecount += loccount;
     }
+    ProfileEnd();
 
     // Determine if suffix is numeric or alphabetic
     if (gatecount > 0) {
@@ -1546,7 +2465,20 @@ int main (int argc, char *argv[])
     /* If Clkbufname is not defined, make it the same as Buffername */
     if (Clkbufname == NULL) Clkbufname = Buffername;
 
+    /* If there is only one set of in and out pins, then assume	*/
+    /* that the pin names apply to both regular and clock	*/
+    /* buffer types.  (This must follow the search for buffer	*/
+    /* pins above, or clock buffers get no pin names.)		*/
+
+    if (clkbuf_in_pin == NULL) {
+	clkbuf_in_pin = buf_in_pin;
+    }
+    if (clkbuf_out_pin == NULL) {
+	clkbuf_out_pin = buf_out_pin;
+    }
+
     /* Read the verilog file */
+    ProfileBegin("parse Verilog");
     topcell = ReadVerilog(Inputfname);
 
     if (topcell == NULL) {
@@ -1638,6 +2570,23 @@ int main (int argc, char *argv[])
 	}
     }
 
+    ProfileEnd();
+
+    /* Read the placement, if given, to group sinks of buffer trees by location */
+    if (Deffname != NULL) {
+	float oscale;
+
+	InitializeHashTable(&Posthash, SMALLHASHSIZE);
+	ProfileBegin("parse DEF");
+	DefRead(Deffname, &oscale);
+	ProfileEnd();
+	if (Numgates > 0)
+	    HavePlacement = TRUE;
+	else
+	    fprintf(stderr, "vlogFanout:  No placed instances found in %s;  "
+			"buffer trees will not use placement.\n", Deffname);
+    }
+
     /* get list of nets to ignore, if there is one, and mark nets to ignore */
     if (Ignorepath != NULL) read_ignore_file(Ignorepath);
 
@@ -1648,6 +2597,7 @@ int main (int argc, char *argv[])
 
     /* Apply iterative buffering and resizing */
 
+    ProfileBegin("buffer and resize");
     iter = 0;
     cidx = 0;
     Changed_count = 1;
@@ -1722,9 +2672,21 @@ int main (int argc, char *argv[])
 	}
 	fprintf(stderr, "\n");
     }
+    ProfileEnd();
+
+    /* Apply timing-driven sizing to the buffered and resized netlist */
+
+    if (doLoadBalance && (TargetPeriod > 0.0)) {
+	ProfileBegin("timing sizing");
+	timing_size(topcell);
+	fprintf(stderr, "%d gates were changed.\n", Changed_count);
+	ProfileEnd();
+    }
 
+    ProfileBegin("write output");
     write_output(topcell, outfptr, doLoadBalance, doFanout);
     if (outfptr != stdout) fclose(outfptr);
+    ProfileEnd();
 
     // Output number of gates changed so we can iterate until this is zero.
 